@@ -0,0 +1,50 @@
+#!/usr/bin/env bash
+# Measures time from process start to the first paint of the main window,
+# and how much SQLite read from disk to get there.
+#
+# Builds SQLight with SQLIGHT_ENABLE_TRACING, launches it RUNS times under
+# a virtual X server and prints the min, median and max first paint time.
+# The trace of the last run is kept for inspection in chrome://tracing.
+#
+# Usage: benchmarks/cold_start.sh [database.db]
+#
+# Environment:
+#   RUNS=10          number of launches
+#   DROP_CACHES=1    drop the page cache before each launch (needs root, Linux only)
+#   BUILD_DIR=...    build directory, defaults to _bench_build
+
+set -euo pipefail
+
+ROOT_DIR="$(cd "$(dirname "$0")/.." && pwd)"
+BUILD_DIR="${BUILD_DIR:-$ROOT_DIR/_bench_build}"
+RUNS="${RUNS:-10}"
+TRACE_FILE="$BUILD_DIR/startup_trace.json"
+
+command -v xvfb-run > /dev/null || { echo "cold_start.sh: xvfb-run is required" >&2; exit 1; }
+
+cmake -S "$ROOT_DIR" -B "$BUILD_DIR" -DCMAKE_BUILD_TYPE=Release -DSQLIGHT_ENABLE_TRACING=ON > /dev/null
+cmake --build "$BUILD_DIR" --target SQLight -j"$(nproc)" > /dev/null
+
+APP="$(find "$BUILD_DIR" -type f -name SQLight -perm -u+x | head -n 1)"
+[ -n "$APP" ] || { echo "cold_start.sh: SQLight was not built, is wxWidgets installed?" >&2; exit 1; }
+
+times=()
+for ((run = 1; run <= RUNS; run++)); do
+    if [ "${DROP_CACHES:-0}" = "1" ]; then
+        sync
+        echo 3 > /proc/sys/vm/drop_caches
+    fi
+
+    output="$(SQLIGHT_BENCHMARK_STARTUP=1 SQLIGHT_TRACE_FILE="$TRACE_FILE" xvfb-run -a "$APP" "$@")"
+    line="$(grep '^first_paint_ms=' <<< "$output")"
+    io="$(grep '^io_reads=' <<< "$output" || true)"
+    ms="${line#first_paint_ms=}"
+    times+=("$ms")
+    echo "run=$run first_paint_ms=$ms $io"
+done
+
+printf '%s\n' "${times[@]}" | sort -n | awk -v runs="$RUNS" '
+    { value[NR] = $1 }
+    END { printf "summary runs=%d min_ms=%.3f median_ms=%.3f max_ms=%.3f\n", runs, value[1], value[int((NR + 1) / 2)], value[NR] }
+'
+echo "trace=$TRACE_FILE"
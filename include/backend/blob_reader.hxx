@@ -0,0 +1,50 @@
+#pragma once
+
+// SQLite
+#include "ext/sqlite3.h"
+
+// STD
+#include <string>
+
+/*
+    Incremental, read-only access to a single BLOB cell through
+    sqlite3_blob_open, so a cell can be inspected a chunk at a time
+    without ever materializing the whole value in memory.
+
+    The underlying sqlite3_blob handle keeps a read transaction open.
+    Release() closes it between reads while remembering which cell
+    is being viewed; the next Read() transparently reopens it.
+*/
+class BlobReader {
+public:
+    BlobReader() = default;
+    ~BlobReader();
+
+    BlobReader(const BlobReader&) = delete;
+    BlobReader& operator=(const BlobReader&) = delete;
+
+    // Open the blob stored in 'column' of the row with 'rowId'.
+    // Fails if the cell does not exist or does not hold a BLOB.
+    bool Open(sqlite3* db, const std::string& table, const std::string& column, sqlite3_int64 rowId);
+    void Close(); // Forget the cell entirely
+    void Release(); // Close the sqlite3_blob handle but keep the cell so reads can resume
+
+    bool IsOpen() const { return m_db != nullptr; }
+    int Size() const { return m_size; } // Total size of the blob in bytes
+
+    /*
+        Read up to 'length' bytes starting at 'offset' into 'buffer'.
+        Returns the number of bytes read, which is less than 'length'
+        near the end of the blob, or -1 on error.
+    */
+    int Read(int offset, void* buffer, int length);
+private:
+    bool Acquire(); // (Re)open m_blob if it was released
+
+    sqlite3* m_db = nullptr;
+    sqlite3_blob* m_blob = nullptr;
+    std::string m_table;
+    std::string m_column;
+    sqlite3_int64 m_rowId = 0;
+    int m_size = 0;
+};
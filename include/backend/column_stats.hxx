@@ -0,0 +1,127 @@
+#pragma once
+
+// SQLite
+#include "ext/sqlite3.h"
+
+// STD
+#include <array>
+#include <cstdint>
+#include <optional>
+#include <random>
+#include <string>
+#include <unordered_map>
+#include <utility>
+#include <vector>
+
+/*
+    HyperLogLog cardinality sketch.
+    Uses 2^12 one-byte registers (4 KiB), giving roughly 1.6%
+    standard error on the distinct count regardless of table size.
+*/
+class HyperLogLog {
+public:
+    static constexpr int PRECISION = 12;
+    static constexpr size_t REGISTER_COUNT = size_t(1) << PRECISION;
+
+    void Add(uint64_t hash);
+    double Estimate() const;
+
+    static uint64_t Hash(const void* data, size_t length); // 64-bit hash used to feed Add
+private:
+    std::array<uint8_t, REGISTER_COUNT> m_registers{};
+};
+
+/*
+    Space-Saving heavy hitters sketch (Metwally et al.).
+    Tracks at most 'capacity' candidates; every reported count
+    overestimates the true frequency by at most its 'error'.
+*/
+class SpaceSaving {
+public:
+    struct Entry {
+        std::string value;
+        uint64_t count;
+        uint64_t error;
+    };
+
+    explicit SpaceSaving(size_t capacity) : m_capacity(capacity)
+    {
+    }
+
+    void Add(const std::string& value);
+    std::vector<Entry> Top(size_t k) const; // Most frequent 'k' entries, descending
+private:
+    struct Counter {
+        uint64_t count;
+        uint64_t error;
+    };
+
+    size_t m_capacity;
+    std::unordered_map<std::string, Counter> m_counters;
+};
+
+/*
+    Summary of a single column produced by one streaming scan.
+*/
+struct ColumnStats {
+    struct Bucket {
+        double low;
+        double high;
+        uint64_t count; // Estimated number of rows in [low, high)
+    };
+
+    std::string table;
+    std::string column;
+
+    bool sampled = false;        // Stats were computed from sampled blocks, not every row
+    uint64_t estimatedRows = 0;  // Table size estimate used to decide on sampling
+    uint64_t rowsScanned = 0;
+
+    uint64_t nullCount = 0;
+    uint64_t integerCount = 0;
+    uint64_t realCount = 0;
+    uint64_t textCount = 0;
+    uint64_t blobCount = 0;
+
+    std::optional<double> numericMin;
+    std::optional<double> numericMax;
+    std::optional<std::string> textMin;
+    std::optional<std::string> textMax;
+
+    double distinctEstimate = 0;
+    std::vector<SpaceSaving::Entry> topValues;
+    std::vector<Bucket> histogram; // Only filled for columns holding finite numeric values, ±Inf are left out
+
+    double NullRatio() const { return rowsScanned ? double(nullCount) / rowsScanned : 0.0; }
+};
+
+/*
+    Accumulates ColumnStats one value at a time so a column
+    can be summarized in a single pass without holding the rows.
+    Numeric histograms are built from a fixed-size reservoir sample
+    since the value range is only known once the scan is complete.
+*/
+class ColumnStatsCollector {
+public:
+    static constexpr size_t TOP_K_CAPACITY = 64;
+    static constexpr size_t TOP_K_REPORTED = 5;
+    static constexpr size_t RESERVOIR_SIZE = 4096;
+    static constexpr size_t HISTOGRAM_BUCKETS = 10;
+
+    ColumnStatsCollector();
+
+    void Add(sqlite3_value* value);
+    void Finish(ColumnStats& stats) const; // Writes the gathered values into 'stats', identifying fields are left as is
+private:
+    void AddNumeric(double value);
+
+    ColumnStats m_stats;
+    HyperLogLog m_distinct;
+    SpaceSaving m_topValues;
+
+    std::vector<double> m_reservoir; // Finite values only
+    uint64_t m_numericSeen = 0; // Finite values seen, what the histogram is scaled to
+    std::optional<double> m_finiteMin; // Histogram range, numericMin and numericMax may be infinite
+    std::optional<double> m_finiteMax;
+    std::mt19937_64 m_rng;
+};
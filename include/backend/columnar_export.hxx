@@ -0,0 +1,27 @@
+#pragma once
+
+// SQLite
+#include "ext/sqlite3.h"
+
+// STD
+#include <iosfwd>
+
+/*
+    Columnar writers behind ExportFormat::Arrow and ExportFormat::Parquet.
+
+    Rows are stepped into typed column batches, which are written out as
+    Arrow IPC stream record batches or Parquet row groups, so memory use
+    depends on the batch size and not on the row count.
+
+    SQLite values have no fixed type, so each column's type is taken from
+    the values in the first batch: INTEGER only becomes int64, INTEGER and
+    REAL become double, any BLOB makes it binary and anything else utf8.
+    A column that is all NULL in the first batch falls back to its declared
+    type. Later values of another type are converted the way sqlite3_column_*
+    converts them, e.g. a REAL in an int64 column is truncated.
+
+    Parquet columns are dictionary encoded per row group when that makes
+    them smaller, and written PLAIN otherwise. Pages are not compressed.
+*/
+bool WriteArrowStream(sqlite3_stmt* stmt, std::ostream& out); // Steps 'stmt' to completion
+bool WriteParquet(sqlite3_stmt* stmt, std::ostream& out); // Steps 'stmt' to completion
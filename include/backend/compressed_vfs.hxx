@@ -0,0 +1,57 @@
+#pragma once
+
+// STD
+#include <cstdint>
+#include <functional>
+#include <stop_token>
+#include <string>
+
+/*
+    Progress of CompressDatabaseFile, reported after every round of chunks.
+*/
+struct ArchiveProgress {
+    uint64_t bytesRead = 0; // Of the uncompressed data base
+    uint64_t totalBytes = 0;
+    uint64_t bytesWritten = 0; // Compressed
+    double elapsedSeconds = 0;
+
+    double Fraction() const { return totalBytes ? double(bytesRead) / totalBytes : 1.0; }
+};
+
+/*
+    Compressed archive files and the "sqlight-zip" VFS that reads them.
+
+    An archive holds a data base file cut into fixed size chunks, each
+    deflated on its own, followed by an index of where each chunk starts:
+
+        header   magic "SQLightZ", format version, chunk size, data base
+                 size, index offset and chunk count, 64 bytes
+        chunks   zlib streams, or raw when deflating didn't make one smaller
+        index    offset and compressed size of every chunk
+
+    The VFS serves page reads by inflating the chunks they fall in, keeping
+    the most recently used ones in a small cache per open file, so
+    browsing an archive reads a fraction of the bytes the data base would.
+    Archives are read-only: the main data base opens read-only and writes
+    fail with SQLITE_READONLY. Journals and temp files go to the underlying
+    VFS untouched. Reads are counted by the I/O statistics VFS, in
+    compressed bytes, when it is registered.
+*/
+const char* RegisterCompressedVfs(); // The VFS name for sqlite3_open_v2, nullptr if it could not be registered
+
+bool IsCompressedArchive(const std::string& path); // The file starts with the archive magic
+
+/*
+    Write the data base file at 'srcPath' as an archive at 'dstPath',
+    deflating chunks on every core. Nothing may write to the source while
+    it runs, DataStore::ExportCompressedArchive compresses a VACUUM INTO
+    copy for that reason. A data base in WAL mode is archived in rollback
+    journal mode, the VFS has no shared memory to offer. A partial
+    'dstPath' is removed on failure or cancellation.
+*/
+bool CompressDatabaseFile(
+    const std::string& srcPath,
+    const std::string& dstPath,
+    const std::function<void(const ArchiveProgress&)>& onProgress = {},
+    std::stop_token stop = {}
+);
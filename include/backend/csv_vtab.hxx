@@ -0,0 +1,17 @@
+#pragma once
+
+// SQLite
+#include "ext/sqlite3.h"
+
+/*
+    Read-only "csvfile" virtual table module serving a CSV file in place:
+
+        CREATE VIRTUAL TABLE temp.trips USING csvfile('/data/trips.csv');
+
+    The file is memory mapped and scanned once for row boundaries, keeping
+    the offset of every ROW_INDEX_STRIDE'th row so rowid lookups only step
+    over a few rows. The first row names the columns. Values are returned
+    as TEXT pointing straight into the mapping, only fields with escaped
+    quotes are copied. The rowid is the 1-based data row number.
+*/
+bool RegisterCSVModule(sqlite3* db); // Make the csvfile module available on 'db'
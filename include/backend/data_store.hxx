@@ -1,10 +1,119 @@
 #pragma once
 
+// Backend
+#include "backend/blob_reader.hxx"
+#include "backend/column_stats.hxx"
+#include "backend/compressed_vfs.hxx"
+#include "backend/edit_journal.hxx"
+#include "backend/read_ahead_vfs.hxx"
+
 // SQLite
 #include "ext/sqlite3.h"
 
 // STD
+#include <cstdint>
+#include <functional>
+#include <iosfwd>
+#include <map>
+#include <stop_token>
 #include <string>
+#include <utility>
+#include <vector>
+
+/*
+    A page of rows read from a table for display.
+    rowIds[i] is the rowid of cells[i], so edits can be
+    written back to the exact row they came from.
+    BLOB cells only hold a "<BLOB n bytes>" placeholder,
+    their content is read on demand through OpenBlob.
+*/
+struct TableRecords {
+    std::vector<std::string> columns;
+    std::vector<sqlite3_int64> rowIds;
+    std::vector<std::vector<std::string>> cells;
+    std::vector<std::pair<size_t, size_t>> blobCells; // (row, column) of each BLOB placeholder
+};
+
+using Changeset = std::vector<unsigned char>; // Serialized session extension changeset
+
+/*
+    Progress of an online backup, reported after every step.
+*/
+struct BackupProgress {
+    int totalPages = 0;
+    int remainingPages = 0;
+    uint64_t bytesCopied = 0;
+    uint64_t totalBytes = 0;
+    double elapsedSeconds = 0;
+
+    double BytesPerSecond() const { return elapsedSeconds > 0 ? bytesCopied / elapsedSeconds : 0.0; }
+    double Fraction() const { return totalPages ? double(totalPages - remainingPages) / totalPages : 0.0; }
+};
+
+/*
+    Progress of ExecuteScript, reported between statements.
+*/
+struct ScriptProgress {
+    uint64_t bytesDone = 0; // Offset of the next statement in the script file
+    uint64_t totalBytes = 0;
+    uint64_t statements = 0;
+    uint64_t rowsChanged = 0;
+    double elapsedSeconds = 0;
+
+    double Fraction() const { return totalBytes ? double(bytesDone) / totalBytes : 1.0; }
+};
+
+/*
+    Progress of ExportDump, reported as each table is written out.
+*/
+struct DumpProgress {
+    size_t tablesDone = 0;
+    size_t tableCount = 0;
+    uint64_t rows = 0; // Rows written so far, including tables still being generated
+    uint64_t bytesWritten = 0; // SQL text written to the output
+    double elapsedSeconds = 0;
+};
+
+/*
+    Rows in a table, estimated by EstimateRowCounts
+    or counted exactly by CountRows.
+*/
+struct RowCount {
+    uint64_t rows = 0;
+    bool exact = false;
+};
+
+enum class ExportFormat {
+    CSV,  // RFC 4180, header row first. BLOBs are written as hex
+    JSON, // Array of row objects, one row per line
+    Arrow,   // Arrow IPC stream of typed record batches, see columnar_export.hxx
+    Parquet, // Parquet file, dictionary encoded where it pays off
+};
+
+/*
+    Timings and sqlite3_stmt_status counters
+    for a single run of a query.
+*/
+struct QueryProfile {
+    double prepareMs = 0;
+    double executeMs = 0;
+    uint64_t rows = 0;
+    int vmSteps = 0;
+    int fullScanSteps = 0; // Rows visited by full table scans
+    int sorts = 0;
+    int autoIndexes = 0; // Rows inserted into automatic indexes
+};
+
+/*
+    How Connect opens a data base. The default opens it read-write,
+    with read-ahead, through the I/O statistics VFS.
+*/
+struct ConnectProfile {
+    bool compressedArchive = false; // A file written by ExportCompressedArchive, opened read-only, see compressed_vfs.hxx
+    bool readAhead = true; // Prefetch ahead of sequential reads, see read_ahead_vfs.hxx. Archives always are
+    bool inMemory = false; // Work on a copy loaded into RAM. Changes reach the file only when BackupTo writes them back
+    bool readOnly = false; // Open with SQLITE_OPEN_READONLY, as an immutable snapshot when nothing is writing to it. Ignored in memory
+};
 
 class DataStore {
 public:
@@ -28,17 +137,199 @@ public:
     */
     ~DataStore();
 
-    bool Connect(const std::string& dbPath); // Connect to SQLite data base with path 'dbPath'
+    bool Connect(const std::string& dbPath, const ConnectProfile& profile = {}); // Connect to SQLite data base with path 'dbPath'
     const bool IsConnected() const { return m_connected; }
+    bool IsReadOnly() const; // Writes would fail, the data base was opened read-only or is an archive
+    const ConnectProfile& GetProfile() const { return m_profile; }
     bool Disconnect(); // Disconnect from the currently connected data base
+    const std::string& GetPath() const { return m_dbPath; }
+    const std::string& GetReadPath() const { return m_readPath; } // What background readers open, with SQLITE_OPEN_URI. A memdb or immutable=1 URI, or GetPath()
+    const char* VfsName() const; // VFS background readers open GetReadPath() through. Registered for the life of the process
     
-    // Exporting
-    void ExportTableToJSON(const std::string& tableName, const std::string& outputFilename);
-    void ExportTableToCSV(const std::string& tableName, const std::string& outputFilename);
+    // Schema
+    std::vector<std::string> GetTableNames();
+    bool ReadTableNames(std::vector<std::string>& names); // GetTableNames on a read-only connection, safe from a worker thread
+    bool ReadSchemaVersion(int64_t& version); // PRAGMA schema_version on a read-only connection, which only reads the header
+    std::vector<std::string> GetColumnNames(const std::string& tableName);
+    bool FetchRecords(const std::string& tableName, int limit, TableRecords& records);
+    bool OpenBlob(const std::string& tableName, const std::string& columnName, sqlite3_int64 rowId, BlobReader& reader); // false if the cell isn't a BLOB
+
+    /*
+        Summarize a single column in one streaming pass.
+        Runs on its own read-only connection so it can be called from a
+        worker thread while the UI keeps using m_db. Tables too large to
+        scan quickly are sampled in random rowid blocks instead.
+        Returns false on error or if 'stop' was requested.
+    */
+    bool ComputeColumnStats(
+        const std::string& tableName,
+        const std::string& columnName,
+        ColumnStats& stats,
+        std::stop_token stop = {}
+    );
+
+    /*
+        Run PRAGMA quick_check on a read-only connection. Problems found,
+        if any, are stored in 'problems'. 'onProgress' is called from the
+        calling thread with the seconds elapsed so far, quick_check has no
+        way of telling how much is left. Meant to be called from a worker thread.
+        Returns false on error or if 'stop' was requested.
+    */
+    bool QuickCheck(
+        std::vector<std::string>& problems,
+        const std::function<void(double)>& onProgress,
+        std::stop_token stop = {}
+    );
+
+    /*
+        Estimate the rows of every table without scanning any: from
+        sqlite_stat1 where ANALYZE has been run, otherwise from the pages on
+        one path down the table's b-tree where dbstat is available, capped
+        by max(rowid). Tables that fit on one page are counted exactly.
+        Tables with none of these, and virtual tables, are left out.
+        Runs on a read-only connection, meant to be called from a worker thread.
+        Returns false on error or if 'stop' was requested.
+    */
+    bool EstimateRowCounts(std::map<std::string, RowCount>& counts, std::stop_token stop = {});
+
+    /*
+        COUNT(*) each of 'tableNames' in turn on one read-only connection,
+        calling 'onCounted' from the calling thread after each. Tables that
+        can't be counted, such as virtual tables of a module that isn't
+        loaded, are skipped. A stop request interrupts the table being counted.
+        Returns false on error or if 'stop' was requested.
+    */
+    bool CountRows(
+        const std::vector<std::string>& tableNames,
+        const std::function<void(const std::string&, uint64_t)>& onCounted,
+        std::stop_token stop = {}
+    );
+
+    /*
+        Write every edit in 'journal' to 'tableName' in one transaction,
+        reusing one prepared statement per distinct statement shape.
+        The changes are recorded with the session extension into 'undo',
+        which UndoChangeset can later revert. Nothing is written on failure.
+    */
+    bool CommitEdits(const std::string& tableName, const EditJournal& journal, Changeset& undo);
+    bool UndoChangeset(const Changeset& changeset); // Revert a changeset from CommitEdits. Fails if rows changed since
+
+    /*
+        Copy the open data base to 'destPath' with the sqlite3_backup API
+        while it stays usable. Pages are copied in batches and the source
+        lock is released with a short pause between batches, so writers
+        (including other processes) are never starved for long.
+        A data base opened in memory can be written back to its own file.
+        Blocks until done, meant to be called from a worker thread.
+    */
+    bool BackupTo(
+        const std::string& destPath,
+        const std::function<void(const BackupProgress&)>& onProgress,
+        std::stop_token stop = {}
+    );
+
+    /*
+        Write the data base as a compressed archive, which Connect opens
+        read-only with ConnectProfile::compressedArchive. A VACUUM INTO copy
+        is made next to 'destPath' on a read connection, so the data base
+        stays usable, and then compressed chunk by chunk on every core.
+        Progress is only reported while compressing. Archives can't be
+        archived again, Save As restores a plain copy of one instead.
+        Blocks until done, meant to be called from a worker thread.
+    */
+    bool ExportCompressedArchive(
+        const std::string& destPath,
+        const std::function<void(const ArchiveProgress&)>& onProgress = {},
+        std::stop_token stop = {}
+    );
+
+    // Exporting. The ExportTableTo functions gzip compress files named *.gz, see gzip_stream.hxx
+    bool ExportTableToJSON(const std::string& tableName, const std::string& outputFilename);
+    bool ExportTableToCSV(const std::string& tableName, const std::string& outputFilename);
+    bool ExportTableToArrow(const std::string& tableName, const std::string& outputFilename);
+    bool ExportTableToParquet(const std::string& tableName, const std::string& outputFilename);
+    bool ExportTable(const std::string& tableName, std::ostream& out, ExportFormat format);
+    bool ExportQuery(const std::string& sql, std::ostream& out, ExportFormat format); // Stream the rows of any query
+
+    /*
+        Write the whole data base as SQL, like the sqlite3 shell's .dump:
+        every table's CREATE statement followed by its rows as multi-row
+        INSERTs, then indexes, views and triggers, in one transaction.
+
+        Tables are generated in parallel, each worker on a read connection
+        of its own kept for all the tables it takes, into an anonymous
+        temporary file per table. The files are appended to 'out' in schema
+        order as they complete. A read transaction is held until every
+        worker has started its own, so in rollback journal mode all tables
+        come from the same state. In WAL mode a commit landing while the
+        workers start may be seen by some tables and not others.
+
+        Internal sqlite_stat tables and the contents of virtual tables are
+        not written. Blocks until done, meant to be called from a worker thread.
+    */
+    bool ExportDump(
+        std::ostream& out,
+        const std::function<void(const DumpProgress&)>& onProgress = {},
+        std::stop_token stop = {}
+    );
+
+    // Importing
+    // Appends the rows of a CSV stream to 'tableName' in one transaction.
+    // The first row is the header, used to create the table if it doesn't exist.
+    bool ImportCSV(const std::string& tableName, std::istream& in, uint64_t& rowsImported);
+
+    /*
+        Expose a CSV file as the read-only temp table 'tableName' through the
+        csvfile virtual table module, see csv_vtab.hxx. Nothing is imported,
+        queries read the memory mapped file directly.
+    */
+    bool AttachCSV(const std::string& csvPath, const std::string& tableName);
+
+    /*
+        Run every statement of the SQL file at 'scriptPath' on the open data base.
+        The file is memory mapped and handed to sqlite3_prepare_v3 a statement
+        at a time, so scripts of any size run without being read into memory.
+        Statements run as written, each in its own transaction unless the
+        script begins one. On failure 'error' holds the message and line of
+        the failing statement and a transaction left open by it is rolled back.
+        Blocks until done, meant to be called from a worker thread.
+    */
+    bool ExecuteScript(
+        const std::string& scriptPath,
+        std::string& error,
+        const std::function<void(const ScriptProgress&)>& onProgress,
+        std::stop_token stop = {}
+    );
+
+    /*
+        Restore a SQL dump, such as the output of the sqlite3 shell's .dump,
+        into the open data base as fast as SQLite allows. Statements stream
+        from the mapped file like ExecuteScript, but the dump's own BEGIN and
+        COMMIT are ignored in favour of committing every few thousand
+        statements, foreign keys are not enforced until the end and non-unique
+        indexes are created once all rows are in. 'foreignKeyViolations' counts
+        the rows PRAGMA foreign_key_check reports afterwards, when foreign keys
+        are enabled. On failure the batch in progress is rolled back, earlier
+        batches stay. Blocks until done, meant to be called from a worker thread.
+    */
+    bool ImportDump(
+        const std::string& dumpPath,
+        uint64_t& foreignKeyViolations,
+        std::string& error,
+        const std::function<void(const ScriptProgress&)>& onProgress,
+        std::stop_token stop = {}
+    );
+
+    bool ProfileQuery(const std::string& sql, QueryProfile& profile); // Run 'sql' once, discarding its rows
+
+    static std::string QuoteIdentifier(const std::string& name); // "name" with embedded quotes doubled
 private:
     bool TableExists(const std::string& tableName); // check if an SQL table exists
+    sqlite3* OpenReadConnection() const; // Separate read-only handle for background work. Caller closes it
 
     sqlite3* m_db; // SQL database
-    const std::string m_dbPath; // Path to the .db file. Set when DataBase is constructed
+    std::string m_dbPath; // Path to the .db file. Set when connected
+    std::string m_readPath; // m_dbPath, or the URI of the in-memory copy. Set when connected
+    ConnectProfile m_profile; // How the data base was opened. Set when connected
     bool m_connected; // If the database is connected
 };
@@ -0,0 +1,67 @@
+#pragma once
+
+// STD
+#include <cstdint>
+#include <functional>
+#include <stop_token>
+#include <string>
+#include <vector>
+
+/*
+    A single row that differs between the two data bases,
+    identified by its primary key formatted as text.
+*/
+struct RowChange {
+    enum class Kind {
+        Inserted, // Only in the new data base
+        Deleted,  // Only in the old data base
+        Updated,  // In both, with different values
+    };
+
+    Kind kind;
+    std::string key;
+};
+
+/*
+    Differences found in one table.
+    Counts are exact, 'changes' only lists the first MAX_LISTED_CHANGES.
+*/
+struct TableDiff {
+    static constexpr size_t MAX_LISTED_CHANGES = 1000;
+
+    enum class Status {
+        Identical,
+        Changed,
+        Added,         // Only in the new data base
+        Removed,       // Only in the old data base
+        SchemaChanged, // Columns or primary key differ, rows weren't compared
+        Failed,
+    };
+
+    std::string table;
+    Status status = Status::Identical;
+    uint64_t inserted = 0;
+    uint64_t deleted = 0;
+    uint64_t updated = 0;
+    uint64_t rowsRead = 0; // Rows read from both files, a measure of how much work the diff took
+    std::vector<RowChange> changes;
+};
+
+/*
+    Compare every table of 'oldPath' against 'newPath' by primary key
+    (rowid for tables without one).
+
+    Each table is read once from both files in primary key order, the two
+    cursors merged like sorted lists, so a diff costs one pass over both
+    tables however many rows changed. Neither side is held in memory.
+
+    Tables are compared in parallel, each worker on its own read-only
+    connections. 'onTable' is called from the worker threads as each table
+    finishes. Returns false if either file can't be opened or 'stop' was requested.
+*/
+bool DiffDatabases(
+    const std::string& oldPath,
+    const std::string& newPath,
+    const std::function<void(const TableDiff&)>& onTable,
+    std::stop_token stop = {}
+);
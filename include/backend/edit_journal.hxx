@@ -0,0 +1,42 @@
+#pragma once
+
+// SQLite
+#include "ext/sqlite3.h"
+
+// STD
+#include <map>
+#include <set>
+#include <string>
+#include <vector>
+
+/*
+    Pending, uncommitted edits made to a table in the records grid.
+    Nothing touches the data base until DataStore::CommitEdits writes
+    the whole journal in a single transaction.
+
+    Existing rows are identified by rowid. New rows only exist in the
+    journal until committed and are identified by their index in it.
+*/
+class EditJournal {
+public:
+    using Row = std::map<std::string, std::string>; // column name -> new value
+
+    void SetCell(sqlite3_int64 rowId, const std::string& column, const std::string& value);
+    void DeleteRow(sqlite3_int64 rowId); // Also drops pending updates to the row
+
+    size_t AddRow(); // Returns the index of the new row
+    void SetNewRowCell(size_t index, const std::string& column, const std::string& value);
+    void RemoveNewRow(size_t index); // Later new rows move down by one
+
+    bool Empty() const { return m_updates.empty() && m_inserts.empty() && m_deletes.empty(); }
+    size_t Size() const { return m_updates.size() + m_inserts.size() + m_deletes.size(); } // Rows affected
+    void Clear();
+
+    const std::map<sqlite3_int64, Row>& Updates() const { return m_updates; }
+    const std::vector<Row>& Inserts() const { return m_inserts; }
+    const std::set<sqlite3_int64>& Deletes() const { return m_deletes; }
+private:
+    std::map<sqlite3_int64, Row> m_updates; // Ordered by rowid so updates are applied in b-tree order
+    std::vector<Row> m_inserts;
+    std::set<sqlite3_int64> m_deletes;
+};
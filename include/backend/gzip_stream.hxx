@@ -0,0 +1,80 @@
+#pragma once
+
+// STD
+#include <condition_variable>
+#include <cstdint>
+#include <deque>
+#include <memory>
+#include <mutex>
+#include <ostream>
+#include <streambuf>
+#include <string>
+#include <thread>
+#include <vector>
+
+/*
+    Stream buffer gzip compressing everything written to it into 'out',
+    with the compression spread over worker threads, like pigz.
+
+    Input is cut into BLOCK_SIZE blocks, each deflated on its own by a
+    worker, primed with the last 32 KiB of the block before it so the
+    ratio stays close to single threaded gzip. Blocks end on a byte
+    boundary, so the compressed blocks written back to back, in order,
+    form one ordinary gzip member any gunzip can read.
+
+    The thread writing to the stream keeps formatting rows while earlier
+    blocks are compressed. It writes finished blocks to 'out' as it goes
+    and only waits once MAX_BLOCKS_PER_THREAD blocks per worker are queued.
+*/
+class GzipStreamBuf : public std::streambuf {
+public:
+    static constexpr size_t BLOCK_SIZE = 512 * 1024;
+    static constexpr size_t MAX_BLOCKS_PER_THREAD = 2;
+
+    GzipStreamBuf(std::ostream& out, int level, unsigned threads); // 'threads' 0 uses one per core
+    ~GzipStreamBuf() override; // Finishes the stream, if Finish wasn't called
+
+    bool Finish(); // Compress what is left and write the gzip trailer. False if writing to 'out' failed
+protected:
+    int_type overflow(int_type c) override; // The block is full
+    int sync() override; // Compress and write out everything written so far
+private:
+    struct Block;
+
+    void Submit(bool last); // Queue the current block for compression
+    void WriteFinished(size_t maxQueued); // Write finished blocks in order, waiting while more than 'maxQueued' remain
+    void Work(std::stop_token stop);
+
+    std::ostream& m_out;
+    int m_level;
+    std::string m_input; // Block being filled, the put area
+    std::string m_dictionary; // Tail of the previous block
+    uint32_t m_crc; // CRC-32 of everything written out so far
+    uint64_t m_size = 0; // Uncompressed bytes written out so far
+    bool m_finished = false;
+    bool m_ok = true;
+
+    std::mutex m_mutex;
+    std::condition_variable_any m_queued; // Signalled when a block is queued for the workers
+    std::condition_variable m_compressed; // Signalled when a worker finishes a block
+    std::deque<std::shared_ptr<Block>> m_blocks; // In stream order, compressed or not
+    std::deque<std::shared_ptr<Block>> m_work; // Queued for a worker
+    std::vector<std::jthread> m_workers; // Destroyed first, stopping them before the queues go
+};
+
+/*
+    std::ostream over a GzipStreamBuf, so any exporter can write compressed.
+    Close must be called, or the stream destroyed, before 'out' is complete.
+*/
+class GzipOStream : public std::ostream {
+public:
+    static constexpr int DEFAULT_LEVEL = 6; // gzip's default, most of the ratio at a fraction of the time of 9
+
+    explicit GzipOStream(std::ostream& out, int level = DEFAULT_LEVEL, unsigned threads = 0);
+
+    bool Close(); // Finish compressing. False if anything failed to be written
+private:
+    GzipStreamBuf m_buffer;
+};
+
+bool IsGzipPath(const std::string& path); // The file name ends in ".gz"
@@ -0,0 +1,62 @@
+#pragma once
+
+// STD
+#include <cstdint>
+
+/*
+    Files SQLite opens, grouped by what they are for.
+*/
+enum class IoFileKind {
+    MainDb,  // The data base file itself
+    Journal, // Rollback journal
+    Wal,     // Write-ahead log
+    Temp,    // Temp data bases, statement journals and sorter spill files
+    Count,
+};
+
+/*
+    Call latencies in power of two buckets: bucket i counts calls that
+    took less than 2^i microseconds, the last bucket everything slower.
+*/
+struct LatencyHistogram {
+    static constexpr int BUCKETS = 24; // The last bucket starts at about 4 seconds
+
+    uint64_t counts[BUCKETS] = {};
+
+    uint64_t Total() const;
+    double PercentileMicros(double percentile) const; // Upper bound of the bucket holding 'percentile' (0 to 1), 0 if empty
+};
+
+struct FileIoStats {
+    uint64_t opens = 0;
+    uint64_t reads = 0;
+    uint64_t bytesRead = 0;
+    uint64_t writes = 0;
+    uint64_t bytesWritten = 0;
+    uint64_t syncs = 0;
+    uint64_t locks = 0; // Lock, unlock, reserved lock checks and WAL shared memory locks
+    LatencyHistogram readLatency;
+    LatencyHistogram writeLatency;
+    LatencyHistogram syncLatency;
+};
+
+struct IoStats {
+    FileIoStats files[static_cast<int>(IoFileKind::Count)];
+
+    const FileIoStats& operator[](IoFileKind kind) const { return files[static_cast<int>(kind)]; }
+};
+
+/*
+    "sqlight-io" VFS: a shim over the default VFS counting every call
+    made on the files it opens, per IoFileKind, with read, write and sync
+    latencies. Counters are process wide and cheap enough to leave on, a
+    few relaxed atomic increments and a clock read per call.
+
+    Registered, not as the default, by the first call. Returns the name to
+    pass to sqlite3_open_v2, or nullptr if there is no default VFS to wrap.
+*/
+const char* RegisterIoStatsVfs();
+
+IoStats ReadIoStats(); // Counters since startup or the last reset
+void ResetIoStats();
+const char* IoFileKindName(IoFileKind kind); // "main", "journal", "wal" or "temp"
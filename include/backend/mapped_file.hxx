@@ -0,0 +1,34 @@
+#pragma once
+
+// STD
+#include <cstdint>
+#include <string>
+
+/*
+    A whole file mapped read-only into memory. The OS pages it in on
+    demand, so files far larger than RAM can be read without copying
+    them into buffers first. Empty files map to Data() == nullptr.
+*/
+class MappedFile {
+public:
+    MappedFile() = default;
+    ~MappedFile();
+
+    MappedFile(const MappedFile&) = delete;
+    MappedFile& operator=(const MappedFile&) = delete;
+
+    bool Open(const std::string& path); // Map the file at 'path', closing any file mapped before
+    void Close();
+
+    bool IsOpen() const { return m_open; }
+    const char* Data() const { return m_data; }
+    uint64_t Size() const { return m_size; }
+private:
+    const char* m_data = nullptr;
+    uint64_t m_size = 0;
+    bool m_open = false;
+#ifdef _WIN32
+    void* m_file = nullptr; // HANDLE
+    void* m_mapping = nullptr; // HANDLE
+#endif
+};
@@ -0,0 +1,76 @@
+#pragma once
+
+// Backend
+#include "backend/column_stats.hxx"
+#include "backend/data_store.hxx"
+
+// STD
+#include <cstdint>
+#include <map>
+#include <string>
+#include <utility>
+#include <vector>
+
+/*
+    Size and modification time of a data base file and of its WAL, if
+    any. Every commit changes at least one of them. An empty WAL, as left
+    by a connection that hasn't written, counts as no WAL, which is what
+    closing the last connection leaves.
+*/
+struct FileIdentity {
+    uint64_t size = 0;
+    int64_t modified = 0; // Ticks of std::filesystem::file_time_type
+    uint64_t walSize = 0;
+    int64_t walModified = 0;
+
+    bool operator==(const FileIdentity&) const = default;
+};
+
+FileIdentity ReadFileIdentity(const std::string& dbPath); // All zero for a file that can't be read
+
+/*
+    What earlier sessions learned about a data base, saved next to it as
+    "<data base>.sqlight-cache" so reopening it can show the table list,
+    row counts and column statistics before reading anything.
+
+    The table list is kept with the PRAGMA schema_version it was read at,
+    so it only has to be read again once the schema changes. Row counts
+    and column statistics depend on the data and are keyed to the file's
+    identity when loaded. Writes by this session re-key them once the
+    entries of the tables written are dropped. Any other change of identity,
+    a write by another process, drops them all.
+
+    The sidecar is a little endian binary file:
+
+        header   magic "SQLightM", format version
+        key      file identity, schema version
+        tables   count, then each name
+        rows     count, then each table name, row count and whether it is exact
+        stats    count, then each ColumnStats field by field
+
+    Strings are a 32 bit length followed by their bytes. A sidecar that is
+    truncated or of another format version is ignored.
+*/
+struct MetadataCache {
+    FileIdentity identity; // Of the data base the row counts and column stats were gathered from
+    int64_t schemaVersion = -1; // PRAGMA schema_version 'tableNames' was read at, -1 if never read
+    std::vector<std::string> tableNames;
+    std::map<std::string, RowCount> rowCounts;
+    std::map<std::pair<std::string, std::string>, ColumnStats> columnStats; // By (table, column)
+
+    bool Load(const std::string& dbPath); // false if there is no usable sidecar, which leaves the cache empty
+    bool Save(const std::string& dbPath) const; // Replace the sidecar. Fails where the data base's folder isn't writable
+    void Clear();
+
+    void ForgetTable(const std::string& tableName); // Drop what was learned from the rows of a table that was written to
+    void ForgetRows(); // Drop the row counts and column stats of every table, keeping the table list
+    void ForgetData(); // Drop everything, the schema included, after writes to any table
+
+    void Revalidate(const std::string& dbPath); // ForgetRows if the file is no longer 'identity', i.e. someone else wrote to it
+    void Rekey(const std::string& dbPath); // Key to the file as it is now, after this session wrote to it
+
+    const ColumnStats* FindColumnStats(const std::string& tableName, const std::string& columnName) const;
+    void StoreColumnStats(const ColumnStats& stats); // Also records stats.estimatedRows as the table's row count, unless it has one
+
+    static std::string SidecarPath(const std::string& dbPath);
+};
@@ -0,0 +1,22 @@
+#pragma once
+
+/*
+    "sqlight-readahead" VFS: a shim prefetching ahead of sequential reads
+    of the main data base file, layered over the I/O statistics VFS.
+
+    Table scans, exports and statistics read a b-tree's leaf pages one at a
+    time. On a vacuumed data base those sit one after another in the file,
+    but SQLite asks for each page separately, which spinning disks and
+    network file systems serve at a fraction of their streaming rate. Once
+    a run of forward reads is seen, the shim asks the OS to start reading
+    the next window of the file into its page cache, doubling the window
+    while the run lasts. A read elsewhere ends the run, so random access
+    costs nothing beyond tracking the last offset.
+
+    Prefetching goes through a descriptor of the shim's own, with
+    posix_fadvise(POSIX_FADV_WILLNEED), or fcntl(F_RDADVISE) on macOS,
+    which return without waiting for the reads. SQLite's own reads are
+    untouched, they find the pages in the OS cache. Elsewhere, or if the
+    file can't be opened again, the shim only passes reads through.
+*/
+const char* RegisterReadAheadVfs(); // The VFS name for sqlite3_open_v2, nullptr if it could not be registered
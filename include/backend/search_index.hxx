@@ -0,0 +1,74 @@
+#pragma once
+
+// SQLite
+#include "ext/sqlite3.h"
+
+// STD
+#include <cstdint>
+#include <map>
+#include <mutex>
+#include <stop_token>
+#include <string>
+#include <unordered_set>
+#include <vector>
+
+/*
+    A cell whose text matched a search.
+*/
+struct SearchHit {
+    std::string table;
+    std::string column;
+    sqlite3_int64 rowId;
+    std::string snippet; // Start of the cell's text
+};
+
+/*
+    In-memory inverted index over the TEXT values of every table, for
+    finding a value anywhere in a data base without querying each column.
+
+    Each table has its own sorted token list, so a search is one binary
+    search per table and dropping or re-indexing a table never touches
+    the others. Refresh compares the schema catalog and max(rowid) of
+    every table with what was indexed and only re-reads tables that were
+    added, altered, appended to or marked dirty. Rows changed in place by
+    other processes are only picked up by Clear() followed by Refresh().
+
+    Refresh and Search are meant to be called from a single worker thread
+    at a time. MarkDirty may be called from any thread.
+*/
+class SearchIndex {
+public:
+    static constexpr size_t MAX_HITS = 200;
+    static constexpr size_t MAX_INDEXED_TEXT = 64 * 1024; // Longer values are only indexed up to here
+
+    bool Refresh(const std::string& dbPath, const char* vfs, std::stop_token stop = {}); // Bring the index up to date with 'dbPath', opened through 'vfs'. See DataStore::GetReadPath and VfsName
+    std::vector<SearchHit> Search(const std::string& query, size_t maxHits = MAX_HITS); // Rows containing every word, the last one as a prefix
+
+    void MarkDirty(const std::string& tableName); // Re-index 'tableName' on the next Refresh
+    void Clear();
+
+    size_t TableCount() const { return m_tables.size(); }
+    size_t TokenCount() const;
+private:
+    struct Posting {
+        uint32_t column;
+        sqlite3_int64 rowId;
+    };
+
+    struct TableIndex {
+        std::string fingerprint; // Schema SQL and max(rowid) when indexed
+        std::vector<std::string> columns;
+        std::vector<std::string> tokens; // Sorted
+        std::vector<std::vector<Posting>> postings; // postings[i] lists the cells containing tokens[i], by rowid
+    };
+
+    bool IndexTable(sqlite3* db, const std::string& tableName, TableIndex& index, std::stop_token stop);
+    std::vector<Posting> Match(const TableIndex& index, const std::string& token, bool prefix) const;
+
+    std::string m_dbPath; // Data base the index was built from
+    const char* m_vfs = nullptr; // VFS m_dbPath is opened through, nullptr for the default
+    std::map<std::string, TableIndex> m_tables;
+
+    std::mutex m_dirtyMutex;
+    std::unordered_set<std::string> m_dirty;
+};
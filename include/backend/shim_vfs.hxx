@@ -0,0 +1,42 @@
+#pragma once
+
+// SQLite
+#include "ext/sqlite3.h"
+
+/*
+    Building blocks for VFS shims, VFSes layered over another one that
+    only change what happens to the files they open.
+
+    InitShimVfs fills 'vfs' with methods forwarding to 'real', kept in
+    pAppData, and sets its xOpen to 'open'. szOsFile leaves room for a
+    ShimFile followed by the real file, which 'open' opens in place with
+    the real VFS. The shim then registers 'vfs', which must stay alive for
+    as long as the process.
+*/
+using ShimOpen = int (*)(sqlite3_vfs* vfs, sqlite3_filename name, sqlite3_file* file, int flags, int* outFlags);
+
+void InitShimVfs(sqlite3_vfs& vfs, sqlite3_vfs* real, const char* name, ShimOpen open);
+
+inline sqlite3_vfs* ShimRealVfs(sqlite3_vfs* vfs) { return static_cast<sqlite3_vfs*>(vfs->pAppData); }
+
+/*
+    What a shim hands SQLite as its file. The real file follows it in
+    the same allocation.
+*/
+struct ShimFile {
+    sqlite3_file base;
+    void* state; // The shim's own
+};
+
+inline sqlite3_file* ShimRealFile(sqlite3_file* file) { return reinterpret_cast<sqlite3_file*>(reinterpret_cast<ShimFile*>(file) + 1); }
+
+template <typename State>
+State* ShimState(sqlite3_file* file) { return static_cast<State*>(reinterpret_cast<ShimFile*>(file)->state); }
+
+/*
+    File methods of 'version' (1 to 3) passing every call on to the real
+    file, for a shim to start from and replace the calls it cares about.
+    SQLite decides whether to use shared memory and memory maps from
+    iVersion, so shims should give each file the version its real file has.
+*/
+sqlite3_io_methods ShimForwardingMethods(int version);
@@ -0,0 +1,50 @@
+#pragma once
+
+// STD
+#include <chrono>
+#include <string>
+
+/*
+    Lightweight scoped timers recorded in memory and written out in the
+    Chrome trace event format (load in chrome://tracing or Perfetto).
+
+    Use the TRACE_SCOPE / TRACE_INSTANT macros rather than the functions
+    directly. They compile to nothing unless SQLIGHT_ENABLE_TRACING is
+    defined, so release builds pay nothing for the instrumentation.
+*/
+namespace Trace {
+    using Clock = std::chrono::steady_clock;
+
+    /*
+        Records a complete ("X") event spanning its own lifetime.
+        'name' must outlive the trace, string literals are expected.
+    */
+    class Scope {
+    public:
+        explicit Scope(const char* name) : m_name(name), m_start(Clock::now())
+        {
+        }
+
+        ~Scope();
+
+        Scope(const Scope&) = delete;
+        Scope& operator=(const Scope&) = delete;
+    private:
+        const char* m_name;
+        Clock::time_point m_start;
+    };
+
+    void Instant(const char* name); // Records a single point in time, e.g first paint
+    double ElapsedMs(); // Milliseconds since the process started tracing, at static initialization
+    bool WriteChromeTrace(const std::string& path); // Write every recorded event as JSON
+}
+
+#ifdef SQLIGHT_ENABLE_TRACING
+    #define TRACE_CONCAT_INNER(a, b) a##b
+    #define TRACE_CONCAT(a, b) TRACE_CONCAT_INNER(a, b)
+    #define TRACE_SCOPE(name) Trace::Scope TRACE_CONCAT(traceScope, __LINE__)(name)
+    #define TRACE_INSTANT(name) Trace::Instant(name)
+#else
+    #define TRACE_SCOPE(name) ((void)0)
+    #define TRACE_INSTANT(name) ((void)0)
+#endif
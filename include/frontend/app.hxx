@@ -23,6 +23,16 @@ public:
      * @return true if initialization succeeds, false otherwise.
      */
     bool OnInit();
+
+    /**
+     * @brief Cleans up before the application exits.
+     *
+     * In tracing builds this writes the recorded startup trace to the
+     * file named by the SQLIGHT_TRACE_FILE environment variable.
+     *
+     * @return The application exit code.
+     */
+    int OnExit() override;
 };
 
 wxIMPLEMENT_APP(App);
\ No newline at end of file
@@ -0,0 +1,43 @@
+#pragma once
+
+// Backend
+#include "backend/data_store.hxx"
+
+// WX Components
+#include <wx/wx.h> // wx Core
+#include <wx/panel.h>
+
+/**
+ * @class BlobViewer
+ * @brief Shows the contents of a BLOB cell one page at a time.
+ *
+ * Pages are read on demand through a BlobReader, so only PAGE_SIZE bytes
+ * are in memory at once regardless of how large the BLOB is. BLOBs holding
+ * an image can also be previewed, decoded straight from the blob stream.
+ */
+class BlobViewer : public wxPanel {
+public:
+    static constexpr int PAGE_SIZE = 4096; // Bytes shown in the hex view at once
+    static constexpr int BYTES_PER_LINE = 16;
+    static constexpr int MAX_PREVIEW_SIZE = 64 * 1024 * 1024; // Larger BLOBs are not decoded as images
+    static constexpr int PREVIEW_SIZE = 160; // Largest side of the image preview, in pixels
+
+    explicit BlobViewer(wxWindow* parent);
+
+    // Show the BLOB in 'columnName' of row 'rowId'. False if the cell isn't a BLOB.
+    bool Load(DataStore& store, const std::string& tableName, const std::string& columnName, sqlite3_int64 rowId);
+    void Clear();
+private:
+    void ShowPage(int page);
+    void ShowImagePreview();
+
+    BlobReader m_reader;
+    int m_page = 0;
+
+    wxStaticText* m_sizeLabel;
+    wxButton* m_previousPage;
+    wxButton* m_nextPage;
+    wxButton* m_previewButton;
+    wxTextCtrl* m_hexView;
+    wxStaticBitmap* m_preview;
+};
@@ -12,4 +12,13 @@ namespace AppColours {
         const wxColour COMMENTLINE = wxColour(70, 133, 73);
         const wxColour STRING = wxColour(161, 84, 84);
     }
+
+    namespace Records {
+        const wxColour EDITED = wxColour(255, 246, 200); // Cells with uncommitted edits
+    }
+
+    namespace Output {
+        const wxColour ERROR_TEXT = wxColour(176, 32, 32);
+        const wxColour WARNING_TEXT = wxColour(178, 110, 0);
+    }
 }
@@ -0,0 +1,30 @@
+#pragma once
+
+// Backend
+#include "backend/io_stats.hxx"
+
+// WX Components
+#include <wx/wx.h> // wx Core
+#include <wx/panel.h>
+#include <wx/listctrl.h>
+#include <wx/timer.h>
+
+/**
+ * @class DiagnosticsView
+ * @brief Notebook tab showing the I/O SQLite has done, per kind of file.
+ *
+ * One line per IoFileKind with call and byte counts and latency
+ * percentiles from the "sqlight-io" VFS, refreshed every second while
+ * the tab is shown. Reset zeroes the counters, so the effect of a single
+ * query or action can be read off directly.
+ */
+class DiagnosticsView : public wxPanel {
+public:
+    explicit DiagnosticsView(wxWindow* parent);
+
+    void ShowCounters(); // Read the counters again
+private:
+    wxStaticText* m_summary;
+    wxListCtrl* m_files;
+    wxTimer m_refreshTimer;
+};
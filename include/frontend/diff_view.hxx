@@ -0,0 +1,35 @@
+#pragma once
+
+// Backend
+#include "backend/db_diff.hxx"
+
+// WX Components
+#include <wx/wx.h> // wx Core
+#include <wx/panel.h>
+#include <wx/listctrl.h>
+
+/**
+ * @class DiffView
+ * @brief Notebook tab listing the differences between two data base files.
+ *
+ * The top list has one line per table with its status and change counts,
+ * filled in as DiffDatabases finishes each table. Selecting a table lists
+ * the keys of its changed rows below.
+ */
+class DiffView : public wxPanel {
+public:
+    explicit DiffView(wxWindow* parent);
+
+    void Start(const wxString& oldName, const wxString& newName); // Clear the lists for a new comparison
+    void AddTable(const TableDiff& diff); // Add a table, keeping the list sorted by name
+    void Finish(bool completed, double seconds); // Show the totals once every table is done
+private:
+    void OnTableSelected(wxListEvent& event);
+
+    std::vector<TableDiff> m_diffs; // Same order as the rows of m_tables
+    wxString m_title; // "old.db -> new.db"
+
+    wxStaticText* m_summary;
+    wxListCtrl* m_tables;
+    wxListCtrl* m_changes;
+};
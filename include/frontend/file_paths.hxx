@@ -1,4 +0,0 @@
-// Constant string views that store the path of important directories
-// Like the assets folder which stores icons, etc
-
-constexpr std::string ASSET_DIR = "./assets/"; // Path where assets like icons are located
@@ -2,6 +2,18 @@
 
 // Backend
 #include "backend/data_store.hxx"
+#include "backend/mapped_file.hxx"
+#include "backend/metadata_cache.hxx"
+#include "backend/search_index.hxx"
+#include "backend/trace.hxx"
+
+// Frontend
+#include "frontend/blob_viewer.hxx"
+#include "frontend/diagnostics_view.hxx"
+#include "frontend/diff_view.hxx"
+#include "frontend/output_log.hxx"
+#include "frontend/schema_tree_store.hxx"
+#include "frontend/update_scheduler.hxx"
 
 // WX Components
 #include <wx/wx.h> // wx Core
@@ -12,6 +24,13 @@
 #include <wx/grid.h>
 #include <wx/splitter.h>
 #include <wx/aui/auibook.h>
+#include <wx/progdlg.h>
+#include <wx/srchctrl.h>
+#include <wx/timer.h>
+
+// STD
+#include <map>
+#include <thread>
 
 /**
  * @class MainFrame
@@ -20,13 +39,62 @@
 class MainFrame : public wxFrame {
 public:
     explicit MainFrame(std::string_view title);
-    ~MainFrame() override = default;
+    ~MainFrame() override;
 
     wxString GetSQLWordList();
     void AppendTableColumn(const std::string& name);
+    bool OpenDatabase(const std::string& path, ConnectProfile profile = {}); // Replace the open data base with the one at 'path'. Archives are detected whatever 'profile' says
 private:
     // Events
     void OnCharAdded(wxStyledTextEvent& event);
+    void OnOpenDatabase(wxCommandEvent& event);
+    void OnOpenReadOnly(wxCommandEvent& event);
+    void OnOpenInMemory(wxCommandEvent& event);
+    void OnOpenScript(wxCommandEvent& event);
+    void OnExecuteScriptFile(wxCommandEvent& event);
+    void OnImportDump(wxCommandEvent& event);
+    void OnSaveAs(wxCommandEvent& event);
+    void OnExportDump(wxCommandEvent& event);
+    void OnSaveArchive(wxCommandEvent& event);
+    void OnCompareDatabase(wxCommandEvent& event);
+    void OnShowIoStats(wxCommandEvent& event);
+    void OnSearch(wxCommandEvent& event);
+    void OnSearchHitActivated(wxDataViewEvent& event);
+    void OnTableSelected(wxCommandEvent& event);
+    void OnGridCellSelected(wxGridEvent& event);
+    void OnGridCellChanged(wxGridEvent& event);
+    void OnSaveRecords(wxCommandEvent& event);
+    void OnNewRecord(wxCommandEvent& event);
+    void OnDeleteRecord(wxCommandEvent& event);
+    void OnUndo(wxCommandEvent& event);
+#ifdef SQLIGHT_ENABLE_TRACING
+    void OnFirstPaint(wxPaintEvent& event); // Startup benchmark hook
+#endif
+
+    // Data base helpers
+    void CloseDatabase(); // Disconnect, then write m_metadata to the data base's sidecar
+    void RevalidateMetadata(); // Before this session writes: drop cached rows if someone else wrote since
+    void RekeyMetadata(); // After this session wrote: key m_metadata to the file as it is now
+    void EnableWriting(bool enable); // Grey out the grid editing, buttons and menu items that write to the data base
+    void SaveCopy(const std::string& destPath); // Back up to 'destPath' on m_backupWorker, with a progress dialog
+    void RefreshTableList(const std::vector<std::string>& tableNames, const std::string& select = {}); // Fill the table dropdown and tree, and show 'select', or the first table
+    void StartRowCounts(); // Estimate, then count, the rows of the tables in the tree on m_rowCountWorker
+    void PauseRowCounts(); // Stop m_rowCountWorker while the user works, restarted once they are idle
+    void ShowRowCount(const std::string& tableName); // Put the table's row count from m_metadata in the tree
+    void ClearTableRecords(); // Empty the grid and forget the shown table
+    void LoadTableRecords(const std::string& tableName); // Show the rows of 'tableName' in the grid
+    void UpdateCellInfo(); // Refresh the Cell Info pane for m_selectedCell
+    void ShowColumnStats(int col); // Compute stats for a grid column in the background
+    void ShowCellBlob(int row, int col); // Show the BLOB viewer if the cell holds a BLOB
+    void ShowSearchHits(const std::vector<SearchHit>& hits, double milliseconds); // List hits under the tree's search node
+    void ClearSearchHits(); // Remove the search node from the tree
+    void JumpToSearchHit(const SearchHit& hit); // Show the row of a hit in the Records tab
+
+    // SQL scripts
+    void OpenScript(const std::string& path); // Load a script into the editor, in chunks
+    void LoadScriptChunk(int generation); // Append the next piece of m_scriptFile to the editor
+    void SetLargeScriptMode(bool large); // Trade editor features for speed on huge scripts
+    void ExecuteScriptFile(const std::string& path, bool importDump = false); // Run a script straight from its file, without the editor
 
     // Can the user close the aui page.
     // If its essential to the user program, bind a close event
@@ -47,10 +115,60 @@ private:
 
     // UI Components
     wxStyledTextCtrl* m_textEditor; // styledTextCtrl IDE-like text editor
-    wxGrid* m_tableDataView;
+    wxGrid* m_tableDataView = nullptr;
+    wxChoice* m_tableSelector; // Dropdown to choose which table is shown in the grid
+    wxStaticText* m_cellInfoLabel;
+    wxTextCtrl* m_cellInfo; // Information about the selected cell and its column
+    BlobViewer* m_blobViewer; // Hex/image view of BLOB cells, hidden for other cells
     wxPanel* m_windowLeftPanel;
     wxPanel* m_windowRightPanel;
     wxSplitterWindow* m_windowSplitterPanel;
+    wxAuiNotebook* m_notebook; // Tabs of the right panel
+    wxDataViewTreeCtrl* m_treeView; // Schema tree on the left panel
+    wxSearchCtrl* m_searchBox; // Search everything, above the tree
+    SchemaTreeStore* m_treeStore; // Model of m_treeView
+    wxDataViewItem m_tablesNode; // "Tables (n)" container of the tree
+    std::map<std::string, wxDataViewItem> m_tableItems; // Child of m_tablesNode for each table
+    wxDataViewItem m_searchResults; // Tree container listing the last search's hits
+    OutputLog* m_output; // "Output" tab, the active log target while the frame exists
+    wxLog* m_previousLog = nullptr; // Log target replaced by m_output's, restored on destruction
+    DiffView* m_diffView = nullptr; // "Diff" tab, created by the first comparison. Dangling once the tab is closed
+    DiagnosticsView* m_diagnosticsView = nullptr; // "I/O" tab, created by View > I/O Statistics. Dangling once the tab is closed
+    wxMenuItem* m_checkOnOpenItem; // File > Check Integrity on Open
+    wxMenuItem* m_importDumpItem; // File > Import SQL Dump
+    wxMenuItem* m_executeFileItem; // Run > Execute Script File
+    wxBitmapButton* m_saveRecordsButton; // Above the grid
+    wxBitmapButton* m_newRecordButton;
+    wxBitmapButton* m_deleteRecordButton;
+
+    UpdateScheduler m_uiUpdates; // Coalesces refreshes requested by caret moves, cell selection etc.
+    UpdateScheduler::TaskId m_marginUpdate; // Line number margin width
+    UpdateScheduler::TaskId m_cellInfoUpdate; // Cell Info pane for m_selectedCell
+    int m_marginDigits = 0; // Digits the line number margin is sized for
+    wxGridCellCoords m_selectedCell; // Grid cell the Cell Info pane is (or is about to be) showing
 
     DataStore m_backend; // Backend data base
+    std::string m_shownTable; // Table currently loaded in the grid
+    std::vector<sqlite3_int64> m_rowIds; // rowid of each grid row. Rows past the end are new, uncommitted rows
+    EditJournal m_editJournal; // Grid edits not yet written to the data base
+    std::vector<std::pair<std::string, Changeset>> m_undoStack; // (table, changeset) per saved batch of edits, most recent last
+    std::jthread m_statsWorker; // Background column stats scan. Replacing it stops the previous scan
+    int m_statsColumn = -1; // Grid column the Cell Info stats were last computed for
+    std::jthread m_backupWorker; // Online backup started by Save As or an in-memory Save, or archive by Save Compressed Archive
+    wxProgressDialog* m_backupProgress = nullptr;
+    std::jthread m_dumpWorker; // SQL dump started by File > Export SQL Dump
+    wxProgressDialog* m_dumpProgress = nullptr;
+    std::jthread m_openWorker; // Schema load and integrity check after opening. Replacing it stops them
+    std::jthread m_diffWorker; // Comparison started by File > Compare With
+    MappedFile m_scriptFile; // Script being appended to the editor, closed once fully loaded
+    uint64_t m_scriptLoaded = 0; // Bytes of m_scriptFile already in the editor
+    int m_scriptLoadGeneration = 0; // Bumped by OpenScript, so chunks of an abandoned load are dropped
+    bool m_largeScriptMode = false;
+    std::jthread m_scriptWorker; // Script file being executed by Run > Execute Script File
+    wxProgressDialog* m_scriptProgress = nullptr;
+    MetadataCache m_metadata; // Table list, row counts and stats of the open data base, from its sidecar and this session
+    std::jthread m_rowCountWorker; // Row estimates and exact counts for the tree. Replacing it stops the count
+    wxTimer m_rowCountTimer; // Restarts m_rowCountWorker once the user has been idle for ROW_COUNT_IDLE_MS
+    SearchIndex m_searchIndex; // Inverted index over the text of the open data base, built by the first search
+    std::jthread m_searchWorker; // Brings m_searchIndex up to date and searches it
 };
\ No newline at end of file
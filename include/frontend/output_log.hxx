@@ -0,0 +1,79 @@
+#pragma once
+
+// WX Components
+#include <wx/wx.h> // wx Core
+#include <wx/panel.h>
+#include <wx/listctrl.h>
+#include <wx/timer.h>
+#include <wx/log.h>
+
+// STD
+#include <atomic>
+#include <deque>
+#include <mutex>
+#include <vector>
+
+/**
+ * @class OutputLog
+ * @brief The "Output" tab. A bounded log of messages shown in a virtual list.
+ *
+ * Records are kept in a ring buffer of CAPACITY lines, the oldest lines are
+ * dropped once it is full, so memory stays flat no matter how much a script
+ * prints. The list only asks for the text of the rows on screen.
+ *
+ * Append may be called from any thread. Lines are queued and moved into the
+ * ring buffer at most once per FLUSH_INTERVAL_MS, so a burst of a million
+ * lines costs a handful of repaints rather than one per line.
+ */
+class OutputLog : public wxPanel {
+public:
+    static constexpr size_t CAPACITY = 100000; // Lines kept, older lines are dropped
+    static constexpr size_t MAX_LINE_LENGTH = 4096; // Longer lines are cut short
+    static constexpr int FLUSH_INTERVAL_MS = 16; // About one frame
+
+    explicit OutputLog(wxWindow* parent);
+
+    void Append(wxLogLevel level, const wxString& text); // Queue one line per line of 'text'. Thread safe
+    void Clear();
+private:
+    class List;
+
+    struct Record {
+        wxDateTime time;
+        wxLogLevel level;
+        wxString text;
+    };
+
+    void Flush(); // Move queued lines into the ring buffer and update the list
+    const Record& At(size_t index) const; // index 0 is the oldest line kept
+
+    std::mutex m_pendingMutex;
+    std::deque<Record> m_pending; // Appended but not yet shown, at most CAPACITY
+    std::atomic<bool> m_flushQueued = false;
+
+    std::vector<Record> m_records; // Ring buffer, grows up to CAPACITY
+    size_t m_first = 0; // Index of the oldest record once m_records is full
+
+    List* m_list;
+    wxTimer m_flushTimer;
+};
+
+/**
+ * @class OutputLogTarget
+ * @brief wxLog target writing every message to an OutputLog.
+ *
+ * Errors, warnings and status messages are also passed on to 'previous',
+ * the application's usual target, so they are still shown in a dialog or
+ * the status bar. Plain messages only go to the Output tab.
+ */
+class OutputLogTarget : public wxLog {
+public:
+    OutputLogTarget(OutputLog* output, wxLog* previous);
+
+    void Flush() override;
+protected:
+    void DoLogRecord(wxLogLevel level, const wxString& msg, const wxLogRecordInfo& info) override;
+private:
+    OutputLog* m_output;
+    wxLog* m_previous; // Not owned
+};
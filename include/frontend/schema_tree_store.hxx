@@ -0,0 +1,27 @@
+#pragma once
+
+// WX Components
+#include <wx/dataview.h>
+
+// STD
+#include <unordered_map>
+
+/**
+ * @class SchemaTreeStore
+ * @brief Model of the schema tree, a wxDataViewTreeStore with a "Type" column.
+ *
+ * wxDataViewTreeStore only knows the icon and label of column 0 and gives
+ * them for every column. This keeps a line of text per item for column 1,
+ * such as a table's row count, and leaves it empty for the others.
+ */
+class SchemaTreeStore : public wxDataViewTreeStore {
+public:
+    void SetDetail(const wxDataViewItem& item, const wxString& detail); // Text of the Type column, redrawn right away
+    void ClearDetails(); // Call before deleting items that have details, their addresses get reused
+
+    unsigned int GetColumnCount() const override;
+    wxString GetColumnType(unsigned int col) const override;
+    void GetValue(wxVariant& variant, const wxDataViewItem& item, unsigned int col) const override;
+private:
+    std::unordered_map<void*, wxString> m_details; // By wxDataViewItem::GetID()
+};
@@ -0,0 +1,49 @@
+#pragma once
+
+// WX Components
+#include <wx/event.h>
+#include <wx/timer.h>
+
+// STD
+#include <chrono>
+#include <functional>
+#include <vector>
+
+/**
+ * @class UpdateScheduler
+ * @brief Coalesces UI refreshes requested by high frequency events.
+ *
+ * Each update is registered once with the minimum time between two runs.
+ * Event handlers then only call Request, which costs a flag and, at most,
+ * arming a timer. However many requests arrive in between, the update runs
+ * once: right away if it hasn't run for 'interval', otherwise as soon as
+ * the interval is up. Must only be used from the UI thread.
+ */
+class UpdateScheduler : public wxEvtHandler {
+public:
+    using Clock = std::chrono::steady_clock;
+    using TaskId = size_t;
+
+    static constexpr int FRAME_MS = 16; // Default interval, about one frame
+
+    UpdateScheduler();
+
+    TaskId Register(std::function<void()> update, int intervalMs = FRAME_MS);
+    void Request(TaskId id); // Run the update once its interval allows
+    void Cancel(TaskId id); // Drop a pending request, e.g the state it reads is gone
+private:
+    struct Task {
+        std::function<void()> update;
+        Clock::duration interval;
+        Clock::time_point lastRun;
+        Clock::time_point due;
+        bool pending = false;
+    };
+
+    void OnTimer(wxTimerEvent& event);
+    void Arm(); // Start the timer for the earliest pending task, if sooner than it is set for
+
+    std::vector<Task> m_tasks;
+    wxTimer m_timer;
+    Clock::time_point m_armedFor;
+};
@@ -0,0 +1,83 @@
+// Backend
+#include "backend/blob_reader.hxx"
+
+// STD
+#include <algorithm>
+
+BlobReader::~BlobReader() {
+    this->Close();
+}
+
+bool BlobReader::Open(sqlite3* db, const std::string& table, const std::string& column, sqlite3_int64 rowId) {
+    this->Close();
+    if ( !db )
+        return false;
+
+    m_db = db;
+    m_table = table;
+    m_column = column;
+    m_rowId = rowId;
+
+    if ( !this->Acquire() ) {
+        this->Close();
+        return false;
+    }
+
+    return true;
+}
+
+void BlobReader::Close() {
+    this->Release();
+    m_db = nullptr;
+    m_table.clear();
+    m_column.clear();
+    m_rowId = 0;
+    m_size = 0;
+}
+
+void BlobReader::Release() {
+    if ( !m_blob )
+        return;
+
+    sqlite3_blob_close(m_blob);
+    m_blob = nullptr;
+}
+
+int BlobReader::Read(int offset, void* buffer, int length) {
+    if ( offset < 0 || length < 0 || !this->Acquire() )
+        return -1;
+
+    length = std::min(length, m_size - offset);
+    if ( length <= 0 )
+        return 0;
+
+    if ( sqlite3_blob_read(m_blob, buffer, length, offset) != SQLITE_OK ) {
+        // The row was changed or deleted since the handle was opened.
+        // The handle is now unusable, so drop it.
+        this->Release();
+        return -1;
+    }
+
+    return length;
+}
+
+bool BlobReader::Acquire() {
+    if ( m_blob )
+        return true;
+
+    if ( !m_db )
+        return false;
+
+    // flags = 0 opens the blob read-only
+    int res = sqlite3_blob_open(m_db, "main", m_table.c_str(), m_column.c_str(), m_rowId, 0, &m_blob);
+    if ( res != SQLITE_OK ) {
+        // sqlite3_blob_open may still set m_blob on failure
+        sqlite3_blob_close(m_blob);
+        m_blob = nullptr;
+        return false;
+    }
+
+    // The cell may have been rewritten while the handle was released
+    m_size = sqlite3_blob_bytes(m_blob);
+    return true;
+}
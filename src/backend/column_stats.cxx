@@ -0,0 +1,261 @@
+// Backend
+#include "backend/column_stats.hxx"
+
+// STD
+#include <algorithm>
+#include <bit>
+#include <cmath>
+#include <cstring>
+#include <string_view>
+
+namespace {
+    constexpr uint64_t HASH_MULTIPLIER = 0x9E3779B97F4A7C15ull;
+    constexpr size_t MAX_TRACKED_TEXT = 256; // Longer values are truncated before being counted
+
+    // splitmix64 finalizer. Spreads entropy over all 64 bits
+    uint64_t Mix(uint64_t x) {
+        x ^= x >> 30;
+        x *= 0xBF58476D1CE4E5B9ull;
+        x ^= x >> 27;
+        x *= 0x94D049BB133111EBull;
+        x ^= x >> 31;
+        return x;
+    }
+
+    // Hash a value together with its storage class so that
+    // e.g the integer 1 and the text '1' are counted as distinct.
+    uint64_t HashTagged(char tag, const void* data, size_t length) {
+        return HyperLogLog::Hash(data, length) ^ Mix(static_cast<uint64_t>(tag));
+    }
+}
+
+void HyperLogLog::Add(uint64_t hash) {
+    size_t index = hash >> ( 64 - PRECISION );
+    // Guard bit keeps the rank bounded when the remaining bits are all zero
+    uint64_t remaining = ( hash << PRECISION ) | ( uint64_t(1) << ( PRECISION - 1 ) );
+    uint8_t rank = static_cast<uint8_t>(std::countl_zero(remaining) + 1);
+
+    if ( rank > m_registers[index] )
+        m_registers[index] = rank;
+}
+
+double HyperLogLog::Estimate() const {
+    const double m = static_cast<double>(REGISTER_COUNT);
+    const double alpha = 0.7213 / ( 1.0 + 1.079 / m );
+
+    double sum = 0;
+    size_t zeros = 0;
+    for ( uint8_t reg : m_registers ) {
+        sum += std::ldexp(1.0, -reg);
+        if ( reg == 0 )
+            zeros++;
+    }
+
+    double estimate = alpha * m * m / sum;
+
+    // Small range correction, linear counting is far more
+    // accurate while many registers are still empty.
+    if ( estimate <= 2.5 * m && zeros > 0 )
+        estimate = m * std::log(m / static_cast<double>(zeros));
+
+    return estimate;
+}
+
+uint64_t HyperLogLog::Hash(const void* data, size_t length) {
+    const unsigned char* bytes = static_cast<const unsigned char*>(data);
+    uint64_t hash = Mix(length * HASH_MULTIPLIER);
+
+    while ( length >= 8 ) {
+        uint64_t chunk;
+        std::memcpy(&chunk, bytes, 8);
+        hash = ( hash ^ Mix(chunk) ) * HASH_MULTIPLIER;
+        bytes += 8;
+        length -= 8;
+    }
+
+    uint64_t tail = 0;
+    std::memcpy(&tail, bytes, length);
+    hash ^= Mix(tail);
+
+    return Mix(hash);
+}
+
+void SpaceSaving::Add(const std::string& value) {
+    auto it = m_counters.find(value);
+    if ( it != m_counters.end() ) {
+        it->second.count++;
+        return;
+    }
+
+    if ( m_counters.size() < m_capacity ) {
+        m_counters.emplace(value, Counter{ 1, 0 });
+        return;
+    }
+
+    // Evict the smallest counter. The newcomer inherits its
+    // count, which is the bound on how much we may overestimate.
+    auto smallest = std::min_element(m_counters.begin(), m_counters.end(),
+        [](const auto& a, const auto& b) { return a.second.count < b.second.count; });
+
+    Counter inherited{ smallest->second.count + 1, smallest->second.count };
+    m_counters.erase(smallest);
+    m_counters.emplace(value, inherited);
+}
+
+std::vector<SpaceSaving::Entry> SpaceSaving::Top(size_t k) const {
+    std::vector<Entry> entries;
+    entries.reserve(m_counters.size());
+    for ( const auto& [value, counter] : m_counters )
+        entries.push_back({ value, counter.count, counter.error });
+
+    std::sort(entries.begin(), entries.end(), [](const Entry& a, const Entry& b) {
+        return a.count > b.count;
+    });
+
+    if ( entries.size() > k )
+        entries.resize(k);
+
+    return entries;
+}
+
+ColumnStatsCollector::ColumnStatsCollector()
+    : m_topValues(TOP_K_CAPACITY), m_rng(std::random_device{}())
+{
+    m_reservoir.reserve(RESERVOIR_SIZE);
+}
+
+void ColumnStatsCollector::Add(sqlite3_value* value) {
+    m_stats.rowsScanned++;
+
+    switch ( sqlite3_value_type(value) ) {
+    case SQLITE_NULL:
+        m_stats.nullCount++;
+        return;
+    case SQLITE_INTEGER: {
+        sqlite3_int64 number = sqlite3_value_int64(value);
+        m_stats.integerCount++;
+        m_distinct.Add(HashTagged('n', &number, sizeof(number)));
+        m_topValues.Add(std::to_string(number));
+        AddNumeric(static_cast<double>(number));
+        return;
+    }
+    case SQLITE_FLOAT: {
+        double number = sqlite3_value_double(value);
+        m_stats.realCount++;
+
+        // SQLite compares 2.0 equal to 2, so hash integral reals as integers
+        if ( number == std::trunc(number) && std::abs(number) < 9.2e18 ) {
+            sqlite3_int64 integral = static_cast<sqlite3_int64>(number);
+            m_distinct.Add(HashTagged('n', &integral, sizeof(integral)));
+        } else {
+            m_distinct.Add(HashTagged('r', &number, sizeof(number)));
+        }
+
+        m_topValues.Add(std::to_string(number));
+        AddNumeric(number);
+        return;
+    }
+    case SQLITE_TEXT: {
+        const char* text = reinterpret_cast<const char*>(sqlite3_value_text(value));
+        size_t length = static_cast<size_t>(sqlite3_value_bytes(value));
+        std::string_view view(text ? text : "", text ? length : 0);
+
+        m_stats.textCount++;
+        m_distinct.Add(HashTagged('t', view.data(), view.size()));
+        m_topValues.Add(std::string(view.substr(0, MAX_TRACKED_TEXT)));
+
+        if ( !m_stats.textMin || view < *m_stats.textMin )
+            m_stats.textMin = std::string(view.substr(0, MAX_TRACKED_TEXT));
+        if ( !m_stats.textMax || view > *m_stats.textMax )
+            m_stats.textMax = std::string(view.substr(0, MAX_TRACKED_TEXT));
+        return;
+    }
+    case SQLITE_BLOB: {
+        const void* blob = sqlite3_value_blob(value);
+        size_t length = static_cast<size_t>(sqlite3_value_bytes(value));
+
+        m_stats.blobCount++;
+        m_distinct.Add(HashTagged('b', blob, blob ? length : 0));
+        return;
+    }
+    }
+}
+
+void ColumnStatsCollector::AddNumeric(double value) {
+    if ( !m_stats.numericMin || value < *m_stats.numericMin )
+        m_stats.numericMin = value;
+    if ( !m_stats.numericMax || value > *m_stats.numericMax )
+        m_stats.numericMax = value;
+
+    // ±Inf have no place in equal width buckets, the histogram only covers finite values
+    if ( !std::isfinite(value) )
+        return;
+
+    if ( !m_finiteMin || value < *m_finiteMin )
+        m_finiteMin = value;
+    if ( !m_finiteMax || value > *m_finiteMax )
+        m_finiteMax = value;
+
+    // Reservoir sampling (Algorithm R) keeps a uniform sample of
+    // every numeric value seen using constant memory.
+    m_numericSeen++;
+    if ( m_reservoir.size() < RESERVOIR_SIZE ) {
+        m_reservoir.push_back(value);
+        return;
+    }
+
+    std::uniform_int_distribution<uint64_t> pick(0, m_numericSeen - 1);
+    uint64_t slot = pick(m_rng);
+    if ( slot < RESERVOIR_SIZE )
+        m_reservoir[slot] = value;
+}
+
+void ColumnStatsCollector::Finish(ColumnStats& stats) const {
+    // Only copy what the scan gathered, identifying info
+    // and sampling details are filled in by the caller.
+    stats.rowsScanned = m_stats.rowsScanned;
+    stats.nullCount = m_stats.nullCount;
+    stats.integerCount = m_stats.integerCount;
+    stats.realCount = m_stats.realCount;
+    stats.textCount = m_stats.textCount;
+    stats.blobCount = m_stats.blobCount;
+    stats.numericMin = m_stats.numericMin;
+    stats.numericMax = m_stats.numericMax;
+    stats.textMin = m_stats.textMin;
+    stats.textMax = m_stats.textMax;
+
+    stats.distinctEstimate = std::min(m_distinct.Estimate(), static_cast<double>(m_stats.rowsScanned - m_stats.nullCount));
+    stats.topValues = m_topValues.Top(TOP_K_REPORTED);
+    stats.histogram.clear();
+
+    if ( m_reservoir.empty() )
+        return;
+
+    double low = *m_finiteMin;
+    double high = *m_finiteMax;
+    if ( low == high ) {
+        stats.histogram.push_back({ low, high, m_numericSeen });
+        return;
+    }
+
+    // The range of two huge finite values of opposite signs can still overflow
+    double width = ( high - low ) / HISTOGRAM_BUCKETS;
+    if ( !std::isfinite(width) )
+        return;
+
+    std::vector<uint64_t> counts(HISTOGRAM_BUCKETS, 0);
+    for ( double value : m_reservoir ) {
+        size_t bucket = static_cast<size_t>(( value - low ) / width);
+        counts[std::min(bucket, HISTOGRAM_BUCKETS - 1)]++;
+    }
+
+    // Scale reservoir counts back up to the number of numeric values seen
+    double scale = static_cast<double>(m_numericSeen) / m_reservoir.size();
+    for ( size_t i = 0; i < HISTOGRAM_BUCKETS; i++ ) {
+        stats.histogram.push_back({
+            low + width * i,
+            low + width * ( i + 1 ),
+            static_cast<uint64_t>(std::llround(counts[i] * scale))
+        });
+    }
+}
@@ -0,0 +1,944 @@
+// Backend
+#include "backend/columnar_export.hxx"
+
+// STD
+#include <cctype>
+#include <cstdint>
+#include <cstring>
+#include <memory>
+#include <ostream>
+#include <string>
+#include <string_view>
+#include <unordered_map>
+#include <vector>
+
+namespace {
+    constexpr size_t ARROW_BATCH_ROWS = 64 * 1024; // Rows per Arrow record batch
+    constexpr size_t PARQUET_BATCH_ROWS = 256 * 1024; // Rows per Parquet row group
+    constexpr size_t BATCH_MAX_BYTES = 64 << 20; // TEXT and BLOB bytes per batch, keeps utf8 offsets within int32
+    constexpr size_t DICTIONARY_MAX_BYTES = 1 << 20; // Larger dictionaries fall back to PLAIN, like parquet-cpp
+
+    enum class ColumnType { Int64, Double, Utf8, Binary };
+
+    /*
+        One column of a batch of rows, laid out the way both formats want it.
+        Null rows hold a 0 or an empty string so every vector has one entry per row.
+    */
+    struct Column {
+        std::string name;
+        ColumnType type = ColumnType::Utf8;
+        std::vector<uint8_t> valid; // 1 per non-null row
+        std::vector<int64_t> ints;
+        std::vector<double> reals;
+        std::vector<int32_t> offsets; // Utf8 and Binary: start of every row in 'bytes', plus the end
+        std::string bytes;
+        size_t nulls = 0;
+
+        void Clear() {
+            valid.clear();
+            ints.clear();
+            reals.clear();
+            offsets.assign(1, 0);
+            bytes.clear();
+            nulls = 0;
+        }
+
+        std::string_view Bytes(size_t row) const {
+            return std::string_view(bytes).substr(offsets[row], offsets[row + 1] - offsets[row]);
+        }
+    };
+
+    // Reads a result column of the current row
+    struct ColumnValue {
+        sqlite3_stmt* stmt;
+        int col;
+
+        int Type() const { return sqlite3_column_type(stmt, col); }
+        sqlite3_int64 Int64() const { return sqlite3_column_int64(stmt, col); }
+        double Double() const { return sqlite3_column_double(stmt, col); }
+        const void* Text() const { return sqlite3_column_text(stmt, col); }
+        const void* Blob() const { return sqlite3_column_blob(stmt, col); }
+        int Length() const { return sqlite3_column_bytes(stmt, col); }
+    };
+
+    // Reads a value kept from an earlier row
+    struct StoredValue {
+        sqlite3_value* value;
+
+        int Type() const { return sqlite3_value_type(value); }
+        sqlite3_int64 Int64() const { return sqlite3_value_int64(value); }
+        double Double() const { return sqlite3_value_double(value); }
+        const void* Text() const { return sqlite3_value_text(value); }
+        const void* Blob() const { return sqlite3_value_blob(value); }
+        int Length() const { return sqlite3_value_bytes(value); }
+    };
+
+    template <typename Value>
+    void Append(Column& column, const Value& value) {
+        bool isNull = value.Type() == SQLITE_NULL;
+        column.valid.push_back(!isNull);
+        column.nulls += isNull;
+
+        switch ( column.type ) {
+        case ColumnType::Int64:
+            column.ints.push_back(isNull ? 0 : value.Int64());
+            break;
+        case ColumnType::Double:
+            column.reals.push_back(isNull ? 0.0 : value.Double());
+            break;
+        case ColumnType::Utf8:
+        case ColumnType::Binary:
+            if ( !isNull ) {
+                // Text first, sqlite3_*_bytes is only meaningful after it
+                const void* data = column.type == ColumnType::Utf8 ? value.Text() : value.Blob();
+                int length = value.Length();
+                if ( length )
+                    column.bytes.append(static_cast<const char*>(data), length);
+            }
+            column.offsets.push_back(static_cast<int32_t>(column.bytes.size()));
+            break;
+        }
+    }
+
+    ColumnType TypeFromDeclaration(const char* declared) {
+        std::string type = declared ? declared : "";
+        for ( char& c : type )
+            c = static_cast<char>(std::toupper(static_cast<unsigned char>(c)));
+
+        // Column affinity rules, in the order SQLite applies them
+        if ( type.find("INT") != std::string::npos )
+            return ColumnType::Int64;
+        if ( type.find("CHAR") != std::string::npos || type.find("CLOB") != std::string::npos || type.find("TEXT") != std::string::npos )
+            return ColumnType::Utf8;
+        if ( type.find("BLOB") != std::string::npos )
+            return ColumnType::Binary;
+        if ( type.empty() )
+            return ColumnType::Utf8;
+        return ColumnType::Double;
+    }
+
+    /*
+        Steps a statement into batches of typed columns.
+        The first batch is kept as sqlite3_value copies until
+        it has been seen whole and the column types are known.
+    */
+    class BatchReader {
+    public:
+        BatchReader(sqlite3_stmt* stmt, size_t batchRows) : m_stmt(stmt), m_batchRows(batchRows)
+        {
+            int columnCount = sqlite3_column_count(stmt);
+            m_columns.resize(columnCount);
+            for ( int col = 0; col < columnCount; col++ )
+                m_columns[col].name = sqlite3_column_name(stmt, col);
+        }
+
+        // Read the first batch and settle the column types. False on error
+        bool Start() {
+            struct ValueDeleter {
+                void operator()(sqlite3_value* value) const { sqlite3_value_free(value); }
+            };
+
+            std::vector<std::unique_ptr<sqlite3_value, ValueDeleter>> sample;
+            std::vector<int> counts(m_columns.size() * 5); // Rows of each SQLITE_* type per column
+            size_t rows = 0;
+            size_t bytes = 0;
+
+            while ( rows < m_batchRows && bytes < BATCH_MAX_BYTES && Step() ) {
+                for ( size_t col = 0; col < m_columns.size(); col++ ) {
+                    sqlite3_value* value = sqlite3_value_dup(sqlite3_column_value(m_stmt, static_cast<int>(col)));
+                    if ( !value )
+                        return false;
+
+                    int type = sqlite3_value_type(value);
+                    counts[col * 5 + type - 1]++;
+                    if ( type == SQLITE_TEXT || type == SQLITE_BLOB )
+                        bytes += sqlite3_value_bytes(value);
+                    sample.emplace_back(value);
+                }
+                rows++;
+            }
+
+            if ( m_result != SQLITE_ROW && m_result != SQLITE_DONE )
+                return false;
+
+            for ( size_t col = 0; col < m_columns.size(); col++ ) {
+                const int* count = &counts[col * 5];
+                int integers = count[SQLITE_INTEGER - 1];
+                int reals = count[SQLITE_FLOAT - 1];
+                int texts = count[SQLITE_TEXT - 1];
+                int blobs = count[SQLITE_BLOB - 1];
+
+                Column& column = m_columns[col];
+                if ( integers + reals + texts + blobs == 0 )
+                    column.type = TypeFromDeclaration(sqlite3_column_decltype(m_stmt, static_cast<int>(col)));
+                else if ( texts + blobs == 0 )
+                    column.type = reals ? ColumnType::Double : ColumnType::Int64;
+                else if ( blobs )
+                    column.type = ColumnType::Binary; // utf8 must be valid UTF-8, BLOBs needn't be
+                else
+                    column.type = ColumnType::Utf8;
+
+                column.Clear();
+            }
+
+            for ( size_t i = 0; i < sample.size(); i++ )
+                Append(m_columns[i % m_columns.size()], StoredValue{ sample[i].get() });
+
+            m_rows = rows;
+            return true;
+        }
+
+        // Read the next batch into Columns(), after the first which Start read. False once there are no more rows
+        bool Next() {
+            if ( m_first ) {
+                m_first = false;
+                return m_rows > 0;
+            }
+
+            for ( Column& column : m_columns )
+                column.Clear();
+            m_rows = 0;
+
+            size_t bytes = 0;
+            while ( m_rows < m_batchRows && bytes < BATCH_MAX_BYTES && Step() ) {
+                for ( size_t col = 0; col < m_columns.size(); col++ ) {
+                    Append(m_columns[col], ColumnValue{ m_stmt, static_cast<int>(col) });
+                    bytes += m_columns[col].type >= ColumnType::Utf8 ? sqlite3_column_bytes(m_stmt, static_cast<int>(col)) : 0;
+                }
+                m_rows++;
+            }
+
+            return m_rows > 0;
+        }
+
+        bool Failed() const { return m_result != SQLITE_ROW && m_result != SQLITE_DONE; }
+        const std::vector<Column>& Columns() const { return m_columns; }
+        size_t Rows() const { return m_rows; }
+    private:
+        bool Step() {
+            if ( m_result != SQLITE_ROW )
+                return false;
+            m_result = sqlite3_step(m_stmt);
+            return m_result == SQLITE_ROW;
+        }
+
+        sqlite3_stmt* m_stmt;
+        size_t m_batchRows;
+        std::vector<Column> m_columns;
+        size_t m_rows = 0;
+        int m_result = SQLITE_ROW; // Last sqlite3_step result
+        bool m_first = true; // Next returns the batch Start read
+    };
+
+    template <typename T>
+    void Put(std::string& out, T value) {
+        out.append(reinterpret_cast<const char*>(&value), sizeof(value)); // Both formats are little endian
+    }
+
+    void Pad(std::string& out, size_t alignment) {
+        out.append(( alignment - out.size() % alignment ) % alignment, '\0');
+    }
+
+    /*
+        Minimal FlatBuffers encoder for the handful of Arrow IPC tables.
+
+        Objects are described as a tree of nodes and serialized front to back,
+        each table's vtable right before it and its children after it, since
+        offsets to children must point forward.
+    */
+    struct FlatNode {
+        enum class Kind { Table, String, TableVector, StructVector };
+
+        struct Slot {
+            int size = 0; // 0 when the field is absent
+            uint64_t scalar = 0;
+            std::unique_ptr<FlatNode> child; // Set for offset fields
+        };
+
+        Kind kind = Kind::Table;
+        std::vector<Slot> slots; // Table, indexed by field id
+        std::string data; // String bytes or struct vector elements
+        size_t count = 0; // Struct vector elements
+        std::vector<FlatNode> children; // Table vector
+
+        FlatNode& Scalar(size_t id, int size, uint64_t value) {
+            SlotAt(id) = { size, value, nullptr };
+            return *this;
+        }
+
+        FlatNode& Child(size_t id, FlatNode node) {
+            Slot& slot = SlotAt(id);
+            slot.size = 4;
+            slot.child = std::make_unique<FlatNode>(std::move(node));
+            return *this;
+        }
+
+        static FlatNode String(const std::string& text) {
+            FlatNode node;
+            node.kind = Kind::String;
+            node.data = text;
+            return node;
+        }
+
+        static FlatNode Tables(std::vector<FlatNode> tables) {
+            FlatNode node;
+            node.kind = Kind::TableVector;
+            node.children = std::move(tables);
+            return node;
+        }
+
+        // Vector of 16 byte structs of two int64, Arrow's FieldNode and Buffer
+        static FlatNode Pairs(const std::vector<std::pair<int64_t, int64_t>>& pairs) {
+            FlatNode node;
+            node.kind = Kind::StructVector;
+            node.count = pairs.size();
+            for ( const auto& [first, second] : pairs ) {
+                Put(node.data, first);
+                Put(node.data, second);
+            }
+            return node;
+        }
+    private:
+        Slot& SlotAt(size_t id) {
+            if ( slots.size() <= id )
+                slots.resize(id + 1);
+            return slots[id];
+        }
+    };
+
+    void PatchOffset(std::string& buffer, size_t reference, size_t target) {
+        uint32_t offset = static_cast<uint32_t>(target - reference);
+        std::memcpy(&buffer[reference], &offset, sizeof(offset));
+    }
+
+    // Appends 'node' to 'buffer' and points the uoffset at 'reference' to it
+    void Serialize(std::string& buffer, const FlatNode& node, size_t reference) {
+        switch ( node.kind ) {
+        case FlatNode::Kind::String:
+            Pad(buffer, 4);
+            PatchOffset(buffer, reference, buffer.size());
+            Put(buffer, static_cast<uint32_t>(node.data.size()));
+            buffer += node.data;
+            buffer += '\0';
+            return;
+        case FlatNode::Kind::StructVector:
+            while ( ( buffer.size() + 4 ) % 8 ) // elements are 8 byte aligned
+                buffer += '\0';
+            PatchOffset(buffer, reference, buffer.size());
+            Put(buffer, static_cast<uint32_t>(node.count));
+            buffer += node.data;
+            return;
+        case FlatNode::Kind::TableVector: {
+            Pad(buffer, 4);
+            size_t start = buffer.size();
+            PatchOffset(buffer, reference, start);
+            Put(buffer, static_cast<uint32_t>(node.children.size()));
+            buffer.append(node.children.size() * 4, '\0');
+            for ( size_t i = 0; i < node.children.size(); i++ )
+                Serialize(buffer, node.children[i], start + 4 + i * 4);
+            return;
+        }
+        case FlatNode::Kind::Table:
+            break;
+        }
+
+        // vtable, then the table 8 byte aligned so fields can be aligned to their size
+        Pad(buffer, 2);
+        size_t vtable = buffer.size();
+        size_t table = ( vtable + 4 + 2 * node.slots.size() + 7 ) / 8 * 8;
+
+        std::vector<uint16_t> fieldOffsets(node.slots.size(), 0);
+        size_t size = 4; // soffset to the vtable
+        for ( size_t id = 0; id < node.slots.size(); id++ ) {
+            int fieldSize = node.slots[id].size;
+            if ( !fieldSize )
+                continue;
+            size = ( size + fieldSize - 1 ) / fieldSize * fieldSize;
+            fieldOffsets[id] = static_cast<uint16_t>(size);
+            size += fieldSize;
+        }
+
+        Put(buffer, static_cast<uint16_t>(4 + 2 * node.slots.size()));
+        Put(buffer, static_cast<uint16_t>(size));
+        for ( uint16_t offset : fieldOffsets )
+            Put(buffer, offset);
+        buffer.resize(table + size, '\0');
+
+        int32_t toVtable = static_cast<int32_t>(table - vtable);
+        std::memcpy(&buffer[table], &toVtable, sizeof(toVtable));
+        PatchOffset(buffer, reference, table);
+
+        for ( size_t id = 0; id < node.slots.size(); id++ ) {
+            const FlatNode::Slot& slot = node.slots[id];
+            if ( slot.size && !slot.child )
+                std::memcpy(&buffer[table + fieldOffsets[id]], &slot.scalar, slot.size);
+        }
+
+        for ( size_t id = 0; id < node.slots.size(); id++ ) {
+            if ( node.slots[id].child )
+                Serialize(buffer, *node.slots[id].child, table + fieldOffsets[id]);
+        }
+    }
+
+    /*
+        Arrow IPC streaming format: a Schema message, one RecordBatch
+        message per batch, then the end of stream marker.
+    */
+    namespace arrow {
+        constexpr int16_t METADATA_V5 = 4;
+        constexpr uint8_t HEADER_SCHEMA = 1;
+        constexpr uint8_t HEADER_RECORD_BATCH = 3;
+        constexpr uint8_t TYPE_INT = 2;
+        constexpr uint8_t TYPE_FLOATING_POINT = 3;
+        constexpr uint8_t TYPE_BINARY = 4;
+        constexpr uint8_t TYPE_UTF8 = 5;
+        constexpr int16_t PRECISION_DOUBLE = 2;
+        constexpr uint32_t CONTINUATION = 0xFFFFFFFF;
+
+        FlatNode FieldType(ColumnType type, uint8_t& typeId) {
+            FlatNode node;
+            switch ( type ) {
+            case ColumnType::Int64:
+                typeId = TYPE_INT;
+                node.Scalar(0, 4, 64).Scalar(1, 1, 1); // bitWidth, is_signed
+                break;
+            case ColumnType::Double:
+                typeId = TYPE_FLOATING_POINT;
+                node.Scalar(0, 2, PRECISION_DOUBLE);
+                break;
+            case ColumnType::Utf8:
+                typeId = TYPE_UTF8;
+                break;
+            case ColumnType::Binary:
+                typeId = TYPE_BINARY;
+                break;
+            }
+            return node;
+        }
+
+        // Writes a message: continuation marker, metadata length, the padded flatbuffer and the body
+        bool WriteMessage(std::ostream& out, uint8_t headerType, FlatNode header, const std::string& body) {
+            FlatNode message;
+            message.Scalar(0, 2, METADATA_V5)
+                .Scalar(1, 1, headerType)
+                .Child(2, std::move(header))
+                .Scalar(3, 8, body.size());
+
+            std::string metadata(4, '\0');
+            Serialize(metadata, message, 0);
+            Pad(metadata, 8);
+
+            std::string prefix;
+            Put(prefix, CONTINUATION);
+            Put(prefix, static_cast<int32_t>(metadata.size()));
+
+            out.write(prefix.data(), prefix.size());
+            out.write(metadata.data(), metadata.size());
+            out.write(body.data(), body.size());
+            return out.good();
+        }
+
+        bool WriteSchema(std::ostream& out, const std::vector<Column>& columns) {
+            std::vector<FlatNode> fields;
+            for ( const Column& column : columns ) {
+                uint8_t typeId = 0;
+                FlatNode type = FieldType(column.type, typeId);
+
+                FlatNode field;
+                field.Child(0, FlatNode::String(column.name))
+                    .Scalar(1, 1, 1) // nullable
+                    .Scalar(2, 1, typeId)
+                    .Child(3, std::move(type))
+                    .Child(5, FlatNode::Tables({})); // children, required by readers even when empty
+                fields.push_back(std::move(field));
+            }
+
+            FlatNode schema;
+            schema.Scalar(0, 2, 0) // little endian
+                .Child(1, FlatNode::Tables(std::move(fields)));
+
+            return WriteMessage(out, HEADER_SCHEMA, std::move(schema), {});
+        }
+
+        bool WriteRecordBatch(std::ostream& out, const std::vector<Column>& columns, size_t rows) {
+            std::string body;
+            std::vector<std::pair<int64_t, int64_t>> nodes; // (length, null count) per column
+            std::vector<std::pair<int64_t, int64_t>> buffers; // (offset, length) in the body
+
+            auto addBuffer = [&](const void* data, size_t length) {
+                buffers.emplace_back(body.size(), length);
+                if ( length )
+                    body.append(static_cast<const char*>(data), length);
+                Pad(body, 8);
+            };
+
+            for ( const Column& column : columns ) {
+                nodes.emplace_back(rows, column.nulls);
+
+                // Validity bitmap, left out when there are no nulls
+                if ( column.nulls ) {
+                    std::string bitmap(( rows + 7 ) / 8, '\0');
+                    for ( size_t row = 0; row < rows; row++ ) {
+                        if ( column.valid[row] )
+                            bitmap[row / 8] |= static_cast<char>(1 << ( row % 8 ));
+                    }
+                    addBuffer(bitmap.data(), bitmap.size());
+                } else {
+                    addBuffer(nullptr, 0);
+                }
+
+                switch ( column.type ) {
+                case ColumnType::Int64:
+                    addBuffer(column.ints.data(), rows * sizeof(int64_t));
+                    break;
+                case ColumnType::Double:
+                    addBuffer(column.reals.data(), rows * sizeof(double));
+                    break;
+                case ColumnType::Utf8:
+                case ColumnType::Binary:
+                    addBuffer(column.offsets.data(), ( rows + 1 ) * sizeof(int32_t));
+                    addBuffer(column.bytes.data(), column.bytes.size());
+                    break;
+                }
+            }
+
+            FlatNode batch;
+            batch.Scalar(0, 8, rows)
+                .Child(1, FlatNode::Pairs(nodes))
+                .Child(2, FlatNode::Pairs(buffers));
+
+            return WriteMessage(out, HEADER_RECORD_BATCH, std::move(batch), body);
+        }
+    }
+
+    /*
+        Thrift compact protocol, as used by Parquet's metadata.
+        Structs are written field by field in increasing field id order.
+    */
+    class ThriftWriter {
+    public:
+        enum : uint8_t { I32 = 5, I64 = 6, BINARY = 8, LIST = 9, STRUCT = 12 };
+
+        explicit ThriftWriter(std::string& out) : m_out(out)
+        {
+            m_lastIds.push_back(0);
+        }
+
+        void I32Field(int16_t id, int32_t value) {
+            FieldHeader(id, I32);
+            Varint(ZigZag(value));
+        }
+
+        void I64Field(int16_t id, int64_t value) {
+            FieldHeader(id, I64);
+            Varint(ZigZag(value));
+        }
+
+        void BinaryField(int16_t id, std::string_view value) {
+            FieldHeader(id, BINARY);
+            BinaryElement(value);
+        }
+
+        void BeginStructField(int16_t id) {
+            FieldHeader(id, STRUCT);
+            BeginStruct();
+        }
+
+        void BeginListField(int16_t id, uint8_t elementType, size_t size) {
+            FieldHeader(id, LIST);
+            if ( size < 15 )
+                m_out += static_cast<char>(size << 4 | elementType);
+            else {
+                m_out += static_cast<char>(0xF0 | elementType);
+                Varint(size);
+            }
+        }
+
+        // List elements
+        void BeginStruct() { m_lastIds.push_back(0); }
+        void I32Element(int32_t value) { Varint(ZigZag(value)); }
+        void BinaryElement(std::string_view value) {
+            Varint(value.size());
+            m_out += value;
+        }
+
+        void EndStruct() {
+            m_out += '\0';
+            m_lastIds.pop_back();
+        }
+    private:
+        static uint64_t ZigZag(int64_t value) { return ( static_cast<uint64_t>(value) << 1 ) ^ static_cast<uint64_t>(value >> 63); }
+
+        void Varint(uint64_t value) {
+            while ( value >= 0x80 ) {
+                m_out += static_cast<char>(value | 0x80);
+                value >>= 7;
+            }
+            m_out += static_cast<char>(value);
+        }
+
+        void FieldHeader(int16_t id, uint8_t type) {
+            int delta = id - m_lastIds.back();
+            if ( delta > 0 && delta <= 15 )
+                m_out += static_cast<char>(delta << 4 | type);
+            else {
+                m_out += static_cast<char>(type);
+                Varint(ZigZag(id));
+            }
+            m_lastIds.back() = id;
+        }
+
+        std::string& m_out;
+        std::vector<int16_t> m_lastIds; // Last field id written, per struct being written
+    };
+
+    namespace parquet {
+        enum PhysicalType : int32_t { INT64 = 2, DOUBLE = 5, BYTE_ARRAY = 6 };
+        enum Encoding : int32_t { PLAIN = 0, RLE = 3, RLE_DICTIONARY = 8 };
+        enum PageType : int32_t { DATA_PAGE = 0, DICTIONARY_PAGE = 2 };
+        constexpr int32_t REPETITION_OPTIONAL = 1;
+        constexpr int32_t CONVERTED_UTF8 = 0;
+        constexpr int32_t CODEC_UNCOMPRESSED = 0;
+        constexpr char MAGIC[] = "PAR1";
+
+        PhysicalType TypeOf(ColumnType type) {
+            switch ( type ) {
+            case ColumnType::Int64: return INT64;
+            case ColumnType::Double: return DOUBLE;
+            default: return BYTE_ARRAY;
+            }
+        }
+
+        void PutVarint(std::string& out, uint64_t value) {
+            while ( value >= 0x80 ) {
+                out += static_cast<char>(value | 0x80);
+                value >>= 7;
+            }
+            out += static_cast<char>(value);
+        }
+
+        /*
+            RLE / bit-packing hybrid. Runs of 8 or more equal values are
+            written as RLE runs, everything in between bit-packed in groups
+            of 8. The last group is padded, readers stop at the value count.
+        */
+        void PutHybrid(std::string& out, const std::vector<uint32_t>& values, int bitWidth) {
+            size_t valueBytes = ( bitWidth + 7 ) / 8;
+
+            auto putPacked = [&](size_t begin, size_t end) {
+                size_t groups = ( end - begin + 7 ) / 8;
+                PutVarint(out, groups << 1 | 1);
+
+                uint64_t bits = 0;
+                int bitCount = 0;
+                for ( size_t i = begin; i < begin + groups * 8; i++ ) {
+                    bits |= static_cast<uint64_t>(i < end ? values[i] : 0) << bitCount;
+                    bitCount += bitWidth;
+                    while ( bitCount >= 8 ) {
+                        out += static_cast<char>(bits);
+                        bits >>= 8;
+                        bitCount -= 8;
+                    }
+                }
+            };
+
+            size_t literalStart = 0;
+            size_t i = 0;
+            while ( i < values.size() ) {
+                size_t run = 1;
+                while ( i + run < values.size() && values[i + run] == values[i] )
+                    run++;
+
+                if ( run < 8 ) {
+                    i += run;
+                    continue;
+                }
+
+                // Literals must come in groups of 8, borrow the start of the run to fill the last group
+                size_t borrowed = ( 8 - ( i - literalStart ) % 8 ) % 8;
+                if ( i > literalStart )
+                    putPacked(literalStart, i + borrowed);
+
+                size_t rleCount = run - borrowed;
+                if ( rleCount ) {
+                    PutVarint(out, rleCount << 1);
+                    uint32_t value = values[i];
+                    out.append(reinterpret_cast<const char*>(&value), valueBytes);
+                }
+
+                i += run;
+                literalStart = i;
+            }
+
+            if ( literalStart < values.size() )
+                putPacked(literalStart, values.size());
+        }
+
+        int BitWidth(size_t maxValue) {
+            int width = 1; // 0 is valid but not understood by every reader
+            while ( width < 32 && ( maxValue >> width ) != 0 )
+                width++;
+            return width;
+        }
+
+        void PutPlain(std::string& out, const Column& column, size_t row) {
+            switch ( column.type ) {
+            case ColumnType::Int64:
+                Put(out, column.ints[row]);
+                break;
+            case ColumnType::Double:
+                Put(out, column.reals[row]);
+                break;
+            default: {
+                std::string_view bytes = column.Bytes(row);
+                Put(out, static_cast<uint32_t>(bytes.size()));
+                out += bytes;
+                break;
+            }
+            }
+        }
+
+        /*
+            Builds the dictionary of a column chunk. 'indices' gets the
+            dictionary index of every non-null row, 'dictionary' the PLAIN
+            encoded distinct values. False if dictionary encoding wouldn't
+            pay off, in which case the chunk is written PLAIN.
+        */
+        bool BuildDictionary(const Column& column, size_t rows, std::vector<uint32_t>& indices, std::string& dictionary, size_t& entries) {
+            size_t nonNull = rows - column.nulls;
+            std::unordered_map<std::string_view, uint32_t> map;
+            map.reserve(nonNull / 4);
+
+            for ( size_t row = 0; row < rows; row++ ) {
+                if ( !column.valid[row] )
+                    continue;
+
+                std::string_view key;
+                switch ( column.type ) {
+                case ColumnType::Int64:
+                    key = std::string_view(reinterpret_cast<const char*>(&column.ints[row]), sizeof(int64_t));
+                    break;
+                case ColumnType::Double:
+                    key = std::string_view(reinterpret_cast<const char*>(&column.reals[row]), sizeof(double));
+                    break;
+                default:
+                    key = column.Bytes(row);
+                    break;
+                }
+
+                auto [entry, added] = map.emplace(key, static_cast<uint32_t>(map.size()));
+                if ( added ) {
+                    PutPlain(dictionary, column, row);
+                    if ( map.size() > nonNull / 2 || dictionary.size() > DICTIONARY_MAX_BYTES )
+                        return false;
+                }
+                indices.push_back(entry->second);
+            }
+
+            entries = map.size();
+            return entries > 0;
+        }
+
+        struct ChunkMeta {
+            PhysicalType type;
+            bool dictionary;
+            int64_t dictionaryOffset;
+            int64_t dataOffset;
+            int64_t size;
+        };
+
+        void PutPageHeader(std::string& out, PageType type, size_t size, size_t values, Encoding encoding) {
+            ThriftWriter thrift(out);
+            thrift.I32Field(1, type);
+            thrift.I32Field(2, static_cast<int32_t>(size));
+            thrift.I32Field(3, static_cast<int32_t>(size));
+            if ( type == DATA_PAGE ) {
+                thrift.BeginStructField(5);
+                thrift.I32Field(1, static_cast<int32_t>(values));
+                thrift.I32Field(2, encoding);
+                thrift.I32Field(3, RLE); // definition levels
+                thrift.I32Field(4, RLE); // repetition levels, none for flat columns
+                thrift.EndStruct();
+            } else {
+                thrift.BeginStructField(7);
+                thrift.I32Field(1, static_cast<int32_t>(values));
+                thrift.I32Field(2, PLAIN);
+                thrift.EndStruct();
+            }
+            out += '\0';
+        }
+
+        // Writes one column chunk, an optional dictionary page and a single data page, starting at 'offset'
+        bool WriteChunk(std::ostream& out, const Column& column, size_t rows, int64_t offset, ChunkMeta& meta) {
+            meta.type = TypeOf(column.type);
+            meta.dictionaryOffset = offset;
+
+            std::vector<uint32_t> indices;
+            std::string dictionary;
+            size_t entries = 0;
+            meta.dictionary = BuildDictionary(column, rows, indices, dictionary, entries);
+
+            std::string chunk;
+            if ( meta.dictionary ) {
+                PutPageHeader(chunk, DICTIONARY_PAGE, dictionary.size(), entries, PLAIN);
+                chunk += dictionary;
+                dictionary = std::string();
+            }
+            meta.dataOffset = offset + static_cast<int64_t>(chunk.size());
+
+            // Definition levels: 1 for a value, 0 for NULL, prefixed with their length
+            std::string page;
+            std::vector<uint32_t> levels(column.valid.begin(), column.valid.end());
+            std::string encodedLevels;
+            PutHybrid(encodedLevels, levels, 1);
+            Put(page, static_cast<uint32_t>(encodedLevels.size()));
+            page += encodedLevels;
+
+            if ( meta.dictionary ) {
+                int bitWidth = BitWidth(entries - 1);
+                page += static_cast<char>(bitWidth);
+                PutHybrid(page, indices, bitWidth);
+            } else {
+                for ( size_t row = 0; row < rows; row++ ) {
+                    if ( column.valid[row] )
+                        PutPlain(page, column, row);
+                }
+            }
+
+            PutPageHeader(chunk, DATA_PAGE, page.size(), rows, meta.dictionary ? RLE_DICTIONARY : PLAIN);
+            meta.size = static_cast<int64_t>(chunk.size() + page.size());
+
+            out.write(chunk.data(), chunk.size());
+            out.write(page.data(), page.size());
+            return out.good();
+        }
+
+        struct RowGroupMeta {
+            std::vector<ChunkMeta> chunks;
+            int64_t rows;
+            int64_t size;
+        };
+
+        void PutFooter(std::string& out, const std::vector<Column>& columns, const std::vector<RowGroupMeta>& rowGroups, int64_t rows) {
+            ThriftWriter thrift(out);
+            thrift.I32Field(1, 1); // version
+
+            // Schema, flattened: the root, then one leaf per column
+            thrift.BeginListField(2, ThriftWriter::STRUCT, columns.size() + 1);
+            thrift.BeginStruct();
+            thrift.BinaryField(4, "schema");
+            thrift.I32Field(5, static_cast<int32_t>(columns.size()));
+            thrift.EndStruct();
+            for ( const Column& column : columns ) {
+                thrift.BeginStruct();
+                thrift.I32Field(1, TypeOf(column.type));
+                thrift.I32Field(3, REPETITION_OPTIONAL);
+                thrift.BinaryField(4, column.name);
+                if ( column.type == ColumnType::Utf8 ) {
+                    thrift.I32Field(6, CONVERTED_UTF8);
+                    thrift.BeginStructField(10); // LogicalType
+                    thrift.BeginStructField(1); // STRING
+                    thrift.EndStruct();
+                    thrift.EndStruct();
+                }
+                thrift.EndStruct();
+            }
+
+            thrift.I64Field(3, rows);
+
+            thrift.BeginListField(4, ThriftWriter::STRUCT, rowGroups.size());
+            for ( const RowGroupMeta& group : rowGroups ) {
+                thrift.BeginStruct();
+                thrift.BeginListField(1, ThriftWriter::STRUCT, group.chunks.size());
+                for ( size_t col = 0; col < group.chunks.size(); col++ ) {
+                    const ChunkMeta& chunk = group.chunks[col];
+                    thrift.BeginStruct();
+                    thrift.I64Field(2, chunk.dictionaryOffset); // file_offset
+                    thrift.BeginStructField(3);
+                    thrift.I32Field(1, chunk.type);
+                    thrift.BeginListField(2, ThriftWriter::I32, chunk.dictionary ? 3 : 2);
+                    thrift.I32Element(chunk.dictionary ? RLE_DICTIONARY : PLAIN);
+                    thrift.I32Element(RLE);
+                    if ( chunk.dictionary )
+                        thrift.I32Element(PLAIN);
+                    thrift.BeginListField(3, ThriftWriter::BINARY, 1);
+                    thrift.BinaryElement(columns[col].name);
+                    thrift.I32Field(4, CODEC_UNCOMPRESSED);
+                    thrift.I64Field(5, group.rows);
+                    thrift.I64Field(6, chunk.size);
+                    thrift.I64Field(7, chunk.size);
+                    thrift.I64Field(9, chunk.dataOffset);
+                    if ( chunk.dictionary )
+                        thrift.I64Field(11, chunk.dictionaryOffset);
+                    thrift.EndStruct();
+                    thrift.EndStruct();
+                }
+                thrift.I64Field(2, group.size);
+                thrift.I64Field(3, group.rows);
+                thrift.EndStruct();
+            }
+
+            thrift.BinaryField(6, "SQLight");
+            out += '\0';
+        }
+    }
+}
+
+bool WriteArrowStream(sqlite3_stmt* stmt, std::ostream& out) {
+    BatchReader reader(stmt, ARROW_BATCH_ROWS);
+    if ( !reader.Start() || !arrow::WriteSchema(out, reader.Columns()) )
+        return false;
+
+    while ( reader.Next() ) {
+        if ( !arrow::WriteRecordBatch(out, reader.Columns(), reader.Rows()) )
+            return false;
+    }
+
+    // End of stream
+    std::string end;
+    Put(end, arrow::CONTINUATION);
+    Put(end, int32_t(0));
+    out.write(end.data(), end.size());
+    out.flush();
+    return !reader.Failed() && out.good();
+}
+
+bool WriteParquet(sqlite3_stmt* stmt, std::ostream& out) {
+    BatchReader reader(stmt, PARQUET_BATCH_ROWS);
+    if ( !reader.Start() )
+        return false;
+
+    out.write(parquet::MAGIC, 4);
+    int64_t offset = 4;
+    int64_t rows = 0;
+    std::vector<parquet::RowGroupMeta> rowGroups;
+
+    while ( reader.Next() ) {
+        parquet::RowGroupMeta group;
+        group.rows = static_cast<int64_t>(reader.Rows());
+        group.size = 0;
+
+        for ( const Column& column : reader.Columns() ) {
+            parquet::ChunkMeta chunk;
+            if ( !parquet::WriteChunk(out, column, reader.Rows(), offset, chunk) )
+                return false;
+            offset += chunk.size;
+            group.size += chunk.size;
+            group.chunks.push_back(chunk);
+        }
+
+        rows += group.rows;
+        rowGroups.push_back(std::move(group));
+    }
+
+    if ( reader.Failed() )
+        return false;
+
+    std::string footer;
+    parquet::PutFooter(footer, reader.Columns(), rowGroups, rows);
+    Put(footer, static_cast<uint32_t>(footer.size()));
+    footer.append(parquet::MAGIC, 4);
+    out.write(footer.data(), footer.size());
+    out.flush();
+    return out.good();
+}
@@ -0,0 +1,428 @@
+// Backend
+#include "backend/compressed_vfs.hxx"
+#include "backend/read_ahead_vfs.hxx"
+#include "backend/shim_vfs.hxx"
+
+// zlib
+#include <zlib.h>
+
+// STD
+#include <algorithm>
+#include <atomic>
+#include <chrono>
+#include <cstring>
+#include <filesystem>
+#include <fstream>
+#include <thread>
+#include <vector>
+
+namespace {
+    constexpr const char* VFS_NAME = "sqlight-zip";
+    constexpr char MAGIC[8] = { 'S', 'Q', 'L', 'i', 'g', 'h', 't', 'Z' };
+    constexpr uint32_t FORMAT_VERSION = 1;
+    constexpr size_t HEADER_SIZE = 64;
+    constexpr size_t INDEX_ENTRY_SIZE = 12; // 8 byte offset, 4 byte compressed size
+
+    // 16 pages of the default size. Smaller chunks waste less inflating
+    // single page reads, larger ones compress better.
+    constexpr uint32_t CHUNK_SIZE = 64 * 1024;
+    constexpr uint32_t MAX_CHUNK_SIZE = 16 * 1024 * 1024; // Sanity limit when reading headers
+    constexpr int COMPRESSION_LEVEL = 6; // 9 takes four times as long for half a percent smaller archives
+    constexpr size_t CACHE_CHUNKS = 32; // Inflated chunks kept per open file, 2 MiB
+    constexpr size_t CHUNKS_PER_THREAD = 16; // Chunks read and compressed per worker per round
+
+    void PutLittleEndian(char* out, uint64_t value, int bytes) {
+        for ( int i = 0; i < bytes; i++ )
+            out[i] = static_cast<char>(value >> ( 8 * i ));
+    }
+
+    uint64_t GetLittleEndian(const char* in, int bytes) {
+        uint64_t value = 0;
+        for ( int i = 0; i < bytes; i++ )
+            value |= uint64_t(static_cast<unsigned char>(in[i])) << ( 8 * i );
+        return value;
+    }
+
+    struct ChunkLocation {
+        uint64_t offset;
+        uint32_t compressedSize; // Equal to the chunk's length when stored raw
+    };
+
+    struct CachedChunk {
+        uint64_t chunk;
+        uint64_t lastUse;
+        std::string data;
+    };
+
+    struct Archive {
+        uint32_t chunkSize = 0;
+        uint64_t size = 0; // Of the data base
+        std::vector<ChunkLocation> index;
+        std::vector<CachedChunk> cache;
+        uint64_t useClock = 0;
+        std::string compressed; // Read buffer, reused
+
+        uint32_t ChunkLength(uint64_t chunk) const {
+            return static_cast<uint32_t>(std::min<uint64_t>(chunkSize, size - chunk * chunkSize));
+        }
+    };
+
+    sqlite3_file* Real(sqlite3_file* file) {
+        return ShimRealFile(file);
+    }
+
+    Archive& GetArchive(sqlite3_file* file) {
+        return *ShimState<Archive>(file);
+    }
+
+    bool ReadReal(sqlite3_file* file, void* buffer, size_t amount, uint64_t offset) {
+        return Real(file)->pMethods->xRead(Real(file), buffer, static_cast<int>(amount), static_cast<sqlite3_int64>(offset)) == SQLITE_OK;
+    }
+
+    bool ReadIndex(sqlite3_file* file, Archive& archive) {
+        char header[HEADER_SIZE];
+        sqlite3_int64 fileSize = 0;
+        if ( !ReadReal(file, header, sizeof(header), 0) || Real(file)->pMethods->xFileSize(Real(file), &fileSize) != SQLITE_OK )
+            return false;
+
+        if ( std::memcmp(header, MAGIC, sizeof(MAGIC)) != 0 || GetLittleEndian(header + 8, 4) != FORMAT_VERSION )
+            return false;
+
+        archive.chunkSize = static_cast<uint32_t>(GetLittleEndian(header + 12, 4));
+        archive.size = GetLittleEndian(header + 16, 8);
+        uint64_t indexOffset = GetLittleEndian(header + 24, 8);
+        uint64_t chunkCount = GetLittleEndian(header + 32, 4);
+
+        if ( archive.chunkSize == 0 || archive.chunkSize > MAX_CHUNK_SIZE )
+            return false;
+        if ( chunkCount != ( archive.size + archive.chunkSize - 1 ) / archive.chunkSize )
+            return false;
+        if ( indexOffset < HEADER_SIZE || indexOffset + chunkCount * INDEX_ENTRY_SIZE > static_cast<uint64_t>(fileSize) )
+            return false;
+
+        std::string entries(chunkCount * INDEX_ENTRY_SIZE, '\0');
+        if ( chunkCount > 0 && !ReadReal(file, entries.data(), entries.size(), indexOffset) )
+            return false;
+
+        archive.index.resize(chunkCount);
+        for ( uint64_t i = 0; i < chunkCount; i++ ) {
+            ChunkLocation& location = archive.index[i];
+            location.offset = GetLittleEndian(entries.data() + i * INDEX_ENTRY_SIZE, 8);
+            location.compressedSize = static_cast<uint32_t>(GetLittleEndian(entries.data() + i * INDEX_ENTRY_SIZE + 8, 4));
+            if ( location.offset < HEADER_SIZE || location.offset + location.compressedSize > indexOffset )
+                return false;
+        }
+
+        return true;
+    }
+
+    /**
+     * @brief Returns chunk 'chunk' inflated, from the cache or read and inflated now.
+     *
+     * @return nullptr if the chunk could not be read or is corrupt.
+     */
+    const std::string* LoadChunk(sqlite3_file* file, uint64_t chunk) {
+        Archive& archive = GetArchive(file);
+        archive.useClock++;
+
+        for ( CachedChunk& cached : archive.cache ) {
+            if ( cached.chunk == chunk ) {
+                cached.lastUse = archive.useClock;
+                return &cached.data;
+            }
+        }
+
+        // Evict the least recently used chunk once the cache is full
+        CachedChunk* slot;
+        if ( archive.cache.size() < CACHE_CHUNKS ) {
+            slot = &archive.cache.emplace_back();
+        } else {
+            slot = &*std::min_element(archive.cache.begin(), archive.cache.end(), [](const CachedChunk& a, const CachedChunk& b) {
+                return a.lastUse < b.lastUse;
+            });
+        }
+        slot->chunk = UINT64_MAX; // Invalid until loaded
+        slot->lastUse = archive.useClock;
+
+        const ChunkLocation& location = archive.index[chunk];
+        uint32_t length = archive.ChunkLength(chunk);
+        slot->data.resize(length);
+
+        if ( location.compressedSize == length ) {
+            if ( !ReadReal(file, slot->data.data(), length, location.offset) )
+                return nullptr;
+        } else {
+            archive.compressed.resize(location.compressedSize);
+            if ( !ReadReal(file, archive.compressed.data(), location.compressedSize, location.offset) )
+                return nullptr;
+
+            uLongf inflated = length;
+            int res = uncompress(
+                reinterpret_cast<Bytef*>(slot->data.data()), &inflated,
+                reinterpret_cast<const Bytef*>(archive.compressed.data()), location.compressedSize
+            );
+            if ( res != Z_OK || inflated != length )
+                return nullptr;
+        }
+
+        slot->chunk = chunk;
+        return &slot->data;
+    }
+
+    int Close(sqlite3_file* file) {
+        delete ShimState<Archive>(file);
+        return Real(file)->pMethods->xClose(Real(file));
+    }
+
+    int Read(sqlite3_file* file, void* buffer, int amount, sqlite3_int64 offset) {
+        Archive& archive = GetArchive(file);
+        char* out = static_cast<char*>(buffer);
+        uint64_t position = static_cast<uint64_t>(offset);
+        size_t done = 0;
+
+        while ( done < static_cast<size_t>(amount) && position < archive.size ) {
+            uint64_t chunk = position / archive.chunkSize;
+            const std::string* data = LoadChunk(file, chunk);
+            if ( !data )
+                return SQLITE_IOERR_READ;
+
+            size_t within = static_cast<size_t>(position - chunk * archive.chunkSize);
+            size_t count = std::min(static_cast<size_t>(amount) - done, data->size() - within);
+            std::memcpy(out + done, data->data() + within, count);
+            done += count;
+            position += count;
+        }
+
+        // Reads past the end must zero the rest of the buffer
+        if ( done < static_cast<size_t>(amount) ) {
+            std::memset(out + done, 0, amount - done);
+            return SQLITE_IOERR_SHORT_READ;
+        }
+
+        return SQLITE_OK;
+    }
+
+    int Write(sqlite3_file*, const void*, int, sqlite3_int64) {
+        return SQLITE_READONLY;
+    }
+
+    int Truncate(sqlite3_file*, sqlite3_int64) {
+        return SQLITE_READONLY;
+    }
+
+    int Sync(sqlite3_file*, int) {
+        return SQLITE_OK;
+    }
+
+    int FileSize(sqlite3_file* file, sqlite3_int64* size) {
+        *size = static_cast<sqlite3_int64>(GetArchive(file).size);
+        return SQLITE_OK;
+    }
+
+    // Version 1, without shared memory or memory maps, which address the
+    // file as stored rather than the data base inside it. Locks are taken
+    // on the archive file itself, so the usual rules apply between processes.
+    sqlite3_io_methods ArchiveMethods() {
+        sqlite3_io_methods methods = ShimForwardingMethods(1);
+        methods.xClose = Close;
+        methods.xRead = Read;
+        methods.xWrite = Write;
+        methods.xTruncate = Truncate;
+        methods.xSync = Sync;
+        methods.xFileSize = FileSize;
+        return methods;
+    }
+
+    const sqlite3_io_methods METHODS = ArchiveMethods();
+
+    int Open(sqlite3_vfs* vfs, sqlite3_filename name, sqlite3_file* file, int flags, int* outFlags) {
+        sqlite3_vfs* real = ShimRealVfs(vfs);
+        // Only the data base is compressed, SQLite gets the real file
+        // for everything else, which fits in the shim's larger szOsFile
+        if ( !( flags & SQLITE_OPEN_MAIN_DB ) )
+            return real->xOpen(real, name, file, flags, outFlags);
+
+        ShimFile* archiveFile = reinterpret_cast<ShimFile*>(file);
+        archiveFile->base.pMethods = nullptr;
+        archiveFile->state = nullptr;
+        Real(file)->pMethods = nullptr;
+
+        int readOnlyFlags = ( flags & ~( SQLITE_OPEN_READWRITE | SQLITE_OPEN_CREATE ) ) | SQLITE_OPEN_READONLY;
+        int res = real->xOpen(real, name, Real(file), readOnlyFlags, outFlags);
+        if ( res != SQLITE_OK ) {
+            if ( Real(file)->pMethods )
+                Real(file)->pMethods->xClose(Real(file));
+            return res;
+        }
+
+        Archive* archive = new Archive();
+        archiveFile->state = archive;
+        if ( !ReadIndex(file, *archive) ) {
+            delete archive;
+            archiveFile->state = nullptr;
+            Real(file)->pMethods->xClose(Real(file));
+            return SQLITE_CANTOPEN;
+        }
+
+        archiveFile->base.pMethods = &METHODS;
+        if ( outFlags )
+            *outFlags = readOnlyFlags;
+        return SQLITE_OK;
+    }
+
+    const char* Register() {
+        // Layered over read-ahead, which prefetches the chunks of scans,
+        // and I/O statistics, so archive reads show up there
+        sqlite3_vfs* real = sqlite3_vfs_find(RegisterReadAheadVfs());
+        if ( !real )
+            return nullptr;
+
+        static sqlite3_vfs vfs;
+        InitShimVfs(vfs, real, VFS_NAME, Open);
+        return sqlite3_vfs_register(&vfs, 0) == SQLITE_OK ? VFS_NAME : nullptr;
+    }
+
+    // Deflates 'raw' into 'packed', or copies it when deflating doesn't make it smaller
+    void CompressChunk(const std::string& raw, std::string& packed) {
+        uLongf size = compressBound(static_cast<uLong>(raw.size()));
+        packed.resize(size);
+        int res = compress2(
+            reinterpret_cast<Bytef*>(packed.data()), &size,
+            reinterpret_cast<const Bytef*>(raw.data()), static_cast<uLong>(raw.size()), COMPRESSION_LEVEL
+        );
+
+        if ( res == Z_OK && size < raw.size() )
+            packed.resize(size);
+        else
+            packed = raw;
+    }
+}
+
+const char* RegisterCompressedVfs() {
+    static const char* name = Register();
+    return name;
+}
+
+bool IsCompressedArchive(const std::string& path) {
+    std::ifstream in(path, std::ios::binary);
+    char magic[sizeof(MAGIC)];
+    return in.read(magic, sizeof(magic)) && std::memcmp(magic, MAGIC, sizeof(MAGIC)) == 0;
+}
+
+/**
+ * @brief Writes the data base file at 'srcPath' as a compressed archive.
+ *
+ * Chunks are read in rounds of CHUNKS_PER_THREAD per worker, deflated in
+ * parallel, then written out in order while the index is built up. The
+ * header goes in last, so an interrupted archive is never mistaken for a
+ * complete one.
+ *
+ * @param srcPath    Data base file to compress. Must not change while this runs.
+ * @param dstPath    Archive to write, replaced if it exists.
+ * @param onProgress Called after every round.
+ * @param stop       Cancels the compression, removing 'dstPath'.
+ * @return true if the whole archive was written.
+ */
+bool CompressDatabaseFile(
+    const std::string& srcPath,
+    const std::string& dstPath,
+    const std::function<void(const ArchiveProgress&)>& onProgress,
+    std::stop_token stop)
+{
+    auto start = std::chrono::steady_clock::now();
+
+    std::error_code error;
+    uint64_t size = std::filesystem::file_size(srcPath, error);
+    std::ifstream in(srcPath, std::ios::binary);
+    std::ofstream out(dstPath, std::ios::binary | std::ios::trunc);
+    if ( error || !in || !out )
+        return false;
+
+    char header[HEADER_SIZE] = {};
+    out.write(header, sizeof(header)); // Filled in once the index is written
+
+    uint64_t chunkCount = ( size + CHUNK_SIZE - 1 ) / CHUNK_SIZE;
+    size_t threads = std::max(1u, std::thread::hardware_concurrency());
+    size_t roundChunks = threads * CHUNKS_PER_THREAD;
+
+    std::vector<std::string> raw(roundChunks);
+    std::vector<std::string> packed(roundChunks);
+    std::vector<ChunkLocation> index;
+    index.reserve(chunkCount);
+
+    ArchiveProgress progress;
+    progress.totalBytes = size;
+    uint64_t offset = HEADER_SIZE;
+    bool ok = true;
+
+    for ( uint64_t first = 0; ok && first < chunkCount; first += roundChunks ) {
+        if ( stop.stop_requested() ) {
+            ok = false;
+            break;
+        }
+
+        size_t count = static_cast<size_t>(std::min<uint64_t>(roundChunks, chunkCount - first));
+        for ( size_t i = 0; ok && i < count; i++ ) {
+            raw[i].resize(static_cast<size_t>(std::min<uint64_t>(CHUNK_SIZE, size - ( first + i ) * CHUNK_SIZE)));
+            ok = static_cast<bool>(in.read(raw[i].data(), raw[i].size()));
+        }
+        if ( !ok )
+            break;
+
+        // The file format write and read versions, 2 for WAL. The VFS can't
+        // offer the shared memory WAL needs, so archive in rollback mode.
+        if ( first == 0 && raw[0].size() >= 20 && raw[0][18] == 2 && raw[0][19] == 2 )
+            raw[0][18] = raw[0][19] = 1;
+
+        {
+            std::atomic<size_t> next = 0;
+            std::vector<std::jthread> workers;
+            for ( size_t t = 0; t < std::min(threads, count); t++ ) {
+                workers.emplace_back([&]() {
+                    for ( size_t i = next++; i < count; i = next++ )
+                        CompressChunk(raw[i], packed[i]);
+                });
+            }
+        }
+
+        for ( size_t i = 0; i < count; i++ ) {
+            out.write(packed[i].data(), packed[i].size());
+            index.push_back({ offset, static_cast<uint32_t>(packed[i].size()) });
+            offset += packed[i].size();
+            progress.bytesRead += raw[i].size();
+        }
+        ok = out.good();
+
+        progress.bytesWritten = offset;
+        progress.elapsedSeconds = std::chrono::duration<double>(std::chrono::steady_clock::now() - start).count();
+        if ( onProgress )
+            onProgress(progress);
+    }
+
+    if ( ok ) {
+        std::string entries(index.size() * INDEX_ENTRY_SIZE, '\0');
+        for ( size_t i = 0; i < index.size(); i++ ) {
+            PutLittleEndian(entries.data() + i * INDEX_ENTRY_SIZE, index[i].offset, 8);
+            PutLittleEndian(entries.data() + i * INDEX_ENTRY_SIZE + 8, index[i].compressedSize, 4);
+        }
+        out.write(entries.data(), entries.size());
+
+        std::memcpy(header, MAGIC, sizeof(MAGIC));
+        PutLittleEndian(header + 8, FORMAT_VERSION, 4);
+        PutLittleEndian(header + 12, CHUNK_SIZE, 4);
+        PutLittleEndian(header + 16, size, 8);
+        PutLittleEndian(header + 24, offset, 8);
+        PutLittleEndian(header + 32, chunkCount, 4);
+        out.seekp(0);
+        out.write(header, sizeof(header));
+        out.close();
+        ok = out.good();
+    }
+
+    if ( !ok ) {
+        out.close();
+        std::filesystem::remove(dstPath, error);
+    }
+
+    return ok;
+}
@@ -0,0 +1,381 @@
+// Backend
+#include "backend/csv_vtab.hxx"
+#include "backend/data_store.hxx"
+#include "backend/mapped_file.hxx"
+
+// STD
+#include <bit>
+#include <cstring>
+#include <string>
+#include <unordered_set>
+#include <vector>
+
+#if defined(__SSE2__) || defined(_M_X64) || ( defined(_M_IX86_FP) && _M_IX86_FP >= 2 )
+    #include <emmintrin.h>
+    #define CSV_SCAN_SSE2
+#endif
+
+namespace {
+    constexpr const char* MODULE_NAME = "csvfile";
+    constexpr uint64_t ROW_INDEX_STRIDE = 1024; // Rows between entries of the sparse row offset index
+    constexpr int ROWID_LOOKUP = 1; // idxNum for a single row looked up by rowid
+
+    struct Field {
+        const char* text;
+        int length;
+        bool escaped; // Quoted and containing "" pairs, must be unescaped before use
+    };
+
+    /**
+     * @brief Finds the end of the row starting at 'pos'.
+     *
+     * Newlines inside quoted fields don't end a row. Every quote toggles the
+     * quoted state, which also handles escaped "" pairs since they toggle twice.
+     * Bytes are compared 16 at a time where SSE2 is available.
+     *
+     * @return Offset just past the newline ending the row, or 'size' for the last row.
+     */
+    uint64_t FindRowEnd(const char* data, uint64_t size, uint64_t pos) {
+        bool quoted = false;
+        uint64_t i = pos;
+
+#ifdef CSV_SCAN_SSE2
+        const __m128i newline = _mm_set1_epi8('\n');
+        const __m128i quote = _mm_set1_epi8('"');
+
+        for ( ; i + 16 <= size; i += 16 ) {
+            __m128i chunk = _mm_loadu_si128(reinterpret_cast<const __m128i*>(data + i));
+            unsigned mask = static_cast<unsigned>(_mm_movemask_epi8(
+                _mm_or_si128(_mm_cmpeq_epi8(chunk, newline), _mm_cmpeq_epi8(chunk, quote))
+            ));
+
+            while ( mask ) {
+                uint64_t at = i + std::countr_zero(mask);
+                if ( data[at] == '"' )
+                    quoted = !quoted;
+                else if ( !quoted )
+                    return at + 1;
+
+                mask &= mask - 1;
+            }
+        }
+#endif
+
+        for ( ; i < size; i++ ) {
+            if ( data[i] == '"' )
+                quoted = !quoted;
+            else if ( data[i] == '\n' && !quoted )
+                return i + 1;
+        }
+
+        return size;
+    }
+
+    /**
+     * @brief Splits the row in [start, end) into fields pointing into 'data'.
+     *
+     * 'end' is the value returned by FindRowEnd, the trailing \n or \r\n is dropped.
+     */
+    void SplitRow(const char* data, uint64_t start, uint64_t end, std::vector<Field>& fields) {
+        fields.clear();
+        if ( end > start && data[end - 1] == '\n' )
+            end--;
+        if ( end > start && data[end - 1] == '\r' )
+            end--;
+
+        const char* pos = data + start;
+        const char* rowEnd = data + end;
+
+        while ( true ) {
+            Field field{ pos, 0, false };
+
+            if ( pos < rowEnd && *pos == '"' ) {
+                const char* text = ++pos;
+                while ( pos < rowEnd ) {
+                    if ( *pos == '"' ) {
+                        if ( pos + 1 < rowEnd && pos[1] == '"' ) {
+                            field.escaped = true;
+                            pos += 2;
+                            continue;
+                        }
+                        break;
+                    }
+                    pos++;
+                }
+
+                field.text = text;
+                field.length = static_cast<int>(pos - text);
+                if ( pos < rowEnd )
+                    pos++; // closing quote
+
+                // Anything between the closing quote and the next comma is dropped
+                const void* comma = std::memchr(pos, ',', rowEnd - pos);
+                pos = comma ? static_cast<const char*>(comma) : rowEnd;
+            } else {
+                const void* comma = std::memchr(pos, ',', rowEnd - pos);
+                const char* fieldEnd = comma ? static_cast<const char*>(comma) : rowEnd;
+                field.length = static_cast<int>(fieldEnd - pos);
+                pos = fieldEnd;
+            }
+
+            fields.push_back(field);
+            if ( pos >= rowEnd )
+                return;
+            pos++; // comma
+        }
+    }
+
+    std::string Unescape(const Field& field) {
+        std::string text;
+        text.reserve(field.length);
+        for ( int i = 0; i < field.length; i++ ) {
+            text += field.text[i];
+            if ( field.text[i] == '"' )
+                i++; // skip the second quote of the pair
+        }
+        return text;
+    }
+
+    // Module arguments are passed verbatim, so strip SQL string quotes if present
+    std::string Dequote(const char* argument) {
+        std::string text = argument;
+        if ( text.size() < 2 || ( text.front() != '\'' && text.front() != '"' ) || text.back() != text.front() )
+            return text;
+
+        char quote = text.front();
+        std::string result;
+        for ( size_t i = 1; i + 1 < text.size(); i++ ) {
+            result += text[i];
+            if ( text[i] == quote )
+                i++;
+        }
+        return result;
+    }
+
+    struct CSVTable : sqlite3_vtab {
+        MappedFile file;
+        uint64_t dataStart = 0; // Offset of the first row after the header
+        uint64_t rowCount = 0;
+        std::vector<uint64_t> rowOffsets; // Offset of row 1, ROW_INDEX_STRIDE + 1, 2 * ROW_INDEX_STRIDE + 1...
+    };
+
+    struct CSVCursor : sqlite3_vtab_cursor {
+        uint64_t rowStart = 0;
+        uint64_t rowEnd = 0;
+        sqlite3_int64 rowId = 0;
+        bool singleRow = false; // Rowid lookup, stop after the first row
+        bool eof = true;
+        bool split = false; // 'fields' holds the current row
+        std::vector<Field> fields;
+    };
+
+    CSVTable* TableOf(sqlite3_vtab_cursor* cursor) {
+        return static_cast<CSVTable*>(cursor->pVtab);
+    }
+
+    int Connect(sqlite3* db, void*, int argc, const char* const* argv, sqlite3_vtab** vtab, char** error) {
+        if ( argc != 4 ) {
+            *error = sqlite3_mprintf("%s: expected a single file name argument", MODULE_NAME);
+            return SQLITE_ERROR;
+        }
+
+        std::string path = Dequote(argv[3]);
+        CSVTable* table = new CSVTable();
+        if ( !table->file.Open(path) ) {
+            *error = sqlite3_mprintf("%s: could not open '%s'", MODULE_NAME, path.c_str());
+            delete table;
+            return SQLITE_ERROR;
+        }
+
+        const char* data = table->file.Data();
+        uint64_t size = table->file.Size();
+
+        uint64_t headerStart = size >= 3 && std::memcmp(data, "\xEF\xBB\xBF", 3) == 0 ? 3 : 0;
+        table->dataStart = FindRowEnd(data, size, headerStart);
+
+        // Column names from the header, made unique since SQLite rejects duplicates
+        std::vector<Field> header;
+        SplitRow(data, headerStart, table->dataStart, header);
+
+        std::unordered_set<std::string> names;
+        std::string schema = "CREATE TABLE x(";
+        for ( size_t i = 0; i < header.size(); i++ ) {
+            std::string name = header[i].escaped ? Unescape(header[i]) : std::string(header[i].text, header[i].length);
+            if ( name.empty() )
+                name = "c" + std::to_string(i + 1);
+
+            std::string unique = name;
+            for ( int suffix = 2; !names.insert(unique).second; suffix++ )
+                unique = name + "_" + std::to_string(suffix);
+
+            schema += ( i ? ", " : "" ) + DataStore::QuoteIdentifier(unique);
+        }
+        schema += ");";
+
+        int res = sqlite3_declare_vtab(db, schema.c_str());
+        if ( res != SQLITE_OK ) {
+            *error = sqlite3_mprintf("%s: could not declare columns: %s", MODULE_NAME, sqlite3_errmsg(db));
+            delete table;
+            return res;
+        }
+
+#ifdef SQLITE_VTAB_DIRECTONLY
+        // Reads arbitrary files, so never run it from a schema's views or triggers
+        sqlite3_vtab_config(db, SQLITE_VTAB_DIRECTONLY);
+#endif
+
+        // One pass over the file for the row count and sparse offset index
+        for ( uint64_t pos = table->dataStart; pos < size; pos = FindRowEnd(data, size, pos) ) {
+            if ( table->rowCount % ROW_INDEX_STRIDE == 0 )
+                table->rowOffsets.push_back(pos);
+            table->rowCount++;
+        }
+
+        *vtab = table;
+        return SQLITE_OK;
+    }
+
+    int Disconnect(sqlite3_vtab* vtab) {
+        delete static_cast<CSVTable*>(vtab);
+        return SQLITE_OK;
+    }
+
+    int BestIndex(sqlite3_vtab* vtab, sqlite3_index_info* info) {
+        CSVTable* table = static_cast<CSVTable*>(vtab);
+
+        for ( int i = 0; i < info->nConstraint; i++ ) {
+            const auto& constraint = info->aConstraint[i];
+            if ( constraint.usable && constraint.iColumn == -1 && constraint.op == SQLITE_INDEX_CONSTRAINT_EQ ) {
+                info->aConstraintUsage[i].argvIndex = 1;
+                info->aConstraintUsage[i].omit = 1;
+                info->idxNum = ROWID_LOOKUP;
+                info->idxFlags = SQLITE_INDEX_SCAN_UNIQUE;
+                info->estimatedCost = 10.0 + ROW_INDEX_STRIDE / 2;
+                info->estimatedRows = 1;
+                return SQLITE_OK;
+            }
+        }
+
+        info->idxNum = 0;
+        info->estimatedCost = 10.0 + static_cast<double>(table->rowCount);
+        info->estimatedRows = static_cast<sqlite3_int64>(table->rowCount);
+        return SQLITE_OK;
+    }
+
+    int Open(sqlite3_vtab*, sqlite3_vtab_cursor** cursor) {
+        *cursor = new CSVCursor();
+        return SQLITE_OK;
+    }
+
+    int Close(sqlite3_vtab_cursor* cursor) {
+        delete static_cast<CSVCursor*>(cursor);
+        return SQLITE_OK;
+    }
+
+    // Makes 'rowStart' the current row and finds where it ends
+    void LoadRow(CSVCursor* cursor, uint64_t rowStart) {
+        const MappedFile& file = TableOf(cursor)->file;
+        cursor->rowStart = rowStart;
+        cursor->eof = rowStart >= file.Size();
+        cursor->rowEnd = cursor->eof ? rowStart : FindRowEnd(file.Data(), file.Size(), rowStart);
+        cursor->split = false;
+    }
+
+    int Filter(sqlite3_vtab_cursor* base, int idxNum, const char*, int argc, sqlite3_value** argv) {
+        CSVCursor* cursor = static_cast<CSVCursor*>(base);
+        CSVTable* table = TableOf(base);
+        cursor->singleRow = idxNum == ROWID_LOOKUP;
+
+        if ( !cursor->singleRow ) {
+            cursor->rowId = 1;
+            LoadRow(cursor, table->dataStart);
+            return SQLITE_OK;
+        }
+
+        sqlite3_int64 rowId = argc > 0 ? sqlite3_value_int64(argv[0]) : 0;
+        if ( rowId < 1 || static_cast<uint64_t>(rowId) > table->rowCount ) {
+            cursor->eof = true;
+            return SQLITE_OK;
+        }
+
+        // Jump to the closest indexed row, then step over the rest
+        uint64_t index = static_cast<uint64_t>(rowId - 1);
+        uint64_t pos = table->rowOffsets[index / ROW_INDEX_STRIDE];
+        for ( uint64_t skip = index % ROW_INDEX_STRIDE; skip > 0; skip-- )
+            pos = FindRowEnd(table->file.Data(), table->file.Size(), pos);
+
+        cursor->rowId = rowId;
+        LoadRow(cursor, pos);
+        return SQLITE_OK;
+    }
+
+    int Next(sqlite3_vtab_cursor* base) {
+        CSVCursor* cursor = static_cast<CSVCursor*>(base);
+        if ( cursor->singleRow ) {
+            cursor->eof = true;
+            return SQLITE_OK;
+        }
+
+        cursor->rowId++;
+        LoadRow(cursor, cursor->rowEnd);
+        return SQLITE_OK;
+    }
+
+    int Eof(sqlite3_vtab_cursor* base) {
+        return static_cast<CSVCursor*>(base)->eof;
+    }
+
+    int Column(sqlite3_vtab_cursor* base, sqlite3_context* context, int col) {
+        CSVCursor* cursor = static_cast<CSVCursor*>(base);
+        if ( !cursor->split ) {
+            SplitRow(TableOf(base)->file.Data(), cursor->rowStart, cursor->rowEnd, cursor->fields);
+            cursor->split = true;
+        }
+
+        // Short rows have NULLs for their missing fields
+        if ( col >= static_cast<int>(cursor->fields.size()) ) {
+            sqlite3_result_null(context);
+            return SQLITE_OK;
+        }
+
+        const Field& field = cursor->fields[col];
+        if ( field.escaped ) {
+            std::string text = Unescape(field);
+            sqlite3_result_text(context, text.data(), static_cast<int>(text.size()), SQLITE_TRANSIENT);
+        } else {
+            // The mapping outlives every statement using the table
+            sqlite3_result_text(context, field.text, field.length, SQLITE_STATIC);
+        }
+
+        return SQLITE_OK;
+    }
+
+    int Rowid(sqlite3_vtab_cursor* base, sqlite3_int64* rowId) {
+        *rowId = static_cast<CSVCursor*>(base)->rowId;
+        return SQLITE_OK;
+    }
+
+    sqlite3_module MakeModule() {
+        sqlite3_module module{};
+        module.iVersion = 0;
+        module.xCreate = Connect;
+        module.xConnect = Connect;
+        module.xBestIndex = BestIndex;
+        module.xDisconnect = Disconnect;
+        module.xDestroy = Disconnect;
+        module.xOpen = Open;
+        module.xClose = Close;
+        module.xFilter = Filter;
+        module.xNext = Next;
+        module.xEof = Eof;
+        module.xColumn = Column;
+        module.xRowid = Rowid;
+        return module;
+    }
+
+    const sqlite3_module CSV_MODULE = MakeModule();
+}
+
+bool RegisterCSVModule(sqlite3* db) {
+    return sqlite3_create_module(db, MODULE_NAME, &CSV_MODULE, nullptr) == SQLITE_OK;
+}
@@ -1,10 +1,174 @@
 // Backend
 #include "backend/data_store.hxx"
+#include "backend/csv_vtab.hxx"
+#include "backend/io_stats.hxx"
+#include "backend/trace.hxx"
 
 // STD
+#include <algorithm>
+#include <atomic>
+#include <chrono>
+#include <cstdio>
 #include <filesystem>
+#include <random>
+#include <thread>
+#include <unordered_map>
 
-DataStore::DataStore(const std::string& dbPath) {
+namespace {
+    // Tables estimated to be larger than this are sampled
+    // in random blocks rather than scanned in full.
+    constexpr sqlite3_int64 STATS_SAMPLE_THRESHOLD = 1'000'000;
+    constexpr int STATS_SAMPLE_BLOCKS = 256;
+    constexpr int STATS_SAMPLE_BLOCK_ROWS = 1024;
+    constexpr int STATS_STOP_CHECK_INTERVAL = 4096; // Rows between checks for a stop request
+
+    constexpr int BACKUP_PAGES_PER_STEP = 1024; // 4 MiB per step with the default page size
+    constexpr auto BACKUP_STEP_PAUSE = std::chrono::milliseconds(5); // Lets writers in between steps
+    constexpr auto BACKUP_BUSY_RETRY = std::chrono::milliseconds(50); // Wait when the source is locked
+
+    constexpr sqlite3_int64 MEMORY_SIZE_LIMIT = sqlite3_int64(64) << 30; // memdb refuses to grow past 1 GiB by default
+
+    constexpr int ARCHIVE_STOP_CHECK_OPS = 100'000; // VM instructions between checks for a stop request while vacuuming
+
+    constexpr int QUICK_CHECK_PROGRESS_OPS = 100'000; // VM instructions between progress handler calls
+    constexpr double QUICK_CHECK_REPORT_INTERVAL = 0.1; // Seconds between progress reports
+    constexpr int QUICK_CHECK_MAX_ERRORS = 100;
+
+    const char* TABLE_NAMES_QUERY = "SELECT name FROM sqlite_master WHERE type='table' AND name NOT LIKE 'sqlite_%' ORDER BY name;";
+
+    // A memdb name starting with '/' is shared by every connection
+    // in the process that opens it, so read connections see the copy.
+    std::string MemoryDatabaseUri() {
+        static std::atomic<int> count = 0;
+        return "file:/sqlight-memory-" + std::to_string(++count) + "?vfs=memdb";
+    }
+
+    // 'path' as an absolute URI filename, for options only URI parameters
+    // can set. Characters URIs reserve are escaped
+    std::string FileUri(const std::string& path, const std::string& parameters) {
+        std::error_code ec;
+        std::string absolute = std::filesystem::absolute(path, ec).generic_string();
+        if ( ec || absolute.empty() )
+            absolute = path;
+
+        std::string uri = "file:";
+        if ( absolute.front() != '/' )
+            uri += '/'; // "file:/C:/..." on Windows
+
+        for ( char c : absolute ) {
+            if ( c == '%' || c == '?' || c == '#' ) {
+                char escaped[4];
+                std::snprintf(escaped, sizeof(escaped), "%%%02X", static_cast<unsigned char>(c));
+                uri += escaped;
+            } else {
+                uri += c;
+            }
+        }
+
+        return uri + "?" + parameters;
+    }
+
+    // Nothing is writing to the file at 'path': there is no rollback journal
+    // and no WAL with frames next to it. Either would mean a write is under
+    // way, or was cut short, and SQLite has to look at the file through it.
+    bool IsQuiescent(const std::string& path) {
+        std::error_code ec;
+        if ( std::filesystem::exists(path + "-journal", ec) )
+            return false;
+
+        uintmax_t walSize = std::filesystem::file_size(path + "-wal", ec);
+        return ec || walSize == 0; // No WAL at all fails with an error
+    }
+
+    std::string JournalMode(sqlite3* db) {
+        std::string mode;
+        sqlite3_stmt* stmt;
+        if ( sqlite3_prepare_v2(db, "PRAGMA journal_mode;", -1, &stmt, NULL) == SQLITE_OK ) {
+            if ( sqlite3_step(stmt) == SQLITE_ROW )
+                mode = reinterpret_cast<const char*>(sqlite3_column_text(stmt, 0));
+            sqlite3_finalize(stmt);
+        }
+        return mode;
+    }
+
+    /**
+     * @brief Copies the data base file at 'path' into the empty memdb data base open on 'memory'.
+     *
+     * The file is copied page by page in file order in a single backup step,
+     * one long sequential read the read-ahead VFS streams in large windows.
+     * A file in WAL mode is copied with VACUUM INTO instead: its header asks
+     * for WAL, which memdb can't provide to more than one connection, and
+     * VACUUM INTO writes a rollback journal mode header, with pages still in
+     * the WAL included.
+     *
+     * sqlite3_deserialize would take a buffer read in one go, but the data
+     * base it creates is private to one connection, out of reach of the read
+     * connections background work runs on.
+     */
+    bool LoadIntoMemory(sqlite3* memory, const std::string& memoryUri, const std::string& path, const char* vfs) {
+        sqlite3_int64 limit = MEMORY_SIZE_LIMIT;
+        sqlite3_file_control(memory, "main", SQLITE_FCNTL_SIZE_LIMIT, &limit);
+
+        // URIs are allowed so the VACUUM INTO target can name the memdb VFS
+        sqlite3* source = nullptr;
+        if ( sqlite3_open_v2(path.c_str(), &source, SQLITE_OPEN_READONLY | SQLITE_OPEN_URI, vfs) != SQLITE_OK ) {
+            sqlite3_close(source);
+            return false;
+        }
+
+        bool loaded = false;
+        if ( JournalMode(source) == "wal" ) {
+            sqlite3_stmt* stmt;
+            if ( sqlite3_prepare_v2(source, "VACUUM INTO ?;", -1, &stmt, NULL) == SQLITE_OK ) {
+                sqlite3_bind_text(stmt, 1, memoryUri.c_str(), -1, SQLITE_TRANSIENT);
+                loaded = sqlite3_step(stmt) == SQLITE_DONE;
+                sqlite3_finalize(stmt);
+            }
+        } else {
+            sqlite3_backup* backup = sqlite3_backup_init(memory, "main", source, "main");
+            loaded = backup && sqlite3_backup_step(backup, -1) == SQLITE_DONE;
+            sqlite3_backup_finish(backup);
+        }
+
+        sqlite3_close(source);
+        return loaded;
+    }
+
+    // Estimates the rows of 'table' from its b-tree pages, as listed by
+    // 'dbstat', a prepared "SELECT pagetype, ncell FROM dbstat WHERE
+    // name=?". dbstat walks the tree depth first, so the first leaf is
+    // reached after one page read per level. The fan-out of each interior
+    // page on the way, times the rows of that leaf, estimates the leaf
+    // page count times rows per leaf without reading the other leaves.
+    // A root that is a leaf holds the exact count.
+    bool EstimateFromPages(sqlite3_stmt* dbstat, const std::string& table, RowCount& count) {
+        sqlite3_reset(dbstat);
+        sqlite3_bind_text(dbstat, 1, table.c_str(), -1, SQLITE_TRANSIENT);
+
+        bool found = false;
+        double leaves = 1;
+        bool root = true;
+        while ( sqlite3_step(dbstat) == SQLITE_ROW ) {
+            std::string type = reinterpret_cast<const char*>(sqlite3_column_text(dbstat, 0));
+            int cells = sqlite3_column_int(dbstat, 1);
+            if ( type == "internal" ) {
+                leaves *= cells + 1; // the right-most child isn't in a cell
+            } else if ( type == "leaf" ) {
+                count = { static_cast<uint64_t>(leaves * cells), root };
+                found = true;
+                break;
+            }
+            root = false;
+        }
+
+        sqlite3_reset(dbstat);
+        return found;
+    }
+}
+
+DataStore::DataStore(const std::string& dbPath) 
+    : m_db(nullptr), m_connected(false)
+{
     this->Connect(dbPath);
 }
 
@@ -12,14 +176,49 @@ DataStore::~DataStore() {
     this->Disconnect();
 }
 
-bool DataStore::Connect(const std::string& dbPath) {
-    // Ensure we are not already connected and that
-    // the path to the .db file actually exists
-    if ( this->m_connected || !std::filesystem::exists(dbPath) )
+bool DataStore::Connect(const std::string& dbPath, const ConnectProfile& profile) {
+    TRACE_SCOPE("DataStore::Connect");
+
+    if ( this->m_connected )
         return false;
 
-    // sqlite3_open returns SQLITE_OK on success
-    return sqlite3_open(dbPath.c_str(), &this->m_db) == SQLITE_OK;
+    this->m_profile = profile;
+    this->m_readPath = dbPath;
+    int flags = profile.compressedArchive || profile.readOnly ? SQLITE_OPEN_READONLY : SQLITE_OPEN_READWRITE;
+    if ( profile.inMemory ) {
+        this->m_readPath = MemoryDatabaseUri();
+        flags = SQLITE_OPEN_READWRITE | SQLITE_OPEN_CREATE | SQLITE_OPEN_URI;
+    } else if ( profile.readOnly && IsQuiescent(dbPath) ) {
+        // An immutable file is read without taking locks or checking
+        // whether it changed before each transaction, which saves round
+        // trips on network file systems. Changes made by others while it
+        // is open are not seen and may make reads fail
+        this->m_readPath = FileUri(dbPath, "immutable=1");
+        flags |= SQLITE_OPEN_URI;
+    }
+
+    // Without SQLITE_OPEN_CREATE a missing file fails to open rather than
+    // being created. Opening only allocates the handle, the file header and
+    // schema are first read by the first statement that needs them. Files
+    // go through the VFS shims VfsName picks for the profile. In memory,
+    // m_db opens an empty memdb data base the whole file is copied into.
+    if ( sqlite3_open_v2(this->m_readPath.c_str(), &this->m_db, flags, this->VfsName()) != SQLITE_OK
+        || ( profile.inMemory && !LoadIntoMemory(this->m_db, this->m_readPath, dbPath, this->VfsName()) ) ) {
+        // A handle is allocated even when opening fails
+        sqlite3_close(this->m_db);
+        this->m_db = nullptr;
+        return false;
+    }
+
+    RegisterCSVModule(this->m_db);
+
+    this->m_dbPath = dbPath;
+    this->m_connected = true;
+    return true;
+}
+
+bool DataStore::IsReadOnly() const {
+    return this->m_connected && sqlite3_db_readonly(this->m_db, "main") == 1;
 }
 
 bool DataStore::Disconnect() {
@@ -27,33 +226,784 @@ bool DataStore::Disconnect() {
     if ( !this->m_connected || !this->m_db )
         return false;
 
-    return sqlite3_close(this->m_db) == SQLITE_OK;
+    if ( sqlite3_close(this->m_db) != SQLITE_OK )
+        return false;
+
+    this->m_db = nullptr;
+    this->m_connected = false;
+    return true;
+}
+
+std::vector<std::string> DataStore::GetTableNames() {
+    std::vector<std::string> names;
+    if ( !this->m_connected )
+        return names;
+
+    sqlite3_stmt* stmt;
+    if ( sqlite3_prepare_v2(m_db, TABLE_NAMES_QUERY, -1, &stmt, NULL) != SQLITE_OK )
+        return names;
+
+    while ( sqlite3_step(stmt) == SQLITE_ROW )
+        names.emplace_back(reinterpret_cast<const char*>(sqlite3_column_text(stmt, 0)));
+
+    sqlite3_finalize(stmt);
+    return names;
+}
+
+bool DataStore::ReadTableNames(std::vector<std::string>& names) {
+    names.clear();
+
+    sqlite3* db = OpenReadConnection();
+    if ( !db )
+        return false;
+
+    sqlite3_stmt* stmt;
+    if ( sqlite3_prepare_v2(db, TABLE_NAMES_QUERY, -1, &stmt, NULL) != SQLITE_OK ) {
+        sqlite3_close(db);
+        return false;
+    }
+
+    int res;
+    while ( ( res = sqlite3_step(stmt) ) == SQLITE_ROW )
+        names.emplace_back(reinterpret_cast<const char*>(sqlite3_column_text(stmt, 0)));
+
+    sqlite3_finalize(stmt);
+    sqlite3_close(db);
+    return res == SQLITE_DONE;
+}
+
+bool DataStore::ReadSchemaVersion(int64_t& version) {
+    sqlite3* db = OpenReadConnection();
+    if ( !db )
+        return false;
+
+    // Bumped by every schema change. Unlike reading sqlite_master, this
+    // doesn't parse the schema, so checking a cached table list is cheap
+    sqlite3_stmt* stmt;
+    bool read = false;
+    if ( sqlite3_prepare_v2(db, "PRAGMA schema_version;", -1, &stmt, NULL) == SQLITE_OK ) {
+        read = sqlite3_step(stmt) == SQLITE_ROW;
+        if ( read )
+            version = sqlite3_column_int64(stmt, 0);
+        sqlite3_finalize(stmt);
+    }
+
+    sqlite3_close(db);
+    return read;
 }
 
-void DataStore::ExportTableToJSON(
-    const std::string& tableName, 
-    const std::string& outputFilename
+bool DataStore::QuickCheck(
+    std::vector<std::string>& problems,
+    const std::function<void(double)>& onProgress,
+    std::stop_token stop)
+{
+    problems.clear();
+
+    sqlite3* db = OpenReadConnection();
+    if ( !db )
+        return false;
+
+    // quick_check can't report how far along it is, so progress is the
+    // elapsed time, reported from the progress handler which also
+    // interrupts the check once a stop is requested.
+    struct Context {
+        const std::function<void(double)>& onProgress;
+        std::stop_token stop;
+        std::chrono::steady_clock::time_point start = std::chrono::steady_clock::now();
+        double lastReport = 0;
+    } context{ onProgress, stop };
+
+    sqlite3_progress_handler(db, QUICK_CHECK_PROGRESS_OPS, [](void* data) -> int {
+        Context* context = static_cast<Context*>(data);
+        if ( context->stop.stop_requested() )
+            return 1;
+
+        double elapsed = std::chrono::duration<double>(std::chrono::steady_clock::now() - context->start).count();
+        if ( context->onProgress && elapsed - context->lastReport >= QUICK_CHECK_REPORT_INTERVAL ) {
+            context->lastReport = elapsed;
+            context->onProgress(elapsed);
+        }
+        return 0;
+    }, &context);
+
+    sqlite3_stmt* stmt;
+    std::string query = "PRAGMA quick_check(" + std::to_string(QUICK_CHECK_MAX_ERRORS) + ");";
+    if ( sqlite3_prepare_v2(db, query.c_str(), -1, &stmt, NULL) != SQLITE_OK ) {
+        sqlite3_close(db);
+        return false;
+    }
+
+    // A single "ok" row when no problems were found
+    int res;
+    while ( ( res = sqlite3_step(stmt) ) == SQLITE_ROW ) {
+        std::string row = reinterpret_cast<const char*>(sqlite3_column_text(stmt, 0));
+        if ( row != "ok" )
+            problems.push_back(row);
+    }
+
+    sqlite3_finalize(stmt);
+    sqlite3_close(db);
+    return res == SQLITE_DONE;
+}
+
+bool DataStore::EstimateRowCounts(std::map<std::string, RowCount>& counts, std::stop_token stop) {
+    counts.clear();
+
+    sqlite3* db = OpenReadConnection();
+    if ( !db )
+        return false;
+
+    // ANALYZE stores each table's row count as the first number of its
+    // sqlite_stat1 rows. It may be out of date, but all tables cost one
+    // small read. The table doesn't exist until ANALYZE is first run
+    sqlite3_stmt* stmt;
+    const char* statQuery = "SELECT tbl, max(CAST(stat AS INTEGER)) FROM sqlite_stat1 GROUP BY tbl;";
+    if ( sqlite3_prepare_v2(db, statQuery, -1, &stmt, NULL) == SQLITE_OK ) {
+        while ( sqlite3_step(stmt) == SQLITE_ROW ) {
+            std::string table = reinterpret_cast<const char*>(sqlite3_column_text(stmt, 0));
+            counts[table] = { static_cast<uint64_t>(std::max<sqlite3_int64>(sqlite3_column_int64(stmt, 1), 0)), false };
+        }
+        sqlite3_finalize(stmt);
+    }
+
+    // max(rowid) of a virtual table may scan it, so they are left to CountRows
+    std::vector<std::string> tables;
+    const char* tablesQuery = "SELECT name FROM sqlite_master WHERE type='table' AND name NOT LIKE 'sqlite_%' AND sql NOT LIKE 'CREATE VIRTUAL TABLE%';";
+    if ( sqlite3_prepare_v2(db, tablesQuery, -1, &stmt, NULL) != SQLITE_OK ) {
+        sqlite3_close(db);
+        return false;
+    }
+
+    while ( sqlite3_step(stmt) == SQLITE_ROW )
+        tables.emplace_back(reinterpret_cast<const char*>(sqlite3_column_text(stmt, 0)));
+    sqlite3_finalize(stmt);
+
+    // dbstat is only there if SQLite was built with SQLITE_ENABLE_DBSTAT_VTAB
+    sqlite3_stmt* dbstat = nullptr;
+    if ( sqlite3_prepare_v2(db, "SELECT pagetype, ncell FROM dbstat WHERE name=?;", -1, &dbstat, NULL) != SQLITE_OK )
+        dbstat = nullptr;
+
+    // max(rowid) is read from the right edge of the b-tree, a few pages
+    // however large the table is. It is an upper bound, far off after bulk
+    // deletes or on tables with rowid gaps, so the smaller of it and the
+    // page estimate is taken. It fails to prepare for WITHOUT ROWID tables
+    for ( const std::string& table : tables ) {
+        if ( stop.stop_requested() )
+            break;
+
+        if ( counts.contains(table) )
+            continue;
+
+        RowCount count;
+        bool estimated = dbstat && EstimateFromPages(dbstat, table, count);
+        if ( count.exact ) {
+            counts[table] = count;
+            continue;
+        }
+
+        std::string query = "SELECT max(rowid) FROM " + QuoteIdentifier(table) + ";";
+        if ( sqlite3_prepare_v2(db, query.c_str(), -1, &stmt, NULL) == SQLITE_OK ) {
+            if ( sqlite3_step(stmt) == SQLITE_ROW ) {
+                uint64_t maxRowId = static_cast<uint64_t>(std::max<sqlite3_int64>(sqlite3_column_int64(stmt, 0), 0));
+                if ( sqlite3_column_type(stmt, 0) == SQLITE_NULL )
+                    count = { 0, true }; // No highest rowid means no rows
+                else
+                    count.rows = estimated ? std::min(count.rows, maxRowId) : maxRowId;
+                estimated = true;
+            }
+            sqlite3_finalize(stmt);
+        }
+
+        if ( estimated )
+            counts[table] = count;
+    }
+
+    sqlite3_finalize(dbstat);
+    sqlite3_close(db);
+    return !stop.stop_requested();
+}
+
+bool DataStore::CountRows(
+    const std::vector<std::string>& tableNames,
+    const std::function<void(const std::string&, uint64_t)>& onCounted,
+    std::stop_token stop)
+{
+    sqlite3* db = OpenReadConnection();
+    if ( !db )
+        return false;
+
+    {
+        // count(*) walks the whole b-tree in a single VM instruction, so a
+        // progress handler would never be called. The walk does check for
+        // sqlite3_interrupt between pages
+        std::stop_callback interrupt(stop, [db]() { sqlite3_interrupt(db); });
+
+        for ( const std::string& table : tableNames ) {
+            if ( stop.stop_requested() )
+                break;
+
+            sqlite3_stmt* stmt;
+            std::string query = "SELECT count(*) FROM " + QuoteIdentifier(table) + ";";
+            if ( sqlite3_prepare_v2(db, query.c_str(), -1, &stmt, NULL) != SQLITE_OK )
+                continue;
+
+            bool counted = sqlite3_step(stmt) == SQLITE_ROW;
+            uint64_t rows = counted ? static_cast<uint64_t>(sqlite3_column_int64(stmt, 0)) : 0;
+            sqlite3_finalize(stmt);
+
+            if ( counted )
+                onCounted(table, rows);
+        }
+    }
+
+    sqlite3_close(db);
+    return !stop.stop_requested();
+}
+
+std::vector<std::string> DataStore::GetColumnNames(const std::string& tableName) {
+    std::vector<std::string> names;
+    if ( !this->m_connected )
+        return names;
+
+    sqlite3_stmt* stmt;
+    const char* query = "SELECT name FROM pragma_table_info(?) ORDER BY cid;";
+    if ( sqlite3_prepare_v2(m_db, query, -1, &stmt, NULL) != SQLITE_OK )
+        return names;
+
+    sqlite3_bind_text(stmt, 1, tableName.c_str(), -1, SQLITE_TRANSIENT);
+    while ( sqlite3_step(stmt) == SQLITE_ROW )
+        names.emplace_back(reinterpret_cast<const char*>(sqlite3_column_text(stmt, 0)));
+
+    sqlite3_finalize(stmt);
+    return names;
+}
+
+bool DataStore::FetchRecords(const std::string& tableName, int limit, TableRecords& records) {
+    records = {};
+    if ( !this->m_connected || !TableExists(tableName) )
+        return false;
+
+    records.columns = GetColumnNames(tableName);
+
+    // typeof() and length() are answered from the record header, so
+    // large BLOBs are never read just to fill the grid. Each column is
+    // selected as (blob length or NULL, value or NULL for BLOBs).
+    std::string query = "SELECT rowid";
+    for ( const std::string& name : records.columns ) {
+        std::string column = QuoteIdentifier(name);
+        query += ", CASE WHEN typeof(" + column + ") = 'blob' THEN length(" + column + ") END";
+        query += ", CASE WHEN typeof(" + column + ") = 'blob' THEN NULL ELSE " + column + " END";
+    }
+    query += " FROM " + QuoteIdentifier(tableName) + " LIMIT ?;";
+    sqlite3_stmt* stmt;
+    if ( sqlite3_prepare_v2(m_db, query.c_str(), -1, &stmt, NULL) != SQLITE_OK )
+        return false;
+
+    sqlite3_bind_int(stmt, 1, limit);
+
+    while ( sqlite3_step(stmt) == SQLITE_ROW ) {
+        records.rowIds.push_back(sqlite3_column_int64(stmt, 0));
+
+        std::vector<std::string> row;
+        row.reserve(records.columns.size());
+        for ( size_t col = 0; col < records.columns.size(); col++ ) {
+            int blobLength = 1 + static_cast<int>(col) * 2;
+            if ( sqlite3_column_type(stmt, blobLength) != SQLITE_NULL ) {
+                row.push_back("<BLOB " + std::to_string(sqlite3_column_int64(stmt, blobLength)) + " bytes>");
+                records.blobCells.emplace_back(records.cells.size(), col);
+                continue;
+            }
+
+            const unsigned char* text = sqlite3_column_text(stmt, blobLength + 1);
+            row.emplace_back(text ? reinterpret_cast<const char*>(text) : "");
+        }
+
+        records.cells.push_back(std::move(row));
+    }
+
+    sqlite3_finalize(stmt);
+    return true;
+}
+
+bool DataStore::OpenBlob(
+    const std::string& tableName,
+    const std::string& columnName,
+    sqlite3_int64 rowId,
+    BlobReader& reader
 )
 {
+    reader.Close();
+    if ( !this->m_connected )
+        return false;
 
+    // sqlite3_blob_open also accepts TEXT cells, only hand out real BLOBs
+    std::string query = "SELECT typeof(" + QuoteIdentifier(columnName) + ") = 'blob' FROM " + QuoteIdentifier(tableName) + " WHERE rowid = ?;";
+    sqlite3_stmt* stmt;
+    if ( sqlite3_prepare_v2(m_db, query.c_str(), -1, &stmt, NULL) != SQLITE_OK )
+        return false;
+
+    sqlite3_bind_int64(stmt, 1, rowId);
+    bool isBlob = sqlite3_step(stmt) == SQLITE_ROW && sqlite3_column_int(stmt, 0);
+    sqlite3_finalize(stmt);
+
+    return isBlob && reader.Open(m_db, tableName, columnName, rowId);
+}
+
+bool DataStore::ComputeColumnStats(
+    const std::string& tableName,
+    const std::string& columnName,
+    ColumnStats& stats,
+    std::stop_token stop
+)
+{
+    stats.table = tableName;
+    stats.column = columnName;
+
+    sqlite3* db = OpenReadConnection();
+    if ( !db )
+        return false;
+
+    std::string table = QuoteIdentifier(tableName);
+    std::string column = QuoteIdentifier(columnName);
+    sqlite3_stmt* stmt;
+
+    // max(rowid) is answered from the right edge of the b-tree, so it
+    // is a cheap upper bound on the row count. Fails for WITHOUT ROWID
+    // tables, which are then always scanned in full.
+    sqlite3_int64 maxRowId = 0;
+    std::string query = "SELECT max(rowid) FROM " + table + ";";
+    if ( sqlite3_prepare_v2(db, query.c_str(), -1, &stmt, NULL) == SQLITE_OK ) {
+        if ( sqlite3_step(stmt) == SQLITE_ROW )
+            maxRowId = sqlite3_column_int64(stmt, 0);
+        sqlite3_finalize(stmt);
+    }
+
+    stats.estimatedRows = static_cast<uint64_t>(maxRowId);
+    stats.sampled = maxRowId > STATS_SAMPLE_THRESHOLD;
+
+    if ( stats.sampled )
+        query = "SELECT " + column + " FROM " + table + " WHERE rowid >= ? ORDER BY rowid LIMIT ?;";
+    else
+        query = "SELECT " + column + " FROM " + table + ";";
+
+    if ( sqlite3_prepare_v2(db, query.c_str(), -1, &stmt, NULL) != SQLITE_OK ) {
+        sqlite3_close(db);
+        return false;
+    }
+
+    ColumnStatsCollector collector;
+    std::mt19937_64 rng(std::random_device{}());
+    std::uniform_int_distribution<sqlite3_int64> pickRowId(1, maxRowId > 0 ? maxRowId : 1);
+
+    bool stopped = false;
+    bool failed = false;
+    int blocks = stats.sampled ? STATS_SAMPLE_BLOCKS : 1;
+    for ( int block = 0; block < blocks && !stopped && !failed; block++ ) {
+        if ( stats.sampled ) {
+            // Each block is one index seek followed by a short
+            // sequential read, so the cost doesn't grow with the table.
+            sqlite3_reset(stmt);
+            sqlite3_bind_int64(stmt, 1, pickRowId(rng));
+            sqlite3_bind_int(stmt, 2, STATS_SAMPLE_BLOCK_ROWS);
+        }
+
+        int rows = 0;
+        int res;
+        while ( (res = sqlite3_step(stmt)) == SQLITE_ROW ) {
+            collector.Add(sqlite3_column_value(stmt, 0));
+
+            if ( ++rows % STATS_STOP_CHECK_INTERVAL == 0 && stop.stop_requested() ) {
+                stopped = true;
+                break;
+            }
+        }
+
+        // Stats of part of the table would pass for the whole of it
+        if ( !stopped && res != SQLITE_DONE )
+            failed = true;
+
+        if ( stop.stop_requested() )
+            stopped = true;
+    }
+
+    sqlite3_finalize(stmt);
+    sqlite3_close(db);
+
+    if ( stopped || failed )
+        return false;
+
+    collector.Finish(stats);
+    return true;
+}
+
+bool DataStore::CommitEdits(const std::string& tableName, const EditJournal& journal, Changeset& undo) {
+    undo.clear();
+    if ( !this->m_connected || !TableExists(tableName) )
+        return false;
+
+    if ( journal.Empty() )
+        return true;
+
+    sqlite3_session* session = nullptr;
+    if ( sqlite3session_create(m_db, "main", &session) != SQLITE_OK )
+        return false;
+
+#ifdef SQLITE_SESSION_OBJCONFIG_ROWID
+    // Tables without an explicit PRIMARY KEY are only
+    // recorded when rowid tracking is turned on (3.44+).
+    int trackRowId = 1;
+    sqlite3session_object_config(session, SQLITE_SESSION_OBJCONFIG_ROWID, &trackRowId);
+#endif
+
+    if ( sqlite3session_attach(session, tableName.c_str()) != SQLITE_OK
+        || sqlite3_exec(m_db, "BEGIN IMMEDIATE;", NULL, NULL, NULL) != SQLITE_OK )
+    {
+        sqlite3session_delete(session);
+        return false;
+    }
+
+    // Rows edited in the same columns share the same SQL,
+    // so each statement shape is only prepared once.
+    std::unordered_map<std::string, sqlite3_stmt*> statements;
+    auto prepare = [this, &statements](const std::string& sql) -> sqlite3_stmt* {
+        auto it = statements.find(sql);
+        if ( it != statements.end() )
+            return it->second;
+
+        sqlite3_stmt* stmt = nullptr;
+        if ( sqlite3_prepare_v3(m_db, sql.c_str(), -1, SQLITE_PREPARE_PERSISTENT, &stmt, NULL) != SQLITE_OK )
+            return nullptr;
+
+        statements.emplace(sql, stmt);
+        return stmt;
+    };
+
+    auto execute = [](sqlite3_stmt* stmt) {
+        bool done = sqlite3_step(stmt) == SQLITE_DONE;
+        sqlite3_reset(stmt);
+        sqlite3_clear_bindings(stmt);
+        return done;
+    };
+
+    std::string table = QuoteIdentifier(tableName);
+    bool ok = true;
+
+    sqlite3_stmt* deleteStmt = journal.Deletes().empty() ? nullptr : prepare("DELETE FROM " + table + " WHERE rowid = ?;");
+    for ( sqlite3_int64 rowId : journal.Deletes() ) {
+        if ( !( ok = deleteStmt != nullptr ) )
+            break;
+
+        sqlite3_bind_int64(deleteStmt, 1, rowId);
+        if ( !( ok = execute(deleteStmt) ) )
+            break;
+    }
+
+    for ( auto it = journal.Updates().begin(); ok && it != journal.Updates().end(); ++it ) {
+        const auto& [rowId, row] = *it;
+
+        std::string sql = "UPDATE " + table + " SET ";
+        for ( auto col = row.begin(); col != row.end(); ++col )
+            sql += ( col == row.begin() ? "" : ", " ) + QuoteIdentifier(col->first) + " = ?";
+        sql += " WHERE rowid = ?;";
+
+        sqlite3_stmt* stmt = prepare(sql);
+        if ( !( ok = stmt != nullptr ) )
+            break;
+
+        int index = 1;
+        for ( const auto& [column, value] : row )
+            sqlite3_bind_text(stmt, index++, value.c_str(), static_cast<int>(value.size()), SQLITE_STATIC);
+        sqlite3_bind_int64(stmt, index, rowId);
+
+        ok = execute(stmt);
+    }
+
+    for ( auto it = journal.Inserts().begin(); ok && it != journal.Inserts().end(); ++it ) {
+        const EditJournal::Row& row = *it;
+
+        std::string sql = "INSERT INTO " + table;
+        if ( row.empty() ) {
+            sql += " DEFAULT VALUES;";
+        } else {
+            std::string names;
+            std::string params;
+            for ( auto col = row.begin(); col != row.end(); ++col ) {
+                names += ( col == row.begin() ? "" : ", " ) + QuoteIdentifier(col->first);
+                params += ( col == row.begin() ? "?" : ", ?" );
+            }
+            sql += " (" + names + ") VALUES (" + params + ");";
+        }
+
+        sqlite3_stmt* stmt = prepare(sql);
+        if ( !( ok = stmt != nullptr ) )
+            break;
+
+        int index = 1;
+        for ( const auto& [column, value] : row )
+            sqlite3_bind_text(stmt, index++, value.c_str(), static_cast<int>(value.size()), SQLITE_STATIC);
+
+        ok = execute(stmt);
+    }
+
+    for ( auto& [sql, stmt] : statements )
+        sqlite3_finalize(stmt);
+
+    if ( ok ) {
+        int size = 0;
+        void* changeset = nullptr;
+        if ( sqlite3session_changeset(session, &size, &changeset) == SQLITE_OK && changeset ) {
+            const unsigned char* bytes = static_cast<const unsigned char*>(changeset);
+            undo.assign(bytes, bytes + size);
+        }
+
+        sqlite3_free(changeset);
+    }
+
+    sqlite3session_delete(session);
+
+    if ( !ok || sqlite3_exec(m_db, "COMMIT;", NULL, NULL, NULL) != SQLITE_OK ) {
+        sqlite3_exec(m_db, "ROLLBACK;", NULL, NULL, NULL);
+        undo.clear();
+        return false;
+    }
+
+    return true;
+}
+
+bool DataStore::UndoChangeset(const Changeset& changeset) {
+    if ( !this->m_connected || changeset.empty() )
+        return false;
+
+    int size = 0;
+    void* inverted = nullptr;
+    if ( sqlite3changeset_invert(static_cast<int>(changeset.size()), const_cast<unsigned char*>(changeset.data()), &size, &inverted) != SQLITE_OK )
+        return false;
+
+    // Any conflict means the rows were modified after the commit being
+    // undone. Abort rather than clobbering those newer changes.
+    int res = sqlite3changeset_apply(
+        m_db, size, inverted,
+        NULL,
+        [](void*, int, sqlite3_changeset_iter*) { return SQLITE_CHANGESET_ABORT; },
+        NULL
+    );
+
+    sqlite3_free(inverted);
+    return res == SQLITE_OK;
+}
+
+bool DataStore::BackupTo(
+    const std::string& destPath,
+    const std::function<void(const BackupProgress&)>& onProgress,
+    std::stop_token stop
+)
+{
+    if ( !this->m_connected )
+        return false;
+
+    // Backing up onto the source itself would corrupt it. A copy in
+    // memory is written back to its file this way, unless it's an archive
+    std::error_code ec;
+    bool writeBack = this->m_profile.inMemory && !this->m_profile.compressedArchive;
+    if ( !writeBack && std::filesystem::equivalent(destPath, m_dbPath, ec) )
+        return false;
+
+    sqlite3* dest = nullptr;
+    if ( sqlite3_open(destPath.c_str(), &dest) != SQLITE_OK ) {
+        sqlite3_close(dest);
+        return false;
+    }
+
+    sqlite3_backup* backup = sqlite3_backup_init(dest, "main", m_db, "main");
+    if ( !backup ) {
+        sqlite3_close(dest);
+        return false;
+    }
+
+    // Page size only changes with VACUUM, read it once for throughput stats
+    sqlite3_int64 pageSize = 4096;
+    sqlite3_stmt* stmt;
+    if ( sqlite3_prepare_v2(m_db, "PRAGMA page_size;", -1, &stmt, NULL) == SQLITE_OK ) {
+        if ( sqlite3_step(stmt) == SQLITE_ROW )
+            pageSize = sqlite3_column_int64(stmt, 0);
+        sqlite3_finalize(stmt);
+    }
+
+    auto start = std::chrono::steady_clock::now();
+    BackupProgress progress;
+    int res;
+
+    // Between steps the source is unlocked. If another connection writes
+    // to it meanwhile, sqlite restarts the copy on the next step. Writes
+    // through m_db itself are copied over without a restart.
+    while ( true ) {
+        res = sqlite3_backup_step(backup, BACKUP_PAGES_PER_STEP);
+
+        if ( res == SQLITE_BUSY || res == SQLITE_LOCKED ) {
+            std::this_thread::sleep_for(BACKUP_BUSY_RETRY);
+        } else if ( res != SQLITE_OK ) {
+            break;
+        }
+
+        progress.totalPages = sqlite3_backup_pagecount(backup);
+        progress.remainingPages = sqlite3_backup_remaining(backup);
+        progress.totalBytes = static_cast<uint64_t>(progress.totalPages) * pageSize;
+        progress.bytesCopied = static_cast<uint64_t>(progress.totalPages - progress.remainingPages) * pageSize;
+        progress.elapsedSeconds = std::chrono::duration<double>(std::chrono::steady_clock::now() - start).count();
+
+        if ( onProgress )
+            onProgress(progress);
+
+        if ( stop.stop_requested() )
+            break;
+
+        std::this_thread::sleep_for(BACKUP_STEP_PAUSE);
+    }
+
+    // Report the final state once more, the loop exits before reporting SQLITE_DONE
+    if ( res == SQLITE_DONE && onProgress ) {
+        progress.totalPages = sqlite3_backup_pagecount(backup);
+        progress.remainingPages = 0;
+        progress.totalBytes = progress.bytesCopied = static_cast<uint64_t>(progress.totalPages) * pageSize;
+        progress.elapsedSeconds = std::chrono::duration<double>(std::chrono::steady_clock::now() - start).count();
+        onProgress(progress);
+    }
+
+    sqlite3_backup_finish(backup);
+    sqlite3_close(dest);
+    return res == SQLITE_DONE;
 }
 
-void DataStore::ExportTableToCSV(
-    const std::string& tableName, 
-    const std::string& outputFilename
-) 
+/**
+ * @brief Writes the data base as a compressed archive, see compressed_vfs.hxx.
+ *
+ * The archive is compressed from a VACUUM INTO copy rather than the data
+ * base itself, which may change meanwhile or have pages still in a WAL.
+ * Vacuuming also leaves out free pages, which would compress well but
+ * still cost reads. The copy is removed afterwards.
+ *
+ * @param destPath   Archive to write, replaced if it exists.
+ * @param onProgress Called as chunks are compressed.
+ * @param stop       Cancels the copy or compression, leaving no archive.
+ * @return true if the archive was written.
+ */
+bool DataStore::ExportCompressedArchive(
+    const std::string& destPath,
+    const std::function<void(const ArchiveProgress&)>& onProgress,
+    std::stop_token stop
+)
 {
+    if ( !this->m_connected || this->m_profile.compressedArchive )
+        return false;
 
+    std::error_code ec;
+    if ( std::filesystem::equivalent(destPath, m_dbPath, ec) )
+        return false;
+
+    sqlite3* db = OpenReadConnection();
+    if ( !db )
+        return false;
+
+    // VACUUM INTO has no progress of its own, the handler only lets it be cancelled
+    sqlite3_progress_handler(db, ARCHIVE_STOP_CHECK_OPS, [](void* data) -> int {
+        return static_cast<std::stop_token*>(data)->stop_requested() ? 1 : 0;
+    }, &stop);
+
+    std::string copyPath = destPath + ".vacuum";
+    std::filesystem::remove(copyPath, ec); // VACUUM INTO refuses to overwrite
+
+    sqlite3_stmt* stmt;
+    bool copied = false;
+    if ( sqlite3_prepare_v2(db, "VACUUM INTO ?;", -1, &stmt, NULL) == SQLITE_OK ) {
+        sqlite3_bind_text(stmt, 1, copyPath.c_str(), -1, SQLITE_TRANSIENT);
+        copied = sqlite3_step(stmt) == SQLITE_DONE;
+        sqlite3_finalize(stmt);
+    }
+    sqlite3_close(db);
+
+    bool ok = copied && CompressDatabaseFile(copyPath, destPath, onProgress, stop);
+    std::filesystem::remove(copyPath, ec);
+    return ok;
+}
+
+bool DataStore::ProfileQuery(const std::string& sql, QueryProfile& profile) {
+    profile = {};
+    if ( !this->m_connected )
+        return false;
+
+    using Clock = std::chrono::steady_clock;
+    auto start = Clock::now();
+
+    sqlite3_stmt* stmt;
+    if ( sqlite3_prepare_v2(m_db, sql.c_str(), -1, &stmt, NULL) != SQLITE_OK )
+        return false;
+
+    auto prepared = Clock::now();
+
+    int res;
+    while ( ( res = sqlite3_step(stmt) ) == SQLITE_ROW )
+        profile.rows++;
+
+    auto finished = Clock::now();
+
+    profile.prepareMs = std::chrono::duration<double, std::milli>(prepared - start).count();
+    profile.executeMs = std::chrono::duration<double, std::milli>(finished - prepared).count();
+    profile.vmSteps = sqlite3_stmt_status(stmt, SQLITE_STMTSTATUS_VM_STEP, 0);
+    profile.fullScanSteps = sqlite3_stmt_status(stmt, SQLITE_STMTSTATUS_FULLSCAN_STEP, 0);
+    profile.sorts = sqlite3_stmt_status(stmt, SQLITE_STMTSTATUS_SORT, 0);
+    profile.autoIndexes = sqlite3_stmt_status(stmt, SQLITE_STMTSTATUS_AUTOINDEX, 0);
+
+    sqlite3_finalize(stmt);
+    return res == SQLITE_DONE;
+}
+
+std::string DataStore::QuoteIdentifier(const std::string& name) {
+    std::string quoted = "\"";
+    for ( char c : name ) {
+        if ( c == '"' )
+            quoted += '"';
+        quoted += c;
+    }
+
+    quoted += '"';
+    return quoted;
+}
+
+sqlite3* DataStore::OpenReadConnection() const {
+    if ( !this->m_connected )
+        return nullptr;
+
+    // m_readPath is a URI when it isn't the file's path: the memdb name of
+    // an in-memory copy, or the file with parameters such as immutable=1
+    int flags = SQLITE_OPEN_READONLY | SQLITE_OPEN_NOMUTEX;
+    if ( m_readPath != m_dbPath )
+        flags |= SQLITE_OPEN_URI;
+
+    sqlite3* db = nullptr;
+    if ( sqlite3_open_v2(m_readPath.c_str(), &db, flags, this->VfsName()) != SQLITE_OK ) {
+        sqlite3_close(db);
+        return nullptr;
+    }
+
+    return db;
+}
+
+const char* DataStore::VfsName() const {
+    if ( this->m_profile.compressedArchive )
+        return RegisterCompressedVfs();
+    return this->m_profile.readAhead ? RegisterReadAheadVfs() : RegisterIoStatsVfs();
 }
 
 bool DataStore::TableExists(const std::string& tableName) {
-    std::string query = "SELECT name FROM sqlite_master WHERE type='table' AND name='" + tableName + "';";
+    const char* query = "SELECT name FROM sqlite_master WHERE type='table' AND name=?;";
     sqlite3_stmt* stmt;
 
-    int res = sqlite3_prepare_v2(m_db, query.c_str(), -1, &stmt, NULL);
+    int res = sqlite3_prepare_v2(m_db, query, -1, &stmt, NULL);
     if ( res != SQLITE_OK )
         return false;
 
+    sqlite3_bind_text(stmt, 1, tableName.c_str(), -1, SQLITE_TRANSIENT);
+
     // No rows with name 'tableName', means 
     // table doesn't exist.
     if ( sqlite3_step(stmt) != SQLITE_ROW ) {
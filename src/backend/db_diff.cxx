@@ -0,0 +1,424 @@
+// Backend
+#include "backend/db_diff.hxx"
+#include "backend/data_store.hxx"
+
+// SQLite
+#include "ext/sqlite3.h"
+
+// STD
+#include <algorithm>
+#include <atomic>
+#include <cstring>
+#include <map>
+#include <mutex>
+#include <thread>
+
+namespace {
+    constexpr int STOP_CHECK_INTERVAL = 4096; // Rows between checks for a stop request
+
+    struct TableShape {
+        std::vector<std::string> columns;
+        std::vector<std::string> keyColumns; // Primary key in key order, or rowid
+        std::string signature; // Names, types and key positions, to detect schema changes
+    };
+
+    sqlite3* OpenReadOnly(const std::string& path) {
+        sqlite3* db = nullptr;
+        const char* vfs = IsCompressedArchive(path) ? RegisterCompressedVfs() : nullptr;
+        if ( sqlite3_open_v2(path.c_str(), &db, SQLITE_OPEN_READONLY | SQLITE_OPEN_NOMUTEX, vfs) != SQLITE_OK ) {
+            sqlite3_close(db);
+            return nullptr;
+        }
+        return db;
+    }
+
+    std::vector<std::string> ReadTableNames(sqlite3* db) {
+        std::vector<std::string> names;
+        sqlite3_stmt* stmt;
+        const char* query = "SELECT name FROM sqlite_master WHERE type='table' AND name NOT LIKE 'sqlite_%' ORDER BY name;";
+        if ( sqlite3_prepare_v2(db, query, -1, &stmt, NULL) != SQLITE_OK )
+            return names;
+
+        while ( sqlite3_step(stmt) == SQLITE_ROW )
+            names.emplace_back(reinterpret_cast<const char*>(sqlite3_column_text(stmt, 0)));
+
+        sqlite3_finalize(stmt);
+        return names;
+    }
+
+    bool ReadTableShape(sqlite3* db, const std::string& table, TableShape& shape) {
+        sqlite3_stmt* stmt;
+        if ( sqlite3_prepare_v2(db, "SELECT name, type, pk FROM pragma_table_info(?) ORDER BY cid;", -1, &stmt, NULL) != SQLITE_OK )
+            return false;
+
+        sqlite3_bind_text(stmt, 1, table.c_str(), -1, SQLITE_TRANSIENT);
+
+        std::map<int, std::string> keyColumns;
+        while ( sqlite3_step(stmt) == SQLITE_ROW ) {
+            std::string name = reinterpret_cast<const char*>(sqlite3_column_text(stmt, 0));
+            std::string type = reinterpret_cast<const char*>(sqlite3_column_text(stmt, 1));
+            int pk = sqlite3_column_int(stmt, 2);
+
+            shape.columns.push_back(name);
+            shape.signature += name + '\x1F' + type + '\x1F' + std::to_string(pk) + '\x1E';
+            if ( pk > 0 )
+                keyColumns[pk] = name;
+        }
+        sqlite3_finalize(stmt);
+
+        for ( auto& [position, name] : keyColumns )
+            shape.keyColumns.push_back(name);
+        if ( shape.keyColumns.empty() )
+            shape.keyColumns.push_back("rowid");
+
+        return !shape.columns.empty();
+    }
+
+    // Appends a value tagged with its storage class, so the integer 1
+    // and the text '1' serialize differently.
+    void AppendValue(std::string& out, sqlite3_stmt* stmt, int col) {
+        switch ( sqlite3_column_type(stmt, col) ) {
+        case SQLITE_INTEGER: {
+            sqlite3_int64 value = sqlite3_column_int64(stmt, col);
+            out += 'i';
+            out.append(reinterpret_cast<const char*>(&value), sizeof(value));
+            break;
+        }
+        case SQLITE_FLOAT: {
+            double value = sqlite3_column_double(stmt, col);
+            out += 'f';
+            out.append(reinterpret_cast<const char*>(&value), sizeof(value));
+            break;
+        }
+        case SQLITE_NULL:
+            out += 'n';
+            break;
+        default: {
+            bool isText = sqlite3_column_type(stmt, col) == SQLITE_TEXT;
+            const void* data = isText ? static_cast<const void*>(sqlite3_column_text(stmt, col)) : sqlite3_column_blob(stmt, col);
+            uint32_t length = static_cast<uint32_t>(sqlite3_column_bytes(stmt, col));
+            out += isText ? 't' : 'b';
+            out.append(reinterpret_cast<const char*>(&length), sizeof(length));
+            if ( length )
+                out.append(static_cast<const char*>(data), length);
+            break;
+        }
+        }
+    }
+
+    std::string FormatKey(sqlite3_stmt* stmt, int keyCount) {
+        std::string text;
+        for ( int col = 0; col < keyCount; col++ ) {
+            if ( col )
+                text += ", ";
+
+            if ( sqlite3_column_type(stmt, col) == SQLITE_NULL )
+                text += "NULL";
+            else if ( sqlite3_column_type(stmt, col) == SQLITE_BLOB )
+                text += "<BLOB " + std::to_string(sqlite3_column_bytes(stmt, col)) + " bytes>";
+            else
+                text += reinterpret_cast<const char*>(sqlite3_column_text(stmt, col));
+        }
+        return text;
+    }
+
+    // Rank of a storage class in ORDER BY: NULL, numbers, text, BLOBs
+    int TypeRank(int type) {
+        switch ( type ) {
+        case SQLITE_NULL: return 0;
+        case SQLITE_INTEGER:
+        case SQLITE_FLOAT: return 1;
+        case SQLITE_TEXT: return 2;
+        default: return 3;
+        }
+    }
+
+    // Orders column 'col' of the current rows of 'a' and 'b' the way
+    // ORDER BY ... COLLATE BINARY does, so both cursors can be merged
+    int CompareValues(sqlite3_stmt* a, sqlite3_stmt* b, int col) {
+        int typeA = sqlite3_column_type(a, col);
+        int typeB = sqlite3_column_type(b, col);
+        if ( TypeRank(typeA) != TypeRank(typeB) )
+            return TypeRank(typeA) < TypeRank(typeB) ? -1 : 1;
+
+        switch ( TypeRank(typeA) ) {
+        case 0:
+            return 0;
+        case 1: {
+            if ( typeA == SQLITE_INTEGER && typeB == SQLITE_INTEGER ) {
+                sqlite3_int64 x = sqlite3_column_int64(a, col);
+                sqlite3_int64 y = sqlite3_column_int64(b, col);
+                return x < y ? -1 : x > y;
+            }
+
+            double x = sqlite3_column_double(a, col);
+            double y = sqlite3_column_double(b, col);
+            return x < y ? -1 : x > y;
+        }
+        default: {
+            bool isText = typeA == SQLITE_TEXT;
+            const void* x = isText ? static_cast<const void*>(sqlite3_column_text(a, col)) : sqlite3_column_blob(a, col);
+            const void* y = isText ? static_cast<const void*>(sqlite3_column_text(b, col)) : sqlite3_column_blob(b, col);
+            int lengthX = sqlite3_column_bytes(a, col);
+            int lengthY = sqlite3_column_bytes(b, col);
+
+            int order = std::min(lengthX, lengthY) ? std::memcmp(x, y, std::min(lengthX, lengthY)) : 0;
+            if ( order == 0 )
+                return lengthX < lengthY ? -1 : lengthX > lengthY;
+            return order < 0 ? -1 : 1;
+        }
+        }
+    }
+
+    /*
+        Compares one table that exists with the same shape in both data bases.
+    */
+    class TableDiffer {
+    public:
+        TableDiffer(sqlite3* oldDb, sqlite3* newDb, const TableShape& shape, TableDiff& diff, std::stop_token stop)
+            : m_oldDb(oldDb), m_newDb(newDb), m_shape(shape), m_diff(diff), m_stop(stop)
+        {
+            for ( const std::string& key : shape.keyColumns )
+                m_keyList += ( m_keyList.empty() ? "" : ", " ) + DataStore::QuoteIdentifier(key);
+
+            m_rowList = m_keyList;
+            for ( const std::string& column : shape.columns )
+                m_rowList += ", " + DataStore::QuoteIdentifier(column);
+        }
+
+        /*
+            Reads both sides in key order, side by side, advancing whichever
+            is behind. A key on one side only is an insert or a delete, a key
+            on both sides is an update if the rest of the row differs.
+        */
+        bool Run() {
+            sqlite3_stmt* oldStmt = Prepare(m_oldDb);
+            sqlite3_stmt* newStmt = Prepare(m_newDb);
+            bool compared = oldStmt && newStmt && Merge(oldStmt, newStmt);
+
+            sqlite3_finalize(oldStmt);
+            sqlite3_finalize(newStmt);
+            return compared;
+        }
+    private:
+        int KeyCount() const { return static_cast<int>(m_shape.keyColumns.size()); }
+
+        // Every key column is ordered by BINARY, which is what CompareValues
+        // implements. For keys declared with BINARY, the default, this still
+        // walks the primary key index instead of sorting
+        sqlite3_stmt* Prepare(sqlite3* db) const {
+            std::string order;
+            for ( const std::string& key : m_shape.keyColumns )
+                order += ( order.empty() ? "" : ", " ) + DataStore::QuoteIdentifier(key) + " COLLATE BINARY";
+
+            std::string query = "SELECT " + m_rowList + " FROM " + DataStore::QuoteIdentifier(m_diff.table) + " ORDER BY " + order + ";";
+            sqlite3_stmt* stmt;
+            if ( sqlite3_prepare_v2(db, query.c_str(), -1, &stmt, NULL) != SQLITE_OK )
+                return nullptr;
+            return stmt;
+        }
+
+        bool Step(sqlite3_stmt* stmt, int& res) {
+            if ( m_diff.rowsRead % STOP_CHECK_INTERVAL == 0 && m_stop.stop_requested() ) {
+                res = SQLITE_INTERRUPT;
+                return false;
+            }
+
+            res = sqlite3_step(stmt);
+            if ( res != SQLITE_ROW )
+                return false;
+
+            m_diff.rowsRead++;
+            return true;
+        }
+
+        int CompareKeys(sqlite3_stmt* oldStmt, sqlite3_stmt* newStmt) const {
+            for ( int col = 0; col < KeyCount(); col++ ) {
+                int order = CompareValues(oldStmt, newStmt, col);
+                if ( order )
+                    return order;
+            }
+            return 0;
+        }
+
+        // Serializes the non-key columns of the current row into 'out'
+        void SerializeRow(sqlite3_stmt* stmt, std::string& out) const {
+            out.clear();
+            int columnCount = sqlite3_column_count(stmt);
+            for ( int col = KeyCount(); col < columnCount; col++ )
+                AppendValue(out, stmt, col);
+        }
+
+        bool Merge(sqlite3_stmt* oldStmt, sqlite3_stmt* newStmt) {
+            int oldRes = SQLITE_DONE;
+            int newRes = SQLITE_DONE;
+            bool oldRow = Step(oldStmt, oldRes);
+            bool newRow = Step(newStmt, newRes);
+
+            while ( oldRow || newRow ) {
+                int order = !oldRow ? 1 : !newRow ? -1 : CompareKeys(oldStmt, newStmt);
+                if ( order < 0 ) {
+                    AddChange(RowChange::Kind::Deleted, FormatKey(oldStmt, KeyCount()));
+                    oldRow = Step(oldStmt, oldRes);
+                    continue;
+                }
+
+                if ( order > 0 ) {
+                    AddChange(RowChange::Kind::Inserted, FormatKey(newStmt, KeyCount()));
+                    newRow = Step(newStmt, newRes);
+                    continue;
+                }
+
+                // Comparing the serialized rows rather than hashes of them can't miss a change
+                SerializeRow(oldStmt, m_oldBuffer);
+                SerializeRow(newStmt, m_newBuffer);
+                if ( m_oldBuffer != m_newBuffer )
+                    AddChange(RowChange::Kind::Updated, FormatKey(oldStmt, KeyCount()));
+
+                oldRow = Step(oldStmt, oldRes);
+                newRow = Step(newStmt, newRes);
+            }
+
+            return oldRes == SQLITE_DONE && newRes == SQLITE_DONE;
+        }
+
+        void AddChange(RowChange::Kind kind, std::string key) {
+            if ( kind == RowChange::Kind::Inserted )
+                m_diff.inserted++;
+            else if ( kind == RowChange::Kind::Deleted )
+                m_diff.deleted++;
+            else
+                m_diff.updated++;
+
+            if ( m_diff.changes.size() < TableDiff::MAX_LISTED_CHANGES )
+                m_diff.changes.push_back({ kind, std::move(key) });
+        }
+
+        sqlite3* m_oldDb;
+        sqlite3* m_newDb;
+        const TableShape& m_shape;
+        TableDiff& m_diff;
+        std::stop_token m_stop;
+        std::string m_keyList; // Quoted key columns, comma separated
+        std::string m_rowList; // Key columns followed by every column
+        std::string m_oldBuffer; // Serialized rows, reused between rows
+        std::string m_newBuffer;
+    };
+
+    uint64_t CountRows(sqlite3* db, const std::string& table) {
+        uint64_t count = 0;
+        sqlite3_stmt* stmt;
+        std::string query = "SELECT count(*) FROM " + DataStore::QuoteIdentifier(table) + ";";
+        if ( sqlite3_prepare_v2(db, query.c_str(), -1, &stmt, NULL) == SQLITE_OK ) {
+            if ( sqlite3_step(stmt) == SQLITE_ROW )
+                count = static_cast<uint64_t>(sqlite3_column_int64(stmt, 0));
+            sqlite3_finalize(stmt);
+        }
+        return count;
+    }
+
+    struct TableJob {
+        std::string table;
+        bool inOld;
+        bool inNew;
+    };
+
+    TableDiff DiffTable(sqlite3* oldDb, sqlite3* newDb, const TableJob& job, std::stop_token stop) {
+        TableDiff diff;
+        diff.table = job.table;
+
+        if ( !job.inNew ) {
+            diff.status = TableDiff::Status::Removed;
+            diff.deleted = CountRows(oldDb, job.table);
+            return diff;
+        }
+
+        if ( !job.inOld ) {
+            diff.status = TableDiff::Status::Added;
+            diff.inserted = CountRows(newDb, job.table);
+            return diff;
+        }
+
+        TableShape oldShape, newShape;
+        if ( !ReadTableShape(oldDb, job.table, oldShape) || !ReadTableShape(newDb, job.table, newShape) ) {
+            diff.status = TableDiff::Status::Failed;
+            return diff;
+        }
+
+        if ( oldShape.signature != newShape.signature ) {
+            diff.status = TableDiff::Status::SchemaChanged;
+            return diff;
+        }
+
+        if ( !TableDiffer(oldDb, newDb, oldShape, diff, stop).Run() ) {
+            diff.status = TableDiff::Status::Failed;
+            return diff;
+        }
+
+        bool changed = diff.inserted || diff.deleted || diff.updated;
+        diff.status = changed ? TableDiff::Status::Changed : TableDiff::Status::Identical;
+        return diff;
+    }
+}
+
+bool DiffDatabases(
+    const std::string& oldPath,
+    const std::string& newPath,
+    const std::function<void(const TableDiff&)>& onTable,
+    std::stop_token stop)
+{
+    sqlite3* oldDb = OpenReadOnly(oldPath);
+    sqlite3* newDb = OpenReadOnly(newPath);
+    std::vector<std::string> oldTables = oldDb ? ReadTableNames(oldDb) : std::vector<std::string>();
+    std::vector<std::string> newTables = newDb ? ReadTableNames(newDb) : std::vector<std::string>();
+    bool opened = oldDb && newDb;
+    sqlite3_close(oldDb);
+    sqlite3_close(newDb);
+
+    if ( !opened )
+        return false;
+
+    // Both lists are sorted by name, merge them into one job per table
+    std::vector<TableJob> jobs;
+    size_t o = 0, n = 0;
+    while ( o < oldTables.size() || n < newTables.size() ) {
+        if ( n == newTables.size() || ( o < oldTables.size() && oldTables[o] < newTables[n] ) )
+            jobs.push_back({ oldTables[o++], true, false });
+        else if ( o == oldTables.size() || newTables[n] < oldTables[o] )
+            jobs.push_back({ newTables[n++], false, true });
+        else {
+            jobs.push_back({ oldTables[o++], true, true });
+            n++;
+        }
+    }
+
+    std::atomic<size_t> nextJob = 0;
+    std::mutex callbackMutex;
+
+    auto worker = [&]() {
+        sqlite3* oldDb = OpenReadOnly(oldPath);
+        sqlite3* newDb = OpenReadOnly(newPath);
+
+        for ( size_t job = nextJob++; oldDb && newDb && job < jobs.size() && !stop.stop_requested(); job = nextJob++ ) {
+            TableDiff diff = DiffTable(oldDb, newDb, jobs[job], stop);
+            if ( stop.stop_requested() )
+                break;
+
+            std::lock_guard<std::mutex> lock(callbackMutex);
+            onTable(diff);
+        }
+
+        sqlite3_close(oldDb);
+        sqlite3_close(newDb);
+    };
+
+    size_t threadCount = std::min<size_t>(std::max(1u, std::thread::hardware_concurrency()), jobs.size());
+    std::vector<std::jthread> threads;
+    for ( size_t i = 1; i < threadCount; i++ )
+        threads.emplace_back(worker);
+
+    worker(); // the calling thread works too
+    threads.clear(); // joins
+
+    return !stop.stop_requested();
+}
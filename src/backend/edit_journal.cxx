@@ -0,0 +1,39 @@
+// Backend
+#include "backend/edit_journal.hxx"
+
+void EditJournal::SetCell(sqlite3_int64 rowId, const std::string& column, const std::string& value) {
+    if ( m_deletes.count(rowId) )
+        return;
+
+    m_updates[rowId][column] = value;
+}
+
+void EditJournal::DeleteRow(sqlite3_int64 rowId) {
+    m_updates.erase(rowId);
+    m_deletes.insert(rowId);
+}
+
+size_t EditJournal::AddRow() {
+    m_inserts.emplace_back();
+    return m_inserts.size() - 1;
+}
+
+void EditJournal::SetNewRowCell(size_t index, const std::string& column, const std::string& value) {
+    if ( index >= m_inserts.size() )
+        return;
+
+    m_inserts[index][column] = value;
+}
+
+void EditJournal::RemoveNewRow(size_t index) {
+    if ( index >= m_inserts.size() )
+        return;
+
+    m_inserts.erase(m_inserts.begin() + index);
+}
+
+void EditJournal::Clear() {
+    m_updates.clear();
+    m_inserts.clear();
+    m_deletes.clear();
+}
@@ -0,0 +1,230 @@
+// Backend
+#include "backend/gzip_stream.hxx"
+
+// zlib
+#include <zlib.h>
+
+// STD
+#include <algorithm>
+
+namespace {
+    constexpr size_t DICTIONARY_SIZE = 32 * 1024; // deflate's window
+    constexpr unsigned char GZIP_HEADER[] = { 0x1F, 0x8B, 8, 0, 0, 0, 0, 0, 0, 255 }; // deflate, no name or time, unknown OS
+
+    void PutLittleEndian(std::ostream& out, uint32_t value) {
+        char bytes[4] = {
+            static_cast<char>(value), static_cast<char>(value >> 8),
+            static_cast<char>(value >> 16), static_cast<char>(value >> 24)
+        };
+        out.write(bytes, sizeof(bytes));
+    }
+}
+
+struct GzipStreamBuf::Block {
+    std::string input;
+    std::string dictionary; // Input just before this block, the window it is compressed against
+    std::string output; // Raw deflate data, ending on a byte boundary
+    uint32_t crc = 0; // CRC-32 of 'input'
+    bool last = false;
+    bool done = false;
+    bool failed = false;
+};
+
+/**
+ * @brief Writes the gzip header and starts the workers.
+ *
+ * @param out     Receives the compressed stream. Must outlive the buffer.
+ * @param level   zlib compression level, 1 to 9.
+ * @param threads Compression threads, 0 for one per core.
+ */
+GzipStreamBuf::GzipStreamBuf(std::ostream& out, int level, unsigned threads)
+    : m_out(out), m_level(level), m_input(BLOCK_SIZE, '\0'), m_crc(crc32(0, Z_NULL, 0))
+{
+    setp(m_input.data(), m_input.data() + m_input.size());
+    m_out.write(reinterpret_cast<const char*>(GZIP_HEADER), sizeof(GZIP_HEADER));
+
+    if ( threads == 0 )
+        threads = std::max(1u, std::thread::hardware_concurrency());
+    for ( unsigned i = 0; i < threads; i++ )
+        m_workers.emplace_back([this](std::stop_token stop) { Work(stop); });
+}
+
+GzipStreamBuf::~GzipStreamBuf() {
+    Finish();
+}
+
+/**
+ * @brief Compresses what is left and writes the gzip trailer.
+ *
+ * Nothing can be written to the stream afterwards.
+ *
+ * @return false if compressing or writing to the output failed at any point.
+ */
+bool GzipStreamBuf::Finish() {
+    if ( m_finished )
+        return m_ok;
+
+    Submit(true);
+    WriteFinished(0);
+    m_finished = true;
+    setp(nullptr, nullptr);
+
+    PutLittleEndian(m_out, m_crc);
+    PutLittleEndian(m_out, static_cast<uint32_t>(m_size)); // ISIZE is the size modulo 2^32
+    m_out.flush();
+    m_ok = m_ok && m_out.good();
+    return m_ok;
+}
+
+GzipStreamBuf::int_type GzipStreamBuf::overflow(int_type c) {
+    if ( m_finished || !m_ok )
+        return traits_type::eof();
+
+    Submit(false);
+    WriteFinished(m_workers.size() * MAX_BLOCKS_PER_THREAD);
+
+    if ( !traits_type::eq_int_type(c, traits_type::eof()) ) {
+        *pptr() = traits_type::to_char_type(c);
+        pbump(1);
+    }
+    return m_ok ? traits_type::not_eof(c) : traits_type::eof();
+}
+
+/**
+ * @brief Compresses the partial block and waits until everything is written out.
+ *
+ * Cutting a block short costs a little ratio, so exporters only
+ * flush once, when they are done.
+ */
+int GzipStreamBuf::sync() {
+    if ( m_finished )
+        return m_ok ? 0 : -1;
+
+    if ( pptr() > pbase() )
+        Submit(false);
+    WriteFinished(0);
+    m_out.flush();
+    return m_ok && m_out.good() ? 0 : -1;
+}
+
+void GzipStreamBuf::Submit(bool last) {
+    size_t size = pptr() - pbase();
+    auto block = std::make_shared<Block>();
+    block->input = std::move(m_input);
+    block->input.resize(size);
+    block->dictionary = std::move(m_dictionary);
+    block->last = last;
+
+    size_t tail = std::min(DICTIONARY_SIZE, block->input.size());
+    m_dictionary.assign(block->input, block->input.size() - tail, tail);
+    if ( tail < DICTIONARY_SIZE ) // A short block, keep what came before it too
+        m_dictionary.insert(0, block->dictionary, block->dictionary.size() - std::min(block->dictionary.size(), DICTIONARY_SIZE - tail));
+
+    m_input.assign(BLOCK_SIZE, '\0');
+    setp(m_input.data(), m_input.data() + m_input.size());
+
+    {
+        std::lock_guard<std::mutex> lock(m_mutex);
+        m_blocks.push_back(block);
+        m_work.push_back(std::move(block));
+    }
+    m_queued.notify_one();
+}
+
+void GzipStreamBuf::WriteFinished(size_t maxQueued) {
+    std::unique_lock<std::mutex> lock(m_mutex);
+    while ( !m_blocks.empty() ) {
+        std::shared_ptr<Block> block = m_blocks.front();
+        if ( !block->done ) {
+            if ( m_blocks.size() <= maxQueued )
+                break;
+            m_compressed.wait(lock);
+            continue;
+        }
+
+        m_blocks.pop_front();
+        lock.unlock();
+
+        m_ok = m_ok && !block->failed;
+        if ( m_ok ) {
+            m_out.write(block->output.data(), block->output.size());
+            m_ok = m_out.good();
+        }
+        m_crc = crc32_combine(m_crc, block->crc, static_cast<z_off_t>(block->input.size()));
+        m_size += block->input.size();
+
+        lock.lock();
+    }
+}
+
+/**
+ * @brief Compresses queued blocks until the buffer is destroyed.
+ *
+ * Each worker keeps one deflate stream, reset for every block. Blocks other
+ * than the last end with a sync flush, which pads them to a byte boundary
+ * with an empty stored block, so they can be written back to back.
+ */
+void GzipStreamBuf::Work(std::stop_token stop) {
+    z_stream stream = {};
+    bool initialized = deflateInit2(&stream, m_level, Z_DEFLATED, -MAX_WBITS, 8, Z_DEFAULT_STRATEGY) == Z_OK;
+
+    while ( true ) {
+        std::shared_ptr<Block> block;
+        {
+            std::unique_lock<std::mutex> lock(m_mutex);
+            if ( !m_queued.wait(lock, stop, [this]() { return !m_work.empty(); }) )
+                break;
+            block = std::move(m_work.front());
+            m_work.pop_front();
+        }
+
+        bool ok = initialized && deflateReset(&stream) == Z_OK;
+        if ( ok && !block->dictionary.empty() )
+            ok = deflateSetDictionary(&stream, reinterpret_cast<const Bytef*>(block->dictionary.data()), static_cast<uInt>(block->dictionary.size())) == Z_OK;
+
+        if ( ok ) {
+            block->output.resize(deflateBound(&stream, static_cast<uLong>(block->input.size())) + 16);
+            stream.next_in = reinterpret_cast<Bytef*>(block->input.data());
+            stream.avail_in = static_cast<uInt>(block->input.size());
+            stream.next_out = reinterpret_cast<Bytef*>(block->output.data());
+            stream.avail_out = static_cast<uInt>(block->output.size());
+
+            int res = deflate(&stream, block->last ? Z_FINISH : Z_SYNC_FLUSH);
+            ok = ( block->last ? res == Z_STREAM_END : res == Z_OK && stream.avail_out > 0 ) && stream.avail_in == 0;
+            block->output.resize(block->output.size() - stream.avail_out);
+            block->crc = crc32(crc32(0, Z_NULL, 0), reinterpret_cast<const Bytef*>(block->input.data()), static_cast<uInt>(block->input.size()));
+        }
+
+        {
+            std::lock_guard<std::mutex> lock(m_mutex);
+            block->failed = !ok;
+            block->done = true;
+        }
+        m_compressed.notify_all();
+    }
+
+    if ( initialized )
+        deflateEnd(&stream);
+}
+
+/**
+ * @brief Creates a stream compressing into 'out'.
+ *
+ * @param out     Receives the gzip data. Must outlive the stream.
+ * @param level   zlib compression level, 1 to 9.
+ * @param threads Compression threads, 0 for one per core.
+ */
+GzipOStream::GzipOStream(std::ostream& out, int level, unsigned threads)
+    : std::ostream(nullptr), m_buffer(out, level, threads)
+{
+    rdbuf(&m_buffer);
+}
+
+bool GzipOStream::Close() {
+    flush();
+    return m_buffer.Finish() && good();
+}
+
+bool IsGzipPath(const std::string& path) {
+    return path.size() > 3 && path.compare(path.size() - 3, 3, ".gz") == 0;
+}
@@ -0,0 +1,391 @@
+// Backend
+#include "backend/data_store.hxx"
+#include "backend/columnar_export.hxx"
+#include "backend/gzip_stream.hxx"
+
+// STD
+#include <charconv>
+#include <cmath>
+#include <fstream>
+#include <functional>
+#include <istream>
+#include <ostream>
+#include <string_view>
+
+namespace {
+    constexpr size_t WRITE_BUFFER_SIZE = 1 << 16; // Formatted rows are flushed to the stream in blocks this large
+    constexpr size_t READ_BUFFER_SIZE = 1 << 16;
+    constexpr size_t FILE_BUFFER_SIZE = 1 << 20;
+
+    void AppendHex(std::string& out, const void* data, int length) {
+        static const char digits[] = "0123456789ABCDEF";
+        const unsigned char* bytes = static_cast<const unsigned char*>(data);
+
+        for ( int i = 0; i < length; i++ ) {
+            out += digits[bytes[i] >> 4];
+            out += digits[bytes[i] & 0xF];
+        }
+    }
+
+    // Shortest text that reads back as the same double, as SQLite's own
+    // conversion keeps only 15 digits. JSON has no literal for infinity,
+    // so it gets a string there, CSV gets a literal SQLite reads back as it
+    void AppendReal(std::string& out, double value, ExportFormat format) {
+        if ( std::isinf(value) ) {
+            if ( format == ExportFormat::JSON )
+                out += value < 0 ? "\"-Infinity\"" : "\"Infinity\"";
+            else
+                out += value < 0 ? "-1e999" : "1e999";
+            return;
+        }
+        if ( std::isnan(value) ) {
+            if ( format == ExportFormat::JSON )
+                out += "null";
+            return;
+        }
+
+        char text[32];
+        char* end = std::to_chars(text, text + sizeof(text), value).ptr;
+        out.append(text, end);
+        if ( std::string_view(text, end - text).find_first_of(".e") == std::string_view::npos )
+            out += ".0";
+    }
+
+    void AppendCSVField(std::string& out, const char* text, int length) {
+        bool needsQuotes = false;
+        for ( int i = 0; i < length && !needsQuotes; i++ )
+            needsQuotes = text[i] == ',' || text[i] == '"' || text[i] == '\n' || text[i] == '\r';
+
+        if ( !needsQuotes ) {
+            out.append(text, length);
+            return;
+        }
+
+        out += '"';
+        for ( int i = 0; i < length; i++ ) {
+            if ( text[i] == '"' )
+                out += '"';
+            out += text[i];
+        }
+        out += '"';
+    }
+
+    void AppendJSONString(std::string& out, const char* text, int length) {
+        static const char digits[] = "0123456789abcdef";
+
+        out += '"';
+        for ( int i = 0; i < length; i++ ) {
+            unsigned char c = static_cast<unsigned char>(text[i]);
+            switch ( c ) {
+            case '"':  out += "\\\""; break;
+            case '\\': out += "\\\\"; break;
+            case '\n': out += "\\n"; break;
+            case '\r': out += "\\r"; break;
+            case '\t': out += "\\t"; break;
+            default:
+                if ( c < 0x20 ) {
+                    out += "\\u00";
+                    out += digits[c >> 4];
+                    out += digits[c & 0xF];
+                } else {
+                    out += static_cast<char>(c);
+                }
+            }
+        }
+        out += '"';
+    }
+
+    /**
+     * @brief Steps 'stmt' to completion, writing every row to 'out' in 'format'.
+     *
+     * Rows are formatted into a reusable buffer which is written out in
+     * WRITE_BUFFER_SIZE blocks, so memory use doesn't depend on the row count.
+     */
+    bool WriteRows(sqlite3_stmt* stmt, std::ostream& out, ExportFormat format) {
+        int columnCount = sqlite3_column_count(stmt);
+        std::vector<std::string> names;
+        for ( int col = 0; col < columnCount; col++ )
+            names.emplace_back(sqlite3_column_name(stmt, col));
+
+        std::string buffer;
+        buffer.reserve(WRITE_BUFFER_SIZE * 2);
+
+        if ( format == ExportFormat::CSV ) {
+            for ( int col = 0; col < columnCount; col++ ) {
+                if ( col > 0 )
+                    buffer += ',';
+                AppendCSVField(buffer, names[col].c_str(), static_cast<int>(names[col].size()));
+            }
+            buffer += "\r\n";
+        } else {
+            buffer += "[";
+        }
+
+        bool firstRow = true;
+        int res;
+        while ( ( res = sqlite3_step(stmt) ) == SQLITE_ROW ) {
+            if ( format == ExportFormat::JSON ) {
+                buffer += firstRow ? "\n{" : ",\n{";
+                firstRow = false;
+            }
+
+            for ( int col = 0; col < columnCount; col++ ) {
+                if ( format == ExportFormat::JSON ) {
+                    if ( col > 0 )
+                        buffer += ',';
+                    AppendJSONString(buffer, names[col].c_str(), static_cast<int>(names[col].size()));
+                    buffer += ':';
+                } else if ( col > 0 ) {
+                    buffer += ',';
+                }
+
+                int type = sqlite3_column_type(stmt, col);
+                switch ( type ) {
+                case SQLITE_NULL:
+                    if ( format == ExportFormat::JSON )
+                        buffer += "null";
+                    break;
+                case SQLITE_INTEGER:
+                    buffer += reinterpret_cast<const char*>(sqlite3_column_text(stmt, col));
+                    break;
+                case SQLITE_FLOAT:
+                    AppendReal(buffer, sqlite3_column_double(stmt, col), format);
+                    break;
+                case SQLITE_TEXT: {
+                    const char* text = reinterpret_cast<const char*>(sqlite3_column_text(stmt, col));
+                    int length = sqlite3_column_bytes(stmt, col);
+                    if ( format == ExportFormat::JSON )
+                        AppendJSONString(buffer, text, length);
+                    else
+                        AppendCSVField(buffer, text, length);
+                    break;
+                }
+                case SQLITE_BLOB: {
+                    if ( format == ExportFormat::JSON )
+                        buffer += '"';
+                    AppendHex(buffer, sqlite3_column_blob(stmt, col), sqlite3_column_bytes(stmt, col));
+                    if ( format == ExportFormat::JSON )
+                        buffer += '"';
+                    break;
+                }
+                }
+            }
+
+            buffer += format == ExportFormat::JSON ? "}" : "\r\n";
+
+            if ( buffer.size() >= WRITE_BUFFER_SIZE ) {
+                out.write(buffer.data(), buffer.size());
+                buffer.clear();
+                if ( !out )
+                    return false;
+            }
+        }
+
+        if ( format == ExportFormat::JSON )
+            buffer += "\n]\n";
+
+        out.write(buffer.data(), buffer.size());
+        out.flush();
+        return res == SQLITE_DONE && out.good();
+    }
+
+    /**
+     * @brief Runs 'write' on a buffered output file, gzip compressed when the name ends in ".gz".
+     */
+    bool WriteFile(const std::string& path, const std::function<bool(std::ostream&)>& write) {
+        std::vector<char> buffer(FILE_BUFFER_SIZE);
+        std::ofstream out;
+        out.rdbuf()->pubsetbuf(buffer.data(), buffer.size());
+        out.open(path, std::ios::binary | std::ios::trunc);
+        if ( !out )
+            return false;
+
+        if ( !IsGzipPath(path) )
+            return write(out);
+
+        GzipOStream compressed(out);
+        bool ok = write(compressed);
+        return compressed.Close() && ok;
+    }
+}
+
+bool DataStore::ExportTableToJSON(const std::string& tableName, const std::string& outputFilename) {
+    return WriteFile(outputFilename, [&](std::ostream& out) { return ExportTable(tableName, out, ExportFormat::JSON); });
+}
+
+bool DataStore::ExportTableToCSV(const std::string& tableName, const std::string& outputFilename) {
+    return WriteFile(outputFilename, [&](std::ostream& out) { return ExportTable(tableName, out, ExportFormat::CSV); });
+}
+
+bool DataStore::ExportTableToArrow(const std::string& tableName, const std::string& outputFilename) {
+    return WriteFile(outputFilename, [&](std::ostream& out) { return ExportTable(tableName, out, ExportFormat::Arrow); });
+}
+
+bool DataStore::ExportTableToParquet(const std::string& tableName, const std::string& outputFilename) {
+    return WriteFile(outputFilename, [&](std::ostream& out) { return ExportTable(tableName, out, ExportFormat::Parquet); });
+}
+
+bool DataStore::ExportTable(const std::string& tableName, std::ostream& out, ExportFormat format) {
+    if ( !this->m_connected || !TableExists(tableName) )
+        return false;
+
+    return ExportQuery("SELECT * FROM " + QuoteIdentifier(tableName) + ";", out, format);
+}
+
+bool DataStore::ExportQuery(const std::string& sql, std::ostream& out, ExportFormat format) {
+    if ( !this->m_connected )
+        return false;
+
+    sqlite3_stmt* stmt;
+    if ( sqlite3_prepare_v2(m_db, sql.c_str(), -1, &stmt, NULL) != SQLITE_OK )
+        return false;
+
+    bool ok;
+    switch ( format ) {
+    case ExportFormat::Arrow: ok = WriteArrowStream(stmt, out); break;
+    case ExportFormat::Parquet: ok = WriteParquet(stmt, out); break;
+    default: ok = WriteRows(stmt, out, format); break;
+    }
+    sqlite3_finalize(stmt);
+    return ok;
+}
+
+bool DataStore::ImportCSV(const std::string& tableName, std::istream& in, uint64_t& rowsImported) {
+    rowsImported = 0;
+    if ( !this->m_connected )
+        return false;
+
+    if ( sqlite3_exec(m_db, "BEGIN IMMEDIATE;", NULL, NULL, NULL) != SQLITE_OK )
+        return false;
+
+    std::vector<std::string> header;
+    std::vector<std::string> fields(1);
+    sqlite3_stmt* insert = nullptr;
+    bool ok = true;
+
+    // Called at the end of every record. The first record is the
+    // header, every other one is bound to the prepared INSERT.
+    auto endRecord = [&]() {
+        // Blank lines are skipped
+        if ( fields.size() == 1 && fields[0].empty() )
+            return;
+
+        if ( header.empty() ) {
+            header = fields;
+
+            std::string columns;
+            std::string params;
+            for ( size_t i = 0; i < header.size(); i++ ) {
+                columns += ( i ? ", " : "" ) + QuoteIdentifier(header[i]);
+                params += ( i ? ", ?" : "?" );
+            }
+
+            std::string create = "CREATE TABLE IF NOT EXISTS " + QuoteIdentifier(tableName) + " (" + columns + ");";
+            std::string sql = "INSERT INTO " + QuoteIdentifier(tableName) + " (" + columns + ") VALUES (" + params + ");";
+            ok = sqlite3_exec(m_db, create.c_str(), NULL, NULL, NULL) == SQLITE_OK
+                && sqlite3_prepare_v2(m_db, sql.c_str(), -1, &insert, NULL) == SQLITE_OK;
+            return;
+        }
+
+        // Short records are padded with NULLs, extra fields are ignored
+        for ( size_t i = 0; i < header.size(); i++ ) {
+            if ( i < fields.size() )
+                sqlite3_bind_text(insert, static_cast<int>(i) + 1, fields[i].data(), static_cast<int>(fields[i].size()), SQLITE_STATIC);
+            else
+                sqlite3_bind_null(insert, static_cast<int>(i) + 1);
+        }
+
+        ok = sqlite3_step(insert) == SQLITE_DONE;
+        sqlite3_reset(insert);
+        if ( ok )
+            rowsImported++;
+    };
+
+    // RFC 4180 state machine, fed one block at a time so the
+    // whole file is never held in memory.
+    std::vector<char> block(READ_BUFFER_SIZE);
+    bool inQuotes = false;
+    bool quoteSeen = false; // Previous char was a '"' inside a quoted field
+    bool pendingCR = false;
+
+    while ( ok && in ) {
+        in.read(block.data(), block.size());
+        std::streamsize count = in.gcount();
+
+        for ( std::streamsize i = 0; i < count && ok; i++ ) {
+            char c = block[i];
+
+            if ( inQuotes ) {
+                if ( quoteSeen ) {
+                    quoteSeen = false;
+                    if ( c == '"' ) {
+                        fields.back() += '"';
+                        continue;
+                    }
+                    inQuotes = false; // closing quote, fall through to handle 'c'
+                } else if ( c == '"' ) {
+                    quoteSeen = true;
+                    continue;
+                } else {
+                    fields.back() += c;
+                    continue;
+                }
+            }
+
+            if ( pendingCR ) {
+                pendingCR = false;
+                if ( c == '\n' )
+                    continue;
+            }
+
+            switch ( c ) {
+            case '"':
+                inQuotes = true;
+                break;
+            case ',':
+                fields.emplace_back();
+                break;
+            case '\r':
+                pendingCR = true;
+                [[fallthrough]];
+            case '\n':
+                endRecord();
+                fields.assign(1, std::string());
+                break;
+            default:
+                fields.back() += c;
+            }
+        }
+    }
+
+    // Last record without a trailing newline
+    if ( ok )
+        endRecord();
+
+    sqlite3_finalize(insert);
+
+    if ( !ok || header.empty() || sqlite3_exec(m_db, "COMMIT;", NULL, NULL, NULL) != SQLITE_OK ) {
+        sqlite3_exec(m_db, "ROLLBACK;", NULL, NULL, NULL);
+        rowsImported = 0;
+        return false;
+    }
+
+    return true;
+}
+
+bool DataStore::AttachCSV(const std::string& csvPath, const std::string& tableName) {
+    if ( !this->m_connected )
+        return false;
+
+    // Module arguments are passed through as written, the module strips the quotes
+    std::string path = "'";
+    for ( char c : csvPath ) {
+        if ( c == '\'' )
+            path += '\'';
+        path += c;
+    }
+    path += "'";
+
+    std::string query = "CREATE VIRTUAL TABLE temp." + QuoteIdentifier(tableName) + " USING csvfile(" + path + ");";
+    return sqlite3_exec(m_db, query.c_str(), NULL, NULL, NULL) == SQLITE_OK;
+}
@@ -0,0 +1,253 @@
+// Backend
+#include "backend/io_stats.hxx"
+#include "backend/shim_vfs.hxx"
+
+// STD
+#include <algorithm>
+#include <atomic>
+#include <bit>
+#include <chrono>
+
+namespace {
+    constexpr const char* VFS_NAME = "sqlight-io";
+    constexpr int KIND_COUNT = static_cast<int>(IoFileKind::Count);
+
+    using Clock = std::chrono::steady_clock;
+
+    struct AtomicHistogram {
+        std::atomic<uint64_t> counts[LatencyHistogram::BUCKETS] = {};
+    };
+
+    struct AtomicFileStats {
+        std::atomic<uint64_t> opens = 0;
+        std::atomic<uint64_t> reads = 0;
+        std::atomic<uint64_t> bytesRead = 0;
+        std::atomic<uint64_t> writes = 0;
+        std::atomic<uint64_t> bytesWritten = 0;
+        std::atomic<uint64_t> syncs = 0;
+        std::atomic<uint64_t> locks = 0;
+        AtomicHistogram readLatency;
+        AtomicHistogram writeLatency;
+        AtomicHistogram syncLatency;
+    };
+
+    AtomicFileStats g_stats[KIND_COUNT];
+
+    sqlite3_file* Real(sqlite3_file* file) {
+        return ShimRealFile(file);
+    }
+
+    AtomicFileStats& Stats(sqlite3_file* file) {
+        return *ShimState<AtomicFileStats>(file);
+    }
+
+    void Increment(std::atomic<uint64_t>& counter, uint64_t by = 1) {
+        counter.fetch_add(by, std::memory_order_relaxed);
+    }
+
+    void RecordLatency(AtomicHistogram& histogram, Clock::time_point start) {
+        auto micros = std::chrono::duration_cast<std::chrono::microseconds>(Clock::now() - start).count();
+        int bucket = std::min<int>(std::bit_width(static_cast<uint64_t>(std::max<long long>(micros, 0))), LatencyHistogram::BUCKETS - 1);
+        Increment(histogram.counts[bucket]);
+    }
+
+    IoFileKind KindFromFlags(int flags) {
+        if ( flags & SQLITE_OPEN_MAIN_DB )
+            return IoFileKind::MainDb;
+        if ( flags & ( SQLITE_OPEN_MAIN_JOURNAL | SQLITE_OPEN_SUPER_JOURNAL ) )
+            return IoFileKind::Journal;
+        if ( flags & SQLITE_OPEN_WAL )
+            return IoFileKind::Wal;
+        return IoFileKind::Temp;
+    }
+
+    int Read(sqlite3_file* file, void* buffer, int amount, sqlite3_int64 offset) {
+        auto start = Clock::now();
+        int res = Real(file)->pMethods->xRead(Real(file), buffer, amount, offset);
+        AtomicFileStats& stats = Stats(file);
+        RecordLatency(stats.readLatency, start);
+        Increment(stats.reads);
+        Increment(stats.bytesRead, amount); // Short reads at the end of a file count in full
+        return res;
+    }
+
+    int Write(sqlite3_file* file, const void* buffer, int amount, sqlite3_int64 offset) {
+        auto start = Clock::now();
+        int res = Real(file)->pMethods->xWrite(Real(file), buffer, amount, offset);
+        AtomicFileStats& stats = Stats(file);
+        RecordLatency(stats.writeLatency, start);
+        Increment(stats.writes);
+        Increment(stats.bytesWritten, amount);
+        return res;
+    }
+
+    int Sync(sqlite3_file* file, int flags) {
+        auto start = Clock::now();
+        int res = Real(file)->pMethods->xSync(Real(file), flags);
+        AtomicFileStats& stats = Stats(file);
+        RecordLatency(stats.syncLatency, start);
+        Increment(stats.syncs);
+        return res;
+    }
+
+    int Lock(sqlite3_file* file, int level) {
+        Increment(Stats(file).locks);
+        return Real(file)->pMethods->xLock(Real(file), level);
+    }
+
+    int Unlock(sqlite3_file* file, int level) {
+        Increment(Stats(file).locks);
+        return Real(file)->pMethods->xUnlock(Real(file), level);
+    }
+
+    int CheckReservedLock(sqlite3_file* file, int* reserved) {
+        Increment(Stats(file).locks);
+        return Real(file)->pMethods->xCheckReservedLock(Real(file), reserved);
+    }
+
+    int ShmLock(sqlite3_file* file, int offset, int count, int flags) {
+        Increment(Stats(file).locks);
+        return Real(file)->pMethods->xShmLock(Real(file), offset, count, flags);
+    }
+
+    // Everything else passes straight through. Each file gets the
+    // version of the methods its real file has.
+    sqlite3_io_methods StatsMethods(int version) {
+        sqlite3_io_methods methods = ShimForwardingMethods(version);
+        methods.xRead = Read;
+        methods.xWrite = Write;
+        methods.xSync = Sync;
+        methods.xLock = Lock;
+        methods.xUnlock = Unlock;
+        methods.xCheckReservedLock = CheckReservedLock;
+        if ( version >= 2 )
+            methods.xShmLock = ShmLock;
+        return methods;
+    }
+
+    const sqlite3_io_methods METHODS[] = { StatsMethods(1), StatsMethods(2), StatsMethods(3) };
+
+    int Open(sqlite3_vfs* vfs, sqlite3_filename name, sqlite3_file* file, int flags, int* outFlags) {
+        ShimFile* statsFile = reinterpret_cast<ShimFile*>(file);
+        statsFile->base.pMethods = nullptr;
+        statsFile->state = &g_stats[static_cast<int>(KindFromFlags(flags))];
+        Real(file)->pMethods = nullptr;
+
+        int res = ShimRealVfs(vfs)->xOpen(ShimRealVfs(vfs), name, Real(file), flags, outFlags);
+        // SQLite only closes files with methods, the underlying file has
+        // none if it failed to open and must not be closed then either
+        const sqlite3_io_methods* realMethods = Real(file)->pMethods;
+        if ( realMethods ) {
+            statsFile->base.pMethods = &METHODS[std::clamp(realMethods->iVersion, 1, 3) - 1];
+            Increment(Stats(file).opens);
+        }
+
+        return res;
+    }
+
+    const char* Register() {
+        sqlite3_vfs* real = sqlite3_vfs_find(nullptr);
+        if ( !real )
+            return nullptr;
+
+        static sqlite3_vfs vfs;
+        InitShimVfs(vfs, real, VFS_NAME, Open);
+        return sqlite3_vfs_register(&vfs, 0) == SQLITE_OK ? VFS_NAME : nullptr;
+    }
+
+    void Snapshot(const AtomicHistogram& from, LatencyHistogram& to) {
+        for ( int i = 0; i < LatencyHistogram::BUCKETS; i++ )
+            to.counts[i] = from.counts[i].load(std::memory_order_relaxed);
+    }
+
+    void Clear(AtomicHistogram& histogram) {
+        for ( auto& count : histogram.counts )
+            count.store(0, std::memory_order_relaxed);
+    }
+}
+
+uint64_t LatencyHistogram::Total() const {
+    uint64_t total = 0;
+    for ( uint64_t count : counts )
+        total += count;
+    return total;
+}
+
+/**
+ * @brief Estimates a latency percentile from the histogram.
+ *
+ * @param percentile Between 0 and 1, e.g. 0.99 for the 99th percentile.
+ * @return The upper bound, in microseconds, of the bucket the percentile
+ *         falls in. 0 if nothing was recorded.
+ */
+double LatencyHistogram::PercentileMicros(double percentile) const {
+    uint64_t total = Total();
+    if ( total == 0 )
+        return 0;
+
+    uint64_t rank = std::max<uint64_t>(1, static_cast<uint64_t>(percentile * total + 0.5));
+    uint64_t seen = 0;
+    for ( int i = 0; i < BUCKETS; i++ ) {
+        seen += counts[i];
+        if ( seen >= rank )
+            return static_cast<double>(uint64_t(1) << i);
+    }
+
+    return static_cast<double>(uint64_t(1) << ( BUCKETS - 1 ));
+}
+
+/**
+ * @brief Registers the "sqlight-io" VFS the first time it is called.
+ *
+ * @return The VFS name for sqlite3_open_v2, or nullptr if it could not be
+ *         registered, in which case connections use the default VFS.
+ */
+const char* RegisterIoStatsVfs() {
+    static const char* name = Register();
+    return name;
+}
+
+/**
+ * @brief Takes a snapshot of the counters.
+ *
+ * Counters are read one at a time while other threads may be adding to
+ * them, so a snapshot taken during I/O can be off by the calls in flight.
+ */
+IoStats ReadIoStats() {
+    IoStats snapshot;
+    for ( int i = 0; i < KIND_COUNT; i++ ) {
+        const AtomicFileStats& from = g_stats[i];
+        FileIoStats& to = snapshot.files[i];
+        to.opens = from.opens.load(std::memory_order_relaxed);
+        to.reads = from.reads.load(std::memory_order_relaxed);
+        to.bytesRead = from.bytesRead.load(std::memory_order_relaxed);
+        to.writes = from.writes.load(std::memory_order_relaxed);
+        to.bytesWritten = from.bytesWritten.load(std::memory_order_relaxed);
+        to.syncs = from.syncs.load(std::memory_order_relaxed);
+        to.locks = from.locks.load(std::memory_order_relaxed);
+        Snapshot(from.readLatency, to.readLatency);
+        Snapshot(from.writeLatency, to.writeLatency);
+        Snapshot(from.syncLatency, to.syncLatency);
+    }
+
+    return snapshot;
+}
+
+void ResetIoStats() {
+    for ( AtomicFileStats& stats : g_stats ) {
+        for ( auto* counter : { &stats.opens, &stats.reads, &stats.bytesRead, &stats.writes, &stats.bytesWritten, &stats.syncs, &stats.locks } )
+            counter->store(0, std::memory_order_relaxed);
+        Clear(stats.readLatency);
+        Clear(stats.writeLatency);
+        Clear(stats.syncLatency);
+    }
+}
+
+const char* IoFileKindName(IoFileKind kind) {
+    switch ( kind ) {
+    case IoFileKind::MainDb: return "main";
+    case IoFileKind::Journal: return "journal";
+    case IoFileKind::Wal: return "wal";
+    default: return "temp";
+    }
+}
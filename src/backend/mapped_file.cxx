@@ -0,0 +1,113 @@
+// Backend
+#include "backend/mapped_file.hxx"
+
+#ifdef _WIN32
+    #define WIN32_LEAN_AND_MEAN
+    #define NOMINMAX
+    #include <windows.h>
+#else
+    #include <fcntl.h>
+    #include <sys/mman.h>
+    #include <sys/stat.h>
+    #include <unistd.h>
+#endif
+
+MappedFile::~MappedFile() {
+    Close();
+}
+
+#ifdef _WIN32
+bool MappedFile::Open(const std::string& path) {
+    Close();
+
+    int length = MultiByteToWideChar(CP_UTF8, 0, path.c_str(), -1, nullptr, 0);
+    std::wstring widePath(length, L'\0');
+    MultiByteToWideChar(CP_UTF8, 0, path.c_str(), -1, widePath.data(), length);
+
+    HANDLE file = CreateFileW(widePath.c_str(), GENERIC_READ, FILE_SHARE_READ | FILE_SHARE_WRITE, nullptr, OPEN_EXISTING, FILE_FLAG_SEQUENTIAL_SCAN, nullptr);
+    if ( file == INVALID_HANDLE_VALUE )
+        return false;
+
+    LARGE_INTEGER size;
+    if ( !GetFileSizeEx(file, &size) ) {
+        CloseHandle(file);
+        return false;
+    }
+
+    m_file = file;
+    m_size = static_cast<uint64_t>(size.QuadPart);
+    m_open = true;
+
+    // Zero length files can't be mapped
+    if ( m_size == 0 )
+        return true;
+
+    m_mapping = CreateFileMappingW(file, nullptr, PAGE_READONLY, 0, 0, nullptr);
+    if ( m_mapping )
+        m_data = static_cast<const char*>(MapViewOfFile(m_mapping, FILE_MAP_READ, 0, 0, 0));
+
+    if ( !m_data ) {
+        Close();
+        return false;
+    }
+
+    return true;
+}
+
+void MappedFile::Close() {
+    if ( m_data )
+        UnmapViewOfFile(m_data);
+    if ( m_mapping )
+        CloseHandle(m_mapping);
+    if ( m_file )
+        CloseHandle(m_file);
+
+    m_data = nullptr;
+    m_mapping = nullptr;
+    m_file = nullptr;
+    m_size = 0;
+    m_open = false;
+}
+#else
+bool MappedFile::Open(const std::string& path) {
+    Close();
+
+    int fd = open(path.c_str(), O_RDONLY | O_CLOEXEC);
+    if ( fd < 0 )
+        return false;
+
+    struct stat info;
+    if ( fstat(fd, &info) != 0 ) {
+        close(fd);
+        return false;
+    }
+
+    m_size = static_cast<uint64_t>(info.st_size);
+    if ( m_size > 0 ) {
+        void* data = mmap(nullptr, m_size, PROT_READ, MAP_PRIVATE, fd, 0);
+        if ( data == MAP_FAILED ) {
+            close(fd);
+            m_size = 0;
+            return false;
+        }
+
+        // Mostly read front to back, so let the kernel read ahead aggressively
+        madvise(data, m_size, MADV_SEQUENTIAL);
+        m_data = static_cast<const char*>(data);
+    }
+
+    // The mapping stays valid after the descriptor is closed
+    close(fd);
+    m_open = true;
+    return true;
+}
+
+void MappedFile::Close() {
+    if ( m_data )
+        munmap(const_cast<char*>(m_data), m_size);
+
+    m_data = nullptr;
+    m_size = 0;
+    m_open = false;
+}
+#endif
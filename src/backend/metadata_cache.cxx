@@ -0,0 +1,327 @@
+// Backend
+#include "backend/metadata_cache.hxx"
+
+// STD
+#include <bit>
+#include <cstring>
+#include <filesystem>
+#include <fstream>
+#include <iterator>
+
+namespace {
+    constexpr char MAGIC[8] = { 'S', 'Q', 'L', 'i', 'g', 'h', 't', 'M' };
+    constexpr uint32_t FORMAT_VERSION = 2; // 2 added whether each row count is exact
+    constexpr const char* SIDECAR_SUFFIX = ".sqlight-cache";
+
+    void PutLittleEndian(std::string& out, uint64_t value, int bytes) {
+        for ( int i = 0; i < bytes; i++ )
+            out += static_cast<char>(value >> ( 8 * i ));
+    }
+
+    void PutString(std::string& out, const std::string& value) {
+        PutLittleEndian(out, value.size(), 4);
+        out += value;
+    }
+
+    void PutDouble(std::string& out, double value) {
+        PutLittleEndian(out, std::bit_cast<uint64_t>(value), 8);
+    }
+
+    // Reads the values Put wrote, in the same order. Reading past the end
+    // clears 'ok' and yields zeros, so a truncated sidecar is caught once
+    // at the end rather than after every value.
+    struct Reader {
+        const std::string& data;
+        size_t offset = 0;
+        bool ok = true;
+
+        uint64_t LittleEndian(int bytes) {
+            if ( data.size() - offset < static_cast<size_t>(bytes) ) {
+                ok = false;
+                return 0;
+            }
+
+            uint64_t value = 0;
+            for ( int i = 0; i < bytes; i++ )
+                value |= uint64_t(static_cast<unsigned char>(data[offset + i])) << ( 8 * i );
+            offset += bytes;
+            return value;
+        }
+
+        // Element counts can't exceed the bytes left, which keeps a
+        // corrupt count from reserving gigabytes
+        size_t Count() {
+            size_t count = LittleEndian(4);
+            if ( count > data.size() - offset ) {
+                ok = false;
+                return 0;
+            }
+            return count;
+        }
+
+        std::string String() {
+            size_t length = Count();
+            std::string value = data.substr(offset, length);
+            offset += length;
+            return value;
+        }
+
+        double Double() {
+            return std::bit_cast<double>(LittleEndian(8));
+        }
+    };
+
+    int64_t Ticks(const std::filesystem::path& path, std::error_code& ec) {
+        return std::filesystem::last_write_time(path, ec).time_since_epoch().count();
+    }
+
+    void PutColumnStats(std::string& out, const ColumnStats& stats) {
+        PutString(out, stats.table);
+        PutString(out, stats.column);
+        PutLittleEndian(out, stats.sampled, 1);
+        for ( uint64_t count : { stats.estimatedRows, stats.rowsScanned, stats.nullCount, stats.integerCount, stats.realCount, stats.textCount, stats.blobCount } )
+            PutLittleEndian(out, count, 8);
+
+        // Optional values are a presence byte, then the value if present
+        PutLittleEndian(out, stats.numericMin.has_value(), 1);
+        if ( stats.numericMin ) {
+            PutDouble(out, *stats.numericMin);
+            PutDouble(out, *stats.numericMax);
+        }
+        PutLittleEndian(out, stats.textMin.has_value(), 1);
+        if ( stats.textMin ) {
+            PutString(out, *stats.textMin);
+            PutString(out, *stats.textMax);
+        }
+
+        PutDouble(out, stats.distinctEstimate);
+        PutLittleEndian(out, stats.topValues.size(), 4);
+        for ( const auto& entry : stats.topValues ) {
+            PutString(out, entry.value);
+            PutLittleEndian(out, entry.count, 8);
+            PutLittleEndian(out, entry.error, 8);
+        }
+        PutLittleEndian(out, stats.histogram.size(), 4);
+        for ( const auto& bucket : stats.histogram ) {
+            PutDouble(out, bucket.low);
+            PutDouble(out, bucket.high);
+            PutLittleEndian(out, bucket.count, 8);
+        }
+    }
+
+    ColumnStats GetColumnStats(Reader& in) {
+        ColumnStats stats;
+        stats.table = in.String();
+        stats.column = in.String();
+        stats.sampled = in.LittleEndian(1) != 0;
+        for ( uint64_t* count : { &stats.estimatedRows, &stats.rowsScanned, &stats.nullCount, &stats.integerCount, &stats.realCount, &stats.textCount, &stats.blobCount } )
+            *count = in.LittleEndian(8);
+
+        if ( in.LittleEndian(1) ) {
+            stats.numericMin = in.Double();
+            stats.numericMax = in.Double();
+        }
+        if ( in.LittleEndian(1) ) {
+            stats.textMin = in.String();
+            stats.textMax = in.String();
+        }
+
+        stats.distinctEstimate = in.Double();
+        for ( size_t i = in.Count(); i > 0 && in.ok; i-- ) {
+            SpaceSaving::Entry entry;
+            entry.value = in.String();
+            entry.count = in.LittleEndian(8);
+            entry.error = in.LittleEndian(8);
+            stats.topValues.push_back(std::move(entry));
+        }
+        for ( size_t i = in.Count(); i > 0 && in.ok; i-- ) {
+            ColumnStats::Bucket bucket;
+            bucket.low = in.Double();
+            bucket.high = in.Double();
+            bucket.count = in.LittleEndian(8);
+            stats.histogram.push_back(bucket);
+        }
+
+        return stats;
+    }
+}
+
+/**
+ * @brief Reads the identity of the data base file at 'dbPath' and of its WAL.
+ *
+ * A missing or empty WAL leaves the WAL fields zero, which is also how a
+ * data base that isn't in WAL mode looks. Opening a WAL data base creates
+ * an empty WAL and closing it removes the WAL again, neither changes the data.
+ */
+FileIdentity ReadFileIdentity(const std::string& dbPath) {
+    FileIdentity identity;
+    std::error_code ec;
+
+    identity.size = std::filesystem::file_size(dbPath, ec);
+    identity.modified = Ticks(dbPath, ec);
+    if ( ec )
+        return {};
+
+    std::string walPath = dbPath + "-wal";
+    identity.walSize = std::filesystem::file_size(walPath, ec);
+    identity.walModified = Ticks(walPath, ec);
+    if ( ec || identity.walSize == 0 ) {
+        identity.walSize = 0;
+        identity.walModified = 0;
+    }
+
+    return identity;
+}
+
+/**
+ * @brief Reads the sidecar of the data base at 'dbPath'.
+ *
+ * Row counts and column statistics are dropped if the data base has
+ * changed since they were saved, and 'identity' is set to its current
+ * identity, so whatever is stored from now on is keyed to it. The table
+ * list is kept either way, checking its schema version is up to the caller.
+ *
+ * @return false if there is no sidecar or it can't be parsed, in which
+ *         case the cache is left empty.
+ */
+bool MetadataCache::Load(const std::string& dbPath) {
+    Clear();
+    FileIdentity current = ReadFileIdentity(dbPath);
+    this->identity = current;
+
+    std::ifstream file(SidecarPath(dbPath), std::ios::binary);
+    if ( !file )
+        return false;
+
+    std::string data{ std::istreambuf_iterator<char>(file), std::istreambuf_iterator<char>() };
+    if ( data.size() < sizeof(MAGIC) || std::memcmp(data.data(), MAGIC, sizeof(MAGIC)) != 0 )
+        return false;
+
+    Reader in{ data, sizeof(MAGIC) };
+    if ( in.LittleEndian(4) != FORMAT_VERSION )
+        return false;
+
+    FileIdentity saved;
+    saved.size = in.LittleEndian(8);
+    saved.modified = static_cast<int64_t>(in.LittleEndian(8));
+    saved.walSize = in.LittleEndian(8);
+    saved.walModified = static_cast<int64_t>(in.LittleEndian(8));
+    this->schemaVersion = static_cast<int64_t>(in.LittleEndian(8));
+
+    for ( size_t i = in.Count(); i > 0 && in.ok; i-- )
+        this->tableNames.push_back(in.String());
+
+    for ( size_t i = in.Count(); i > 0 && in.ok; i-- ) {
+        std::string table = in.String();
+        RowCount& count = this->rowCounts[table];
+        count.rows = in.LittleEndian(8);
+        count.exact = in.LittleEndian(1) != 0;
+    }
+
+    for ( size_t i = in.Count(); i > 0 && in.ok; i-- ) {
+        ColumnStats stats = GetColumnStats(in);
+        this->columnStats[{ stats.table, stats.column }] = std::move(stats);
+    }
+
+    if ( !in.ok ) {
+        Clear();
+        this->identity = current;
+        return false;
+    }
+
+    if ( saved != current )
+        ForgetRows();
+
+    return true;
+}
+
+/**
+ * @brief Writes the cache to the sidecar of the data base at 'dbPath'.
+ *
+ * The sidecar is written to a temporary file first and renamed over the
+ * old one, so a crash halfway leaves the previous sidecar intact.
+ */
+bool MetadataCache::Save(const std::string& dbPath) const {
+    std::string out(MAGIC, sizeof(MAGIC));
+    PutLittleEndian(out, FORMAT_VERSION, 4);
+    PutLittleEndian(out, this->identity.size, 8);
+    PutLittleEndian(out, static_cast<uint64_t>(this->identity.modified), 8);
+    PutLittleEndian(out, this->identity.walSize, 8);
+    PutLittleEndian(out, static_cast<uint64_t>(this->identity.walModified), 8);
+    PutLittleEndian(out, static_cast<uint64_t>(this->schemaVersion), 8);
+
+    PutLittleEndian(out, this->tableNames.size(), 4);
+    for ( const std::string& name : this->tableNames )
+        PutString(out, name);
+
+    PutLittleEndian(out, this->rowCounts.size(), 4);
+    for ( const auto& [table, count] : this->rowCounts ) {
+        PutString(out, table);
+        PutLittleEndian(out, count.rows, 8);
+        PutLittleEndian(out, count.exact, 1);
+    }
+
+    PutLittleEndian(out, this->columnStats.size(), 4);
+    for ( const auto& [key, stats] : this->columnStats )
+        PutColumnStats(out, stats);
+
+    std::string path = SidecarPath(dbPath);
+    std::string tempPath = path + ".tmp";
+    {
+        std::ofstream file(tempPath, std::ios::binary | std::ios::trunc);
+        if ( !file || !file.write(out.data(), static_cast<std::streamsize>(out.size())) )
+            return false;
+    }
+
+    std::error_code ec;
+    std::filesystem::rename(tempPath, path, ec);
+    if ( ec )
+        std::filesystem::remove(tempPath, ec);
+    return !ec;
+}
+
+void MetadataCache::Clear() {
+    this->identity = {};
+    this->schemaVersion = -1;
+    this->tableNames.clear();
+    this->rowCounts.clear();
+    this->columnStats.clear();
+}
+
+void MetadataCache::ForgetTable(const std::string& tableName) {
+    this->rowCounts.erase(tableName);
+    std::erase_if(this->columnStats, [&tableName](const auto& entry) { return entry.first.first == tableName; });
+}
+
+void MetadataCache::ForgetRows() {
+    this->rowCounts.clear();
+    this->columnStats.clear();
+}
+
+void MetadataCache::ForgetData() {
+    this->schemaVersion = -1;
+    ForgetRows();
+}
+
+void MetadataCache::Revalidate(const std::string& dbPath) {
+    if ( ReadFileIdentity(dbPath) != this->identity )
+        ForgetRows();
+}
+
+void MetadataCache::Rekey(const std::string& dbPath) {
+    this->identity = ReadFileIdentity(dbPath);
+}
+
+const ColumnStats* MetadataCache::FindColumnStats(const std::string& tableName, const std::string& columnName) const {
+    auto it = this->columnStats.find({ tableName, columnName });
+    return it != this->columnStats.end() ? &it->second : nullptr;
+}
+
+void MetadataCache::StoreColumnStats(const ColumnStats& stats) {
+    this->columnStats[{ stats.table, stats.column }] = stats;
+    this->rowCounts.try_emplace(stats.table, RowCount{ stats.estimatedRows, false });
+}
+
+std::string MetadataCache::SidecarPath(const std::string& dbPath) {
+    return dbPath + SIDECAR_SUFFIX;
+}
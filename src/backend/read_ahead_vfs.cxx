@@ -0,0 +1,149 @@
+// Backend
+#include "backend/read_ahead_vfs.hxx"
+#include "backend/io_stats.hxx"
+#include "backend/shim_vfs.hxx"
+
+#ifndef _WIN32
+    #include <fcntl.h>
+    #include <unistd.h>
+#endif
+
+// STD
+#include <algorithm>
+#include <cstdint>
+
+namespace {
+    constexpr const char* VFS_NAME = "sqlight-readahead";
+
+    constexpr uint64_t MAX_GAP = 64 * 1024; // Forward skips still counted as sequential, e.g. over an overflow chain
+    constexpr uint64_t RUN_THRESHOLD = 64 * 1024; // Sequential bytes read before prefetching starts
+    constexpr uint64_t MIN_WINDOW = 256 * 1024;
+    constexpr uint64_t MAX_WINDOW = 8 * 1024 * 1024;
+    constexpr int MAX_STRAY_READS = 4; // Reads off a run before it is given up
+
+    struct ReadAhead {
+        int fd = -1; // Own descriptor on the file, only used for advice
+        uint64_t nextOffset = 0; // Where the last read ended
+        uint64_t runBytes = 0; // Read sequentially so far
+        int strayReads = 0; // Off the run since it last continued
+        uint64_t prefetchedTo = 0; // End of the last window asked for
+        uint64_t window = MIN_WINDOW;
+    };
+
+    sqlite3_file* Real(sqlite3_file* file) {
+        return ShimRealFile(file);
+    }
+
+    void Advise(int fd, uint64_t offset, uint64_t length) {
+#if defined(POSIX_FADV_WILLNEED)
+        posix_fadvise(fd, static_cast<off_t>(offset), static_cast<off_t>(length), POSIX_FADV_WILLNEED);
+#elif defined(F_RDADVISE)
+        radvisory advice = { static_cast<off_t>(offset), static_cast<int>(length) };
+        fcntl(fd, F_RDADVISE, &advice);
+#else
+        (void)fd, (void)offset, (void)length;
+#endif
+    }
+
+    /**
+     * @brief Tracks the read at 'offset' and prefetches once reads look sequential.
+     *
+     * Scans also read the odd page elsewhere, the next interior b-tree page
+     * or an overflow page, so a few reads off a run don't end it. A new
+     * window is asked for when the reader is half way through the last one,
+     * so the OS stays ahead without being asked for every page.
+     */
+    void Observe(ReadAhead& state, uint64_t offset, int amount) {
+        if ( offset >= state.nextOffset && offset - state.nextOffset <= MAX_GAP ) {
+            state.runBytes += amount;
+            state.strayReads = 0;
+        } else if ( state.runBytes >= RUN_THRESHOLD && ++state.strayReads <= MAX_STRAY_READS ) {
+            return;
+        } else {
+            state.runBytes = amount;
+            state.strayReads = 0;
+            state.prefetchedTo = 0;
+            state.window = MIN_WINDOW;
+        }
+        state.nextOffset = offset + amount;
+
+        if ( state.runBytes < RUN_THRESHOLD || state.nextOffset + state.window / 2 < state.prefetchedTo )
+            return;
+
+        uint64_t start = std::max(state.prefetchedTo, state.nextOffset);
+        Advise(state.fd, start, state.window);
+        state.prefetchedTo = start + state.window;
+        state.window = std::min(state.window * 2, MAX_WINDOW);
+    }
+
+    int Close(sqlite3_file* file) {
+        ReadAhead* state = ShimState<ReadAhead>(file);
+#ifndef _WIN32
+        close(state->fd);
+#endif
+        delete state;
+        return Real(file)->pMethods->xClose(Real(file));
+    }
+
+    int Read(sqlite3_file* file, void* buffer, int amount, sqlite3_int64 offset) {
+        Observe(*ShimState<ReadAhead>(file), static_cast<uint64_t>(offset), amount);
+        return Real(file)->pMethods->xRead(Real(file), buffer, amount, offset);
+    }
+
+    sqlite3_io_methods ReadAheadMethods(int version) {
+        sqlite3_io_methods methods = ShimForwardingMethods(version);
+        methods.xClose = Close;
+        methods.xRead = Read;
+        return methods;
+    }
+
+    const sqlite3_io_methods METHODS[] = { ReadAheadMethods(1), ReadAheadMethods(2), ReadAheadMethods(3) };
+
+    int Open(sqlite3_vfs* vfs, sqlite3_filename name, sqlite3_file* file, int flags, int* outFlags) {
+        sqlite3_vfs* real = ShimRealVfs(vfs);
+        int fd = -1;
+#ifndef _WIN32
+        if ( name && ( flags & SQLITE_OPEN_MAIN_DB ) )
+            fd = open(name, O_RDONLY | O_CLOEXEC);
+#endif
+        // Journals and temp files are read back rarely and in order, SQLite
+        // gets the real file for those, which fits in the shim's szOsFile
+        if ( fd < 0 )
+            return real->xOpen(real, name, file, flags, outFlags);
+
+        ShimFile* shimFile = reinterpret_cast<ShimFile*>(file);
+        shimFile->base.pMethods = nullptr;
+        Real(file)->pMethods = nullptr;
+
+        int res = real->xOpen(real, name, Real(file), flags, outFlags);
+        const sqlite3_io_methods* realMethods = Real(file)->pMethods;
+        if ( !realMethods ) {
+#ifndef _WIN32
+            close(fd);
+#endif
+            return res;
+        }
+
+        ReadAhead* state = new ReadAhead();
+        state->fd = fd;
+        shimFile->state = state;
+        shimFile->base.pMethods = &METHODS[std::clamp(realMethods->iVersion, 1, 3) - 1];
+        return res;
+    }
+
+    const char* Register() {
+        // Over the I/O statistics VFS, which then counts what SQLite reads, not what is prefetched
+        sqlite3_vfs* real = sqlite3_vfs_find(RegisterIoStatsVfs());
+        if ( !real )
+            return nullptr;
+
+        static sqlite3_vfs vfs;
+        InitShimVfs(vfs, real, VFS_NAME, Open);
+        return sqlite3_vfs_register(&vfs, 0) == SQLITE_OK ? VFS_NAME : nullptr;
+    }
+}
+
+const char* RegisterReadAheadVfs() {
+    static const char* name = Register();
+    return name;
+}
@@ -0,0 +1,368 @@
+// Backend
+#include "backend/data_store.hxx"
+#include "backend/mapped_file.hxx"
+
+// STD
+#include <algorithm>
+#include <cctype>
+#include <chrono>
+#include <cstring>
+
+namespace {
+    constexpr uint64_t SCRIPT_CHUNK_SIZE = 4 << 20; // Bytes of the mapped script copied out at once
+    constexpr double SCRIPT_REPORT_INTERVAL = 0.1; // Seconds between progress reports
+    constexpr int DUMP_BATCH_STATEMENTS = 50'000; // Statements per transaction when importing a dump
+    constexpr int DUMP_CACHE_KIB = 256 * 1024; // Page cache while importing a dump, mostly for index builds
+
+    /*
+        Splits a mapped script into chunks that end on a statement boundary,
+        each copied into a nul terminated buffer.
+
+        sqlite3_prepare_v3 copies its input whenever it isn't nul terminated,
+        which for a mapped file would mean copying the rest of the script once
+        per statement. Copying SCRIPT_CHUNK_SIZE bytes at a time instead keeps
+        the cost to a single pass over the file.
+    */
+    class ScriptChunker {
+    public:
+        explicit ScriptChunker(const MappedFile& file) : m_data(file.Data()), m_size(file.Size())
+        {
+        }
+
+        // Copy the next chunk into 'chunk'. 'offset' is where it starts in the file. False at the end
+        bool Next(std::string& chunk, uint64_t& offset) {
+            if ( m_position >= m_size )
+                return false;
+
+            uint64_t end = std::min(m_size, m_position + SCRIPT_CHUNK_SIZE);
+            uint64_t cut = end == m_size ? m_size : FindCut(end);
+
+            chunk.assign(m_data + m_position, cut - m_position);
+            offset = m_position;
+            m_position = cut;
+            return true;
+        }
+    private:
+        /*
+            Offset just past the last statement ending before 'end', or past the
+            first one if that already ends further on, so a chunk is at most
+            SCRIPT_CHUNK_SIZE unless a single statement is longer.
+
+            Dumps end statements with ";\n", and the last of those in the window
+            is tried first. When it sits inside a string, comment or trigger body,
+            or statements share lines, every ';' is tried in turn from the start.
+            Each is only checked from the last statement end found, so the scan
+            stays a single pass over the window for short statements.
+        */
+        uint64_t FindCut(uint64_t end) {
+            uint64_t cut = LastStatementEnd(m_position, end);
+            if ( cut && IsComplete(m_position, cut) )
+                return cut;
+
+            cut = m_position;
+            for ( uint64_t i = m_position; i < m_size; i++ ) {
+                if ( m_data[i] != ';' )
+                    continue;
+                if ( i >= end && cut > m_position )
+                    break;
+                if ( IsComplete(cut, i + 1) )
+                    cut = i + 1;
+            }
+
+            return cut > m_position ? cut : m_size;
+        }
+
+        // Whether [begin, end) is whole statements. After one, sqlite3_complete starts afresh
+        bool IsComplete(uint64_t begin, uint64_t end) {
+            m_scratch.assign(m_data + begin, end - begin);
+            return sqlite3_complete(m_scratch.c_str());
+        }
+
+        // Offset just past the last ";\n" in [begin, end), or 0 if there is none
+        uint64_t LastStatementEnd(uint64_t begin, uint64_t end) const {
+            for ( uint64_t i = end - 1; i > begin; i-- ) {
+                if ( m_data[i] == '\n' && ( m_data[i - 1] == ';' || ( m_data[i - 1] == '\r' && i - 1 > begin && m_data[i - 2] == ';' ) ) )
+                    return i + 1;
+            }
+            return 0;
+        }
+
+        const char* m_data;
+        uint64_t m_size;
+        uint64_t m_position = 0;
+        std::string m_scratch; // Candidate chunk for sqlite3_complete, which needs a nul terminator
+    };
+
+    uint64_t LineAt(const MappedFile& file, uint64_t offset) {
+        return 1 + std::count(file.Data(), file.Data() + offset, '\n');
+    }
+
+    int StepToEnd(sqlite3_stmt* stmt) {
+        int res;
+        while ( ( res = sqlite3_step(stmt) ) == SQLITE_ROW ) {
+        }
+        return res == SQLITE_DONE ? SQLITE_OK : res;
+    }
+
+    /*
+        Runs the statements of a mapped script one at a time, keeping track
+        of progress, stop requests and the line of a statement that fails.
+        What is done with each prepared statement is up to the handler, so
+        ExecuteScript and ImportDump share everything but that.
+    */
+    class ScriptRunner {
+    public:
+        // Runs a prepared statement. Anything but SQLITE_OK stops the script
+        using Handler = std::function<int(sqlite3_stmt*)>;
+
+        ScriptRunner(sqlite3* db, const MappedFile& file, const std::function<void(const ScriptProgress&)>& onProgress)
+            : m_db(db), m_file(file), m_onProgress(onProgress),
+              m_start(std::chrono::steady_clock::now()), m_changesBefore(sqlite3_total_changes64(db))
+        {
+            m_progress.totalBytes = file.Size();
+        }
+
+        bool Run(const Handler& handle, std::string& error, std::stop_token stop) {
+            ScriptChunker chunker(m_file);
+            std::string chunk;
+            uint64_t chunkOffset = 0;
+
+            while ( chunker.Next(chunk, chunkOffset) ) {
+                const char* sql = chunk.c_str();
+
+                while ( *sql ) {
+                    sqlite3_stmt* stmt = nullptr;
+                    const char* tail = sql;
+                    int res = sqlite3_prepare_v3(m_db, sql, -1, 0, &stmt, &tail);
+
+                    // stmt is null for whitespace and comments
+                    if ( res == SQLITE_OK && stmt ) {
+                        res = handle(stmt);
+                        if ( res == SQLITE_OK )
+                            m_progress.statements++;
+                    }
+
+                    if ( res != SQLITE_OK ) {
+                        // Point at the statement itself, not the blank lines before it
+                        while ( *sql == ' ' || *sql == '\t' || *sql == '\r' || *sql == '\n' )
+                            sql++;
+
+                        uint64_t line = LineAt(m_file, chunkOffset + ( sql - chunk.c_str() ));
+                        error = stop.stop_requested()
+                            ? "Cancelled at line " + std::to_string(line)
+                            : "Line " + std::to_string(line) + ": " + sqlite3_errmsg(m_db);
+                        sqlite3_finalize(stmt);
+                        return false;
+                    }
+
+                    sqlite3_finalize(stmt);
+                    sql = tail;
+                    m_progress.bytesDone = chunkOffset + ( sql - chunk.c_str() );
+
+                    if ( stop.stop_requested() ) {
+                        error = "Cancelled at line " + std::to_string(LineAt(m_file, m_progress.bytesDone));
+                        return false;
+                    }
+
+                    if ( m_onProgress && Elapsed() - m_lastReport >= SCRIPT_REPORT_INTERVAL )
+                        Report();
+                }
+            }
+
+            return true;
+        }
+
+        void Report() {
+            m_progress.rowsChanged = sqlite3_total_changes64(m_db) - m_changesBefore;
+            m_progress.elapsedSeconds = m_lastReport = Elapsed();
+            if ( m_onProgress )
+                m_onProgress(m_progress);
+        }
+    private:
+        double Elapsed() const {
+            return std::chrono::duration<double>(std::chrono::steady_clock::now() - m_start).count();
+        }
+
+        sqlite3* m_db;
+        const MappedFile& m_file;
+        const std::function<void(const ScriptProgress&)>& m_onProgress;
+        std::chrono::steady_clock::time_point m_start;
+        sqlite3_int64 m_changesBefore;
+        double m_lastReport = -SCRIPT_REPORT_INTERVAL;
+        ScriptProgress m_progress;
+    };
+
+    /*
+        The first 'count' keywords of a statement, upper cased and separated
+        by single spaces, skipping leading whitespace and comments.
+        Enough to tell "CREATE INDEX" from "CREATE UNIQUE INDEX".
+    */
+    std::string LeadingKeywords(const char* sql, int count) {
+        std::string keywords;
+
+        while ( *sql && count > 0 ) {
+            if ( std::isspace(static_cast<unsigned char>(*sql)) ) {
+                sql++;
+            } else if ( sql[0] == '-' && sql[1] == '-' ) {
+                while ( *sql && *sql != '\n' )
+                    sql++;
+            } else if ( sql[0] == '/' && sql[1] == '*' ) {
+                const char* end = std::strstr(sql + 2, "*/");
+                sql = end ? end + 2 : sql + std::strlen(sql);
+            } else if ( std::isalpha(static_cast<unsigned char>(*sql)) ) {
+                if ( !keywords.empty() )
+                    keywords += ' ';
+                while ( std::isalpha(static_cast<unsigned char>(*sql)) )
+                    keywords += static_cast<char>(std::toupper(static_cast<unsigned char>(*sql++)));
+                count--;
+            } else {
+                break;
+            }
+        }
+
+        return keywords;
+    }
+
+    int ExecPragma(sqlite3* db, const std::string& pragma) {
+        return sqlite3_exec(db, ( "PRAGMA " + pragma + ";" ).c_str(), NULL, NULL, NULL);
+    }
+
+    sqlite3_int64 ReadPragma(sqlite3* db, const char* pragma) {
+        sqlite3_int64 value = 0;
+        sqlite3_stmt* stmt;
+        if ( sqlite3_prepare_v2(db, ( std::string("PRAGMA ") + pragma + ";" ).c_str(), -1, &stmt, NULL) == SQLITE_OK ) {
+            if ( sqlite3_step(stmt) == SQLITE_ROW )
+                value = sqlite3_column_int64(stmt, 0);
+            sqlite3_finalize(stmt);
+        }
+        return value;
+    }
+}
+
+bool DataStore::ExecuteScript(
+    const std::string& scriptPath,
+    std::string& error,
+    const std::function<void(const ScriptProgress&)>& onProgress,
+    std::stop_token stop
+)
+{
+    error.clear();
+    if ( !this->m_connected ) {
+        error = "No database is open";
+        return false;
+    }
+
+    MappedFile file;
+    if ( !file.Open(scriptPath) ) {
+        error = "Could not open '" + scriptPath + "'";
+        return false;
+    }
+
+    // Aborts the statement running when the stop is requested, rather than
+    // waiting for a long CREATE INDEX or INSERT ... SELECT to finish
+    std::stop_callback interrupt(stop, [this]() { sqlite3_interrupt(this->m_db); });
+
+    ScriptRunner runner(this->m_db, file, onProgress);
+    bool ok = runner.Run(StepToEnd, error, stop);
+
+    // Don't leave the data base locked by a transaction the script never finished
+    if ( !ok && !sqlite3_get_autocommit(this->m_db) )
+        sqlite3_exec(this->m_db, "ROLLBACK;", NULL, NULL, NULL);
+
+    runner.Report();
+    return ok;
+}
+
+bool DataStore::ImportDump(
+    const std::string& dumpPath,
+    uint64_t& foreignKeyViolations,
+    std::string& error,
+    const std::function<void(const ScriptProgress&)>& onProgress,
+    std::stop_token stop
+)
+{
+    foreignKeyViolations = 0;
+    error.clear();
+    if ( !this->m_connected ) {
+        error = "No database is open";
+        return false;
+    }
+
+    if ( !sqlite3_get_autocommit(this->m_db) ) {
+        error = "A transaction is already open";
+        return false;
+    }
+
+    MappedFile file;
+    if ( !file.Open(dumpPath) ) {
+        error = "Could not open '" + dumpPath + "'";
+        return false;
+    }
+
+    // Both can only be changed outside a transaction, and are put back afterwards
+    sqlite3_int64 foreignKeys = ReadPragma(this->m_db, "foreign_keys");
+    sqlite3_int64 cacheSize = ReadPragma(this->m_db, "cache_size");
+    ExecPragma(this->m_db, "foreign_keys=OFF");
+    ExecPragma(this->m_db, "cache_size=" + std::to_string(-DUMP_CACHE_KIB));
+
+    std::stop_callback interrupt(stop, [this]() { sqlite3_interrupt(this->m_db); });
+
+    std::vector<std::string> deferredIndexes;
+    int batchStatements = 0;
+
+    auto handle = [this, &deferredIndexes, &batchStatements](sqlite3_stmt* stmt) {
+        std::string keywords = LeadingKeywords(sqlite3_sql(stmt), 2);
+
+        // Dumps wrap everything in one transaction, the import commits in batches instead
+        std::string first = keywords.substr(0, keywords.find(' '));
+        if ( first == "BEGIN" || first == "COMMIT" || first == "END" || first == "ROLLBACK" )
+            return SQLITE_OK;
+
+        // Building an index once over all rows is much faster than updating
+        // it row by row. Unique indexes are kept, they decide what inserts do.
+        if ( keywords == "CREATE INDEX" ) {
+            deferredIndexes.push_back(sqlite3_sql(stmt));
+            return SQLITE_OK;
+        }
+
+        int res = StepToEnd(stmt);
+        if ( res == SQLITE_OK && ++batchStatements >= DUMP_BATCH_STATEMENTS ) {
+            batchStatements = 0;
+            res = sqlite3_exec(this->m_db, "COMMIT; BEGIN;", NULL, NULL, NULL);
+        }
+        return res;
+    };
+
+    ScriptRunner runner(this->m_db, file, onProgress);
+    bool ok = sqlite3_exec(this->m_db, "BEGIN;", NULL, NULL, NULL) == SQLITE_OK && runner.Run(handle, error, stop);
+
+    // Batches already committed stay, only the one in progress is undone
+    if ( !sqlite3_get_autocommit(this->m_db) )
+        sqlite3_exec(this->m_db, ok ? "COMMIT;" : "ROLLBACK;", NULL, NULL, NULL);
+
+    if ( ok && !deferredIndexes.empty() ) {
+        ok = sqlite3_exec(this->m_db, "BEGIN;", NULL, NULL, NULL) == SQLITE_OK;
+        for ( size_t i = 0; ok && i < deferredIndexes.size(); i++ ) {
+            ok = sqlite3_exec(this->m_db, deferredIndexes[i].c_str(), NULL, NULL, NULL) == SQLITE_OK;
+            if ( !ok )
+                error = stop.stop_requested() ? "Cancelled while creating indexes" : std::string("Creating index: ") + sqlite3_errmsg(this->m_db);
+        }
+        sqlite3_exec(this->m_db, ok ? "COMMIT;" : "ROLLBACK;", NULL, NULL, NULL);
+    }
+
+    ExecPragma(this->m_db, "cache_size=" + std::to_string(cacheSize));
+    if ( foreignKeys ) {
+        ExecPragma(this->m_db, "foreign_keys=ON");
+
+        // Rows were inserted unchecked, count what enforcement would have rejected
+        sqlite3_stmt* check;
+        if ( ok && sqlite3_prepare_v2(this->m_db, "PRAGMA foreign_key_check;", -1, &check, NULL) == SQLITE_OK ) {
+            while ( sqlite3_step(check) == SQLITE_ROW )
+                foreignKeyViolations++;
+            sqlite3_finalize(check);
+        }
+    }
+
+    runner.Report();
+    return ok;
+}
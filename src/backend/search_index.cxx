@@ -0,0 +1,292 @@
+// Backend
+#include "backend/search_index.hxx"
+#include "backend/data_store.hxx"
+
+// STD
+#include <algorithm>
+#include <unordered_map>
+
+namespace {
+    constexpr size_t MIN_TOKEN_LENGTH = 2;
+    constexpr size_t MAX_TOKEN_LENGTH = 64;
+    constexpr int SNIPPET_LENGTH = 80;
+    constexpr int STOP_CHECK_INTERVAL = 4096; // Rows between checks for a stop request
+
+    bool IsTokenByte(unsigned char byte) {
+        // Bytes of multi byte UTF-8 sequences are kept, so non-ASCII words are tokens too
+        return byte >= 0x80 || ( byte >= '0' && byte <= '9' ) || ( byte >= 'a' && byte <= 'z' ) || ( byte >= 'A' && byte <= 'Z' );
+    }
+
+    // Calls 'onToken' with every lower cased word of 'text'
+    template <typename Callback>
+    void Tokenize(const char* text, size_t length, Callback onToken) {
+        std::string token;
+        for ( size_t i = 0; i <= length; i++ ) {
+            unsigned char byte = i < length ? static_cast<unsigned char>(text[i]) : ' ';
+            if ( IsTokenByte(byte) ) {
+                if ( token.size() < MAX_TOKEN_LENGTH )
+                    token += static_cast<char>(byte >= 'A' && byte <= 'Z' ? byte + ( 'a' - 'A' ) : byte);
+                continue;
+            }
+
+            if ( token.size() >= MIN_TOKEN_LENGTH )
+                onToken(token);
+            token.clear();
+        }
+    }
+
+    // The VFS comes from the caller, 'path' may be a URI that can't be sniffed for an archive
+    sqlite3* OpenReadOnly(const std::string& path, const char* vfs) {
+        sqlite3* db = nullptr;
+        // URIs let DataStore::GetReadPath name a data base opened in memory
+        if ( sqlite3_open_v2(path.c_str(), &db, SQLITE_OPEN_READONLY | SQLITE_OPEN_NOMUTEX | SQLITE_OPEN_URI, vfs) != SQLITE_OK ) {
+            sqlite3_close(db);
+            return nullptr;
+        }
+        return db;
+    }
+
+    // Schema SQL and max(rowid), which change when a table is altered or appended to
+    std::string Fingerprint(sqlite3* db, const std::string& tableName, const std::string& sql) {
+        std::string fingerprint = sql;
+        sqlite3_stmt* stmt;
+        std::string query = "SELECT max(rowid) FROM " + DataStore::QuoteIdentifier(tableName) + ";";
+        if ( sqlite3_prepare_v2(db, query.c_str(), -1, &stmt, NULL) == SQLITE_OK ) {
+            if ( sqlite3_step(stmt) == SQLITE_ROW )
+                fingerprint += '\x1F' + std::to_string(sqlite3_column_int64(stmt, 0));
+            sqlite3_finalize(stmt);
+        }
+        return fingerprint;
+    }
+}
+
+bool SearchIndex::Refresh(const std::string& dbPath, const char* vfs, std::stop_token stop) {
+    if ( dbPath != m_dbPath || vfs != m_vfs ) {
+        Clear();
+        m_dbPath = dbPath;
+        m_vfs = vfs;
+    }
+
+    sqlite3* db = OpenReadOnly(dbPath, vfs);
+    if ( !db )
+        return false;
+
+    // Virtual tables may read other files or be slow to scan, they aren't indexed
+    std::map<std::string, std::string> catalog;
+    sqlite3_stmt* stmt;
+    const char* query = "SELECT name, sql FROM sqlite_master WHERE type='table' AND name NOT LIKE 'sqlite_%' AND sql NOT LIKE 'CREATE VIRTUAL%';";
+    if ( sqlite3_prepare_v2(db, query, -1, &stmt, NULL) != SQLITE_OK ) {
+        sqlite3_close(db);
+        return false;
+    }
+
+    while ( sqlite3_step(stmt) == SQLITE_ROW ) {
+        const unsigned char* sql = sqlite3_column_text(stmt, 1);
+        catalog[reinterpret_cast<const char*>(sqlite3_column_text(stmt, 0))] = sql ? reinterpret_cast<const char*>(sql) : "";
+    }
+    sqlite3_finalize(stmt);
+
+    // Dropped tables
+    for ( auto table = m_tables.begin(); table != m_tables.end(); ) {
+        if ( catalog.count(table->first) )
+            table++;
+        else
+            table = m_tables.erase(table);
+    }
+
+    std::unordered_set<std::string> dirty;
+    {
+        std::lock_guard<std::mutex> lock(m_dirtyMutex);
+        dirty.swap(m_dirty);
+    }
+
+    bool ok = true;
+    for ( const auto& [name, sql] : catalog ) {
+        if ( stop.stop_requested() ) {
+            ok = false;
+            break;
+        }
+
+        std::string fingerprint = Fingerprint(db, name, sql);
+        auto existing = m_tables.find(name);
+        if ( existing != m_tables.end() && existing->second.fingerprint == fingerprint && !dirty.count(name) )
+            continue;
+
+        TableIndex index;
+        index.fingerprint = fingerprint;
+        if ( IndexTable(db, name, index, stop) )
+            m_tables[name] = std::move(index);
+        else
+            m_tables.erase(name);
+    }
+
+    // Tables not reached before a stop are tried again next time
+    if ( !ok ) {
+        std::lock_guard<std::mutex> lock(m_dirtyMutex);
+        m_dirty.insert(dirty.begin(), dirty.end());
+    }
+
+    sqlite3_close(db);
+    return ok;
+}
+
+bool SearchIndex::IndexTable(sqlite3* db, const std::string& tableName, TableIndex& index, std::stop_token stop) {
+    // WITHOUT ROWID tables fail to prepare here. Hits couldn't be shown without a rowid anyway
+    sqlite3_stmt* stmt;
+    std::string query = "SELECT rowid, * FROM " + DataStore::QuoteIdentifier(tableName) + ";";
+    if ( sqlite3_prepare_v2(db, query.c_str(), -1, &stmt, NULL) != SQLITE_OK )
+        return true;
+
+    int columnCount = sqlite3_column_count(stmt);
+    for ( int col = 1; col < columnCount; col++ )
+        index.columns.emplace_back(sqlite3_column_name(stmt, col));
+
+    std::unordered_map<std::string, std::vector<Posting>> postings;
+    uint64_t row = 0;
+    int res;
+
+    while ( ( res = sqlite3_step(stmt) ) == SQLITE_ROW ) {
+        if ( ++row % STOP_CHECK_INTERVAL == 0 && stop.stop_requested() )
+            break;
+
+        sqlite3_int64 rowId = sqlite3_column_int64(stmt, 0);
+        for ( int col = 1; col < columnCount; col++ ) {
+            if ( sqlite3_column_type(stmt, col) != SQLITE_TEXT )
+                continue;
+
+            const char* text = reinterpret_cast<const char*>(sqlite3_column_text(stmt, col));
+            size_t length = std::min<size_t>(sqlite3_column_bytes(stmt, col), MAX_INDEXED_TEXT);
+            Posting posting{ static_cast<uint32_t>(col - 1), rowId };
+
+            Tokenize(text, length, [&postings, &posting](const std::string& token) {
+                std::vector<Posting>& list = postings[token];
+                // A word repeated in one cell is only listed once
+                if ( list.empty() || list.back().rowId != posting.rowId || list.back().column != posting.column )
+                    list.push_back(posting);
+            });
+        }
+    }
+
+    sqlite3_finalize(stmt);
+    if ( res != SQLITE_DONE )
+        return false;
+
+    // Sorted tokens allow prefix searches with a binary search
+    std::vector<std::pair<std::string, std::vector<Posting>>> sorted(
+        std::make_move_iterator(postings.begin()),
+        std::make_move_iterator(postings.end())
+    );
+    std::sort(sorted.begin(), sorted.end(), [](const auto& a, const auto& b) { return a.first < b.first; });
+
+    index.tokens.reserve(sorted.size());
+    index.postings.reserve(sorted.size());
+    for ( auto& [token, list] : sorted ) {
+        index.tokens.push_back(std::move(token));
+        list.shrink_to_fit();
+        index.postings.push_back(std::move(list));
+    }
+
+    return true;
+}
+
+std::vector<SearchIndex::Posting> SearchIndex::Match(const TableIndex& index, const std::string& token, bool prefix) const {
+    std::vector<Posting> matches;
+    auto first = std::lower_bound(index.tokens.begin(), index.tokens.end(), token);
+
+    for ( auto it = first; it != index.tokens.end(); it++ ) {
+        bool matched = prefix ? it->compare(0, token.size(), token) == 0 : *it == token;
+        if ( !matched )
+            break;
+
+        const std::vector<Posting>& list = index.postings[it - index.tokens.begin()];
+        matches.insert(matches.end(), list.begin(), list.end());
+        if ( !prefix )
+            break;
+    }
+
+    // Postings of several tokens were merged, restore rowid order
+    if ( prefix )
+        std::sort(matches.begin(), matches.end(), [](const Posting& a, const Posting& b) {
+            return a.rowId < b.rowId || ( a.rowId == b.rowId && a.column < b.column );
+        });
+
+    return matches;
+}
+
+std::vector<SearchHit> SearchIndex::Search(const std::string& query, size_t maxHits) {
+    std::vector<SearchHit> hits;
+
+    std::vector<std::string> words;
+    Tokenize(query.data(), query.size(), [&words](const std::string& token) { words.push_back(token); });
+    if ( words.empty() )
+        return hits;
+
+    for ( const auto& [name, index] : m_tables ) {
+        // Rows containing every word. The last word may still be being typed, so it matches as a prefix
+        std::vector<Posting> rows = Match(index, words.front(), words.size() == 1);
+        for ( size_t i = 1; i < words.size() && !rows.empty(); i++ ) {
+            std::vector<Posting> next = Match(index, words[i], i + 1 == words.size());
+            std::vector<Posting> kept;
+            auto other = next.begin();
+            for ( const Posting& posting : rows ) {
+                while ( other != next.end() && other->rowId < posting.rowId )
+                    other++;
+                if ( other != next.end() && other->rowId == posting.rowId )
+                    kept.push_back(posting);
+            }
+            rows.swap(kept);
+        }
+
+        for ( size_t i = 0; i < rows.size() && hits.size() < maxHits; i++ ) {
+            // One hit per row, at the first column matching the first word
+            if ( i > 0 && rows[i].rowId == rows[i - 1].rowId )
+                continue;
+            hits.push_back({ name, index.columns[rows[i].column], rows[i].rowId, {} });
+        }
+
+        if ( hits.size() >= maxHits )
+            break;
+    }
+
+    // Snippets are read back from the file, only for the hits shown
+    sqlite3* db = OpenReadOnly(m_dbPath, m_vfs);
+    if ( !db )
+        return hits;
+
+    for ( SearchHit& hit : hits ) {
+        sqlite3_stmt* stmt;
+        std::string sql = "SELECT substr(" + DataStore::QuoteIdentifier(hit.column) + ", 1, " + std::to_string(SNIPPET_LENGTH)
+            + ") FROM " + DataStore::QuoteIdentifier(hit.table) + " WHERE rowid = ?;";
+        if ( sqlite3_prepare_v2(db, sql.c_str(), -1, &stmt, NULL) != SQLITE_OK )
+            continue;
+
+        sqlite3_bind_int64(stmt, 1, hit.rowId);
+        if ( sqlite3_step(stmt) == SQLITE_ROW && sqlite3_column_type(stmt, 0) == SQLITE_TEXT )
+            hit.snippet = reinterpret_cast<const char*>(sqlite3_column_text(stmt, 0));
+        sqlite3_finalize(stmt);
+    }
+
+    sqlite3_close(db);
+    return hits;
+}
+
+void SearchIndex::MarkDirty(const std::string& tableName) {
+    std::lock_guard<std::mutex> lock(m_dirtyMutex);
+    m_dirty.insert(tableName);
+}
+
+void SearchIndex::Clear() {
+    m_tables.clear();
+    m_dbPath.clear();
+    m_vfs = nullptr;
+
+    std::lock_guard<std::mutex> lock(m_dirtyMutex);
+    m_dirty.clear();
+}
+
+size_t SearchIndex::TokenCount() const {
+    size_t count = 0;
+    for ( const auto& [name, index] : m_tables )
+        count += index.tokens.size();
+    return count;
+}
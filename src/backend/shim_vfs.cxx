@@ -0,0 +1,192 @@
+// Backend
+#include "backend/shim_vfs.hxx"
+
+// STD
+#include <algorithm>
+
+namespace {
+    sqlite3_file* Real(sqlite3_file* file) {
+        return ShimRealFile(file);
+    }
+
+    int Close(sqlite3_file* file) {
+        return Real(file)->pMethods->xClose(Real(file));
+    }
+
+    int Read(sqlite3_file* file, void* buffer, int amount, sqlite3_int64 offset) {
+        return Real(file)->pMethods->xRead(Real(file), buffer, amount, offset);
+    }
+
+    int Write(sqlite3_file* file, const void* buffer, int amount, sqlite3_int64 offset) {
+        return Real(file)->pMethods->xWrite(Real(file), buffer, amount, offset);
+    }
+
+    int Truncate(sqlite3_file* file, sqlite3_int64 size) {
+        return Real(file)->pMethods->xTruncate(Real(file), size);
+    }
+
+    int Sync(sqlite3_file* file, int flags) {
+        return Real(file)->pMethods->xSync(Real(file), flags);
+    }
+
+    int FileSize(sqlite3_file* file, sqlite3_int64* size) {
+        return Real(file)->pMethods->xFileSize(Real(file), size);
+    }
+
+    int Lock(sqlite3_file* file, int level) {
+        return Real(file)->pMethods->xLock(Real(file), level);
+    }
+
+    int Unlock(sqlite3_file* file, int level) {
+        return Real(file)->pMethods->xUnlock(Real(file), level);
+    }
+
+    int CheckReservedLock(sqlite3_file* file, int* reserved) {
+        return Real(file)->pMethods->xCheckReservedLock(Real(file), reserved);
+    }
+
+    int FileControl(sqlite3_file* file, int op, void* arg) {
+        return Real(file)->pMethods->xFileControl(Real(file), op, arg);
+    }
+
+    int SectorSize(sqlite3_file* file) {
+        return Real(file)->pMethods->xSectorSize(Real(file));
+    }
+
+    int DeviceCharacteristics(sqlite3_file* file) {
+        return Real(file)->pMethods->xDeviceCharacteristics(Real(file));
+    }
+
+    int ShmMap(sqlite3_file* file, int region, int size, int extend, void volatile** mapped) {
+        return Real(file)->pMethods->xShmMap(Real(file), region, size, extend, mapped);
+    }
+
+    int ShmLock(sqlite3_file* file, int offset, int count, int flags) {
+        return Real(file)->pMethods->xShmLock(Real(file), offset, count, flags);
+    }
+
+    void ShmBarrier(sqlite3_file* file) {
+        Real(file)->pMethods->xShmBarrier(Real(file));
+    }
+
+    int ShmUnmap(sqlite3_file* file, int deleteFlag) {
+        return Real(file)->pMethods->xShmUnmap(Real(file), deleteFlag);
+    }
+
+    int Fetch(sqlite3_file* file, sqlite3_int64 offset, int amount, void** page) {
+        return Real(file)->pMethods->xFetch(Real(file), offset, amount, page);
+    }
+
+    int Unfetch(sqlite3_file* file, sqlite3_int64 offset, void* page) {
+        return Real(file)->pMethods->xUnfetch(Real(file), offset, page);
+    }
+
+    int Delete(sqlite3_vfs* vfs, const char* name, int syncDir) {
+        return ShimRealVfs(vfs)->xDelete(ShimRealVfs(vfs), name, syncDir);
+    }
+
+    int Access(sqlite3_vfs* vfs, const char* name, int flags, int* result) {
+        return ShimRealVfs(vfs)->xAccess(ShimRealVfs(vfs), name, flags, result);
+    }
+
+    int FullPathname(sqlite3_vfs* vfs, const char* name, int size, char* out) {
+        return ShimRealVfs(vfs)->xFullPathname(ShimRealVfs(vfs), name, size, out);
+    }
+
+    void* DlOpen(sqlite3_vfs* vfs, const char* name) {
+        return ShimRealVfs(vfs)->xDlOpen(ShimRealVfs(vfs), name);
+    }
+
+    void DlError(sqlite3_vfs* vfs, int size, char* message) {
+        ShimRealVfs(vfs)->xDlError(ShimRealVfs(vfs), size, message);
+    }
+
+    void (*DlSym(sqlite3_vfs* vfs, void* handle, const char* symbol))(void) {
+        return ShimRealVfs(vfs)->xDlSym(ShimRealVfs(vfs), handle, symbol);
+    }
+
+    void DlClose(sqlite3_vfs* vfs, void* handle) {
+        ShimRealVfs(vfs)->xDlClose(ShimRealVfs(vfs), handle);
+    }
+
+    int Randomness(sqlite3_vfs* vfs, int size, char* out) {
+        return ShimRealVfs(vfs)->xRandomness(ShimRealVfs(vfs), size, out);
+    }
+
+    int Sleep(sqlite3_vfs* vfs, int micros) {
+        return ShimRealVfs(vfs)->xSleep(ShimRealVfs(vfs), micros);
+    }
+
+    int CurrentTime(sqlite3_vfs* vfs, double* time) {
+        return ShimRealVfs(vfs)->xCurrentTime(ShimRealVfs(vfs), time);
+    }
+
+    int GetLastError(sqlite3_vfs* vfs, int size, char* message) {
+        return ShimRealVfs(vfs)->xGetLastError(ShimRealVfs(vfs), size, message);
+    }
+
+    int CurrentTimeInt64(sqlite3_vfs* vfs, sqlite3_int64* time) {
+        return ShimRealVfs(vfs)->xCurrentTimeInt64(ShimRealVfs(vfs), time);
+    }
+
+    int SetSystemCall(sqlite3_vfs* vfs, const char* name, sqlite3_syscall_ptr call) {
+        return ShimRealVfs(vfs)->xSetSystemCall(ShimRealVfs(vfs), name, call);
+    }
+
+    sqlite3_syscall_ptr GetSystemCall(sqlite3_vfs* vfs, const char* name) {
+        return ShimRealVfs(vfs)->xGetSystemCall(ShimRealVfs(vfs), name);
+    }
+
+    const char* NextSystemCall(sqlite3_vfs* vfs, const char* name) {
+        return ShimRealVfs(vfs)->xNextSystemCall(ShimRealVfs(vfs), name);
+    }
+}
+
+/**
+ * @brief Sets up 'vfs' as a shim over 'real'.
+ *
+ * Optional methods 'real' lacks are left out of 'vfs' too, so SQLite
+ * falls back the same way it would for 'real'.
+ *
+ * @param vfs  The shim's VFS, not yet registered.
+ * @param real VFS the shim forwards to.
+ * @param name Name to register the shim under.
+ * @param open The shim's xOpen.
+ */
+void InitShimVfs(sqlite3_vfs& vfs, sqlite3_vfs* real, const char* name, ShimOpen open) {
+    vfs = {};
+    vfs.iVersion = std::min(real->iVersion, 3);
+    vfs.szOsFile = static_cast<int>(sizeof(ShimFile)) + real->szOsFile;
+    vfs.mxPathname = real->mxPathname;
+    vfs.zName = name;
+    vfs.pAppData = real;
+    vfs.xOpen = open;
+    vfs.xDelete = Delete;
+    vfs.xAccess = Access;
+    vfs.xFullPathname = FullPathname;
+    vfs.xDlOpen = real->xDlOpen ? DlOpen : nullptr;
+    vfs.xDlError = real->xDlError ? DlError : nullptr;
+    vfs.xDlSym = real->xDlSym ? DlSym : nullptr;
+    vfs.xDlClose = real->xDlClose ? DlClose : nullptr;
+    vfs.xRandomness = Randomness;
+    vfs.xSleep = Sleep;
+    vfs.xCurrentTime = CurrentTime;
+    vfs.xGetLastError = GetLastError;
+    if ( vfs.iVersion >= 2 )
+        vfs.xCurrentTimeInt64 = real->xCurrentTimeInt64 ? CurrentTimeInt64 : nullptr;
+    if ( vfs.iVersion >= 3 ) {
+        vfs.xSetSystemCall = real->xSetSystemCall ? SetSystemCall : nullptr;
+        vfs.xGetSystemCall = real->xGetSystemCall ? GetSystemCall : nullptr;
+        vfs.xNextSystemCall = real->xNextSystemCall ? NextSystemCall : nullptr;
+    }
+}
+
+sqlite3_io_methods ShimForwardingMethods(int version) {
+    return {
+        version, Close, Read, Write, Truncate, Sync, FileSize, Lock, Unlock, CheckReservedLock,
+        FileControl, SectorSize, DeviceCharacteristics,
+        version >= 2 ? ShmMap : nullptr, version >= 2 ? ShmLock : nullptr,
+        version >= 2 ? ShmBarrier : nullptr, version >= 2 ? ShmUnmap : nullptr,
+        version >= 3 ? Fetch : nullptr, version >= 3 ? Unfetch : nullptr
+    };
+}
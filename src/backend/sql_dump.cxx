@@ -0,0 +1,426 @@
+// Backend
+#include "backend/data_store.hxx"
+
+// STD
+#include <atomic>
+#include <charconv>
+#include <chrono>
+#include <cmath>
+#include <condition_variable>
+#include <cstdio>
+#include <cstring>
+#include <latch>
+#include <mutex>
+#include <ostream>
+#include <string_view>
+#include <thread>
+#include <unordered_set>
+
+namespace {
+    constexpr size_t SEGMENT_BUFFER_SIZE = 1 << 20; // Generated SQL kept in memory before a table spills to its temporary file
+    constexpr size_t INSERT_MAX_ROWS = 1000; // Rows per multi-row INSERT
+    constexpr size_t INSERT_MAX_BYTES = 1 << 20; // Text per multi-row INSERT, whichever limit comes first
+    constexpr int STOP_CHECK_INTERVAL = 4096; // Rows between checks for a stop request
+    constexpr int WORKER_BUSY_TIMEOUT_MS = 5000; // Wait for a writer to let go when workers start their read transactions
+    constexpr auto DUMP_REPORT_INTERVAL = std::chrono::milliseconds(100);
+
+    /*
+        The SQL of one table, generated by a worker and appended
+        to the output by the calling thread.
+    */
+    struct Segment {
+        enum class Kind {
+            Table,    // CREATE TABLE and its rows
+            Sequence, // sqlite_sequence, can't be created, only emptied and refilled
+            Shadow,   // Shadow table of a virtual table, created along with it
+            Virtual,  // CREATE VIRTUAL TABLE only, its content lives in the shadow tables
+        };
+
+        Kind kind;
+        std::string table;
+        std::string sql; // As stored in sqlite_schema
+
+        // Written by the worker, read once 'done' is set
+        std::string text; // Everything generated, unless it spilled
+        std::FILE* spill = nullptr; // Temporary file holding everything generated, once larger than SEGMENT_BUFFER_SIZE
+        bool done = false;
+        bool failed = false;
+    };
+
+    // Appends a REAL so it reads back as the same REAL. Shortest form
+    // that round trips, with ".0" added to whole numbers so they don't
+    // read back as INTEGER.
+    void AppendReal(std::string& out, double value) {
+        if ( std::isinf(value) ) {
+            out += value < 0 ? "-1e999" : "1e999";
+            return;
+        }
+        if ( std::isnan(value) ) {
+            out += "NULL";
+            return;
+        }
+
+        char text[32];
+        char* end = std::to_chars(text, text + sizeof(text), value).ptr;
+        out.append(text, end);
+        if ( std::string_view(text, end - text).find_first_of(".e") == std::string_view::npos )
+            out += ".0";
+    }
+
+    void AppendHex(std::string& out, const void* data, int length) {
+        static const char digits[] = "0123456789ABCDEF";
+        const unsigned char* bytes = static_cast<const unsigned char*>(data);
+
+        for ( int i = 0; i < length; i++ ) {
+            out += digits[bytes[i] >> 4];
+            out += digits[bytes[i] & 0xF];
+        }
+    }
+
+    void AppendLiteral(std::string& out, sqlite3_stmt* stmt, int col) {
+        switch ( sqlite3_column_type(stmt, col) ) {
+        case SQLITE_NULL:
+            out += "NULL";
+            break;
+        case SQLITE_INTEGER: {
+            char text[24];
+            char* end = std::to_chars(text, text + sizeof(text), sqlite3_column_int64(stmt, col)).ptr;
+            out.append(text, end);
+            break;
+        }
+        case SQLITE_FLOAT:
+            AppendReal(out, sqlite3_column_double(stmt, col));
+            break;
+        case SQLITE_TEXT: {
+            const char* text = reinterpret_cast<const char*>(sqlite3_column_text(stmt, col));
+            int length = sqlite3_column_bytes(stmt, col);
+
+            // A quoted literal would end at an embedded NUL
+            if ( std::memchr(text, '\0', length) ) {
+                out += "CAST(X'";
+                AppendHex(out, text, length);
+                out += "' AS TEXT)";
+                break;
+            }
+
+            out += '\'';
+            for ( int i = 0; i < length; i++ ) {
+                if ( text[i] == '\'' )
+                    out += '\'';
+                out += text[i];
+            }
+            out += '\'';
+            break;
+        }
+        case SQLITE_BLOB:
+            out += "X'";
+            AppendHex(out, sqlite3_column_blob(stmt, col), sqlite3_column_bytes(stmt, col));
+            out += '\'';
+            break;
+        }
+    }
+
+    // Moves the generated text of 'segment' to its temporary file, creating it if needed
+    bool Spill(Segment& segment) {
+        if ( !segment.spill && !( segment.spill = std::tmpfile() ) )
+            return false;
+
+        bool ok = std::fwrite(segment.text.data(), 1, segment.text.size(), segment.spill) == segment.text.size();
+        segment.text.clear();
+        return ok;
+    }
+
+    /*
+        Generates the SQL recreating one table: its CREATE statement, or
+        what stands in for it, followed by its rows as multi-row INSERTs.
+        Generated columns are left out, they are computed again on insert.
+    */
+    bool GenerateSegment(sqlite3* db, Segment& segment, std::atomic<uint64_t>& rows, const std::atomic<bool>& abort) {
+        std::string table = DataStore::QuoteIdentifier(segment.table);
+
+        switch ( segment.kind ) {
+        case Segment::Kind::Table:
+        case Segment::Kind::Virtual:
+            segment.text = segment.sql + ";\n";
+            break;
+        case Segment::Kind::Sequence:
+        case Segment::Kind::Shadow:
+            segment.text = "DELETE FROM " + table + ";\n";
+            break;
+        }
+
+        if ( segment.kind == Segment::Kind::Virtual )
+            return true;
+
+        // hidden is 2 or 3 for generated columns
+        sqlite3_stmt* stmt;
+        if ( sqlite3_prepare_v2(db, "SELECT name, hidden FROM pragma_table_xinfo(?) ORDER BY cid;", -1, &stmt, NULL) != SQLITE_OK )
+            return false;
+
+        sqlite3_bind_text(stmt, 1, segment.table.c_str(), -1, SQLITE_TRANSIENT);
+
+        std::string columns;
+        bool skippedColumns = false;
+        while ( sqlite3_step(stmt) == SQLITE_ROW ) {
+            if ( sqlite3_column_int(stmt, 1) >= 2 ) {
+                skippedColumns = true;
+                continue;
+            }
+
+            columns += ( columns.empty() ? "" : "," ) + DataStore::QuoteIdentifier(reinterpret_cast<const char*>(sqlite3_column_text(stmt, 0)));
+        }
+        sqlite3_finalize(stmt);
+
+        if ( columns.empty() )
+            return false;
+
+        std::string insert = "INSERT INTO " + table + ( skippedColumns ? "(" + columns + ")" : "" ) + " VALUES";
+        std::string query = "SELECT " + columns + " FROM " + table + ";";
+        if ( sqlite3_prepare_v2(db, query.c_str(), -1, &stmt, NULL) != SQLITE_OK )
+            return false;
+
+        int columnCount = sqlite3_column_count(stmt);
+        size_t statementRows = 0;
+        size_t statementStart = segment.text.size(); // Where the open INSERT starts in 'text', 0 once part of it spilled
+        size_t spilled = 0; // Bytes of the open INSERT already in the temporary file
+        uint64_t row = 0;
+        bool ok = true;
+
+        int res = SQLITE_OK;
+        while ( ok && ( res = sqlite3_step(stmt) ) == SQLITE_ROW ) {
+            if ( statementRows == 0 ) {
+                statementStart = segment.text.size();
+                spilled = 0;
+                segment.text += insert;
+            } else {
+                segment.text += ',';
+            }
+
+            segment.text += '(';
+            for ( int col = 0; col < columnCount; col++ ) {
+                if ( col > 0 )
+                    segment.text += ',';
+                AppendLiteral(segment.text, stmt, col);
+            }
+            segment.text += ')';
+
+            if ( ++statementRows == INSERT_MAX_ROWS || spilled + segment.text.size() - statementStart >= INSERT_MAX_BYTES ) {
+                segment.text += ";\n";
+                statementRows = 0;
+            }
+
+            if ( segment.text.size() >= SEGMENT_BUFFER_SIZE ) {
+                spilled += segment.text.size() - statementStart;
+                statementStart = 0;
+                ok = Spill(segment);
+            }
+
+            if ( ++row % STOP_CHECK_INTERVAL == 0 ) {
+                rows += STOP_CHECK_INTERVAL;
+                ok = ok && !abort;
+            }
+        }
+
+        rows += row % STOP_CHECK_INTERVAL;
+        sqlite3_finalize(stmt);
+
+        if ( statementRows )
+            segment.text += ";\n";
+
+        if ( ok && segment.spill )
+            ok = Spill(segment) && std::fflush(segment.spill) == 0 && std::fseek(segment.spill, 0, SEEK_SET) == 0;
+
+        return ok && res == SQLITE_DONE;
+    }
+
+    // Appends a finished segment to 'out' and frees it
+    bool WriteSegment(Segment& segment, std::ostream& out, uint64_t& bytesWritten) {
+        if ( !segment.spill ) {
+            out.write(segment.text.data(), segment.text.size());
+            bytesWritten += segment.text.size();
+            segment.text = std::string();
+            return out.good();
+        }
+
+        std::string block(SEGMENT_BUFFER_SIZE, '\0');
+        size_t count;
+        while ( out && ( count = std::fread(block.data(), 1, block.size(), segment.spill) ) > 0 ) {
+            out.write(block.data(), count);
+            bytesWritten += count;
+        }
+
+        bool ok = !std::ferror(segment.spill) && out.good();
+        std::fclose(segment.spill);
+        segment.spill = nullptr;
+        return ok;
+    }
+
+    bool StartsWith(const std::string& text, const char* prefix) {
+        return text.compare(0, std::strlen(prefix), prefix) == 0;
+    }
+}
+
+bool DataStore::ExportDump(
+    std::ostream& out,
+    const std::function<void(const DumpProgress&)>& onProgress,
+    std::stop_token stop)
+{
+    std::chrono::steady_clock::time_point start = std::chrono::steady_clock::now();
+
+    // Held from reading the schema until every worker has started reading,
+    // so in rollback journal mode nobody can commit in between.
+    sqlite3* schemaDb = OpenReadConnection();
+    if ( !schemaDb )
+        return false;
+
+    if ( sqlite3_exec(schemaDb, "BEGIN;", NULL, NULL, NULL) != SQLITE_OK ) {
+        sqlite3_close(schemaDb);
+        return false;
+    }
+
+    // Shadow tables are only known to the virtual table modules that own them
+    std::unordered_set<std::string> shadowTables;
+    sqlite3_stmt* stmt;
+    if ( sqlite3_prepare_v2(schemaDb, "SELECT name FROM pragma_table_list WHERE schema='main' AND type='shadow';", -1, &stmt, NULL) == SQLITE_OK ) {
+        while ( sqlite3_step(stmt) == SQLITE_ROW )
+            shadowTables.emplace(reinterpret_cast<const char*>(sqlite3_column_text(stmt, 0)));
+        sqlite3_finalize(stmt);
+    }
+
+    std::vector<Segment> segments;
+    std::string schemaTail; // Indexes, triggers and views, written after all the rows
+    int res = sqlite3_prepare_v2(schemaDb, "SELECT type, name, sql FROM sqlite_schema WHERE sql IS NOT NULL ORDER BY rowid;", -1, &stmt, NULL);
+    if ( res == SQLITE_OK ) {
+        while ( ( res = sqlite3_step(stmt) ) == SQLITE_ROW ) {
+            std::string type = reinterpret_cast<const char*>(sqlite3_column_text(stmt, 0));
+            std::string name = reinterpret_cast<const char*>(sqlite3_column_text(stmt, 1));
+            std::string sql = reinterpret_cast<const char*>(sqlite3_column_text(stmt, 2));
+
+            if ( type != "table" ) {
+                schemaTail += sql + ";\n";
+                continue;
+            }
+
+            Segment segment;
+            if ( name == "sqlite_sequence" )
+                segment.kind = Segment::Kind::Sequence;
+            else if ( StartsWith(name, "sqlite_") ) // sqlite_stat tables, ANALYZE recreates them
+                continue;
+            else if ( shadowTables.count(name) )
+                segment.kind = Segment::Kind::Shadow;
+            else if ( StartsWith(sql, "CREATE VIRTUAL TABLE") )
+                segment.kind = Segment::Kind::Virtual;
+            else
+                segment.kind = Segment::Kind::Table;
+
+            segment.table = std::move(name);
+            segment.sql = std::move(sql);
+            segments.push_back(std::move(segment));
+        }
+        sqlite3_finalize(stmt);
+    }
+
+    if ( res != SQLITE_DONE ) {
+        sqlite3_close(schemaDb);
+        return false;
+    }
+
+    std::mutex segmentMutex;
+    std::condition_variable segmentDone;
+    std::atomic<size_t> nextSegment = 0;
+    std::atomic<uint64_t> rows = 0;
+    std::atomic<bool> abort = false;
+
+    size_t threadCount = std::min<size_t>(std::max(1u, std::thread::hardware_concurrency()), std::max<size_t>(1, segments.size()));
+    std::latch started(static_cast<std::ptrdiff_t>(threadCount));
+
+    auto worker = [&]() {
+        sqlite3* db = OpenReadConnection();
+        if ( db ) {
+            sqlite3_busy_timeout(db, WORKER_BUSY_TIMEOUT_MS);
+
+            // Reading the schema starts the read transaction, all tables are then read from it
+            if ( sqlite3_exec(db, "BEGIN; SELECT count(*) FROM sqlite_schema;", NULL, NULL, NULL) != SQLITE_OK ) {
+                sqlite3_close(db);
+                db = nullptr;
+            }
+        }
+        started.count_down();
+
+        for ( size_t index = nextSegment++; index < segments.size(); index = nextSegment++ ) {
+            Segment& segment = segments[index];
+            bool ok = db && !abort && GenerateSegment(db, segment, rows, abort);
+
+            std::lock_guard<std::mutex> lock(segmentMutex);
+            segment.done = true;
+            segment.failed = !ok;
+            segmentDone.notify_all();
+        }
+
+        sqlite3_close(db); // ends the read transaction
+    };
+
+    std::vector<std::jthread> threads;
+    for ( size_t i = 0; i < threadCount; i++ )
+        threads.emplace_back(worker);
+
+    started.wait();
+    sqlite3_exec(schemaDb, "COMMIT;", NULL, NULL, NULL);
+    sqlite3_close(schemaDb);
+
+    // The calling thread writes the segments out in schema order as they finish
+    DumpProgress progress;
+    progress.tableCount = segments.size();
+    auto report = [&]() {
+        if ( !onProgress )
+            return;
+        progress.rows = rows;
+        progress.elapsedSeconds = std::chrono::duration<double>(std::chrono::steady_clock::now() - start).count();
+        onProgress(progress);
+    };
+
+    static const std::string header = "PRAGMA foreign_keys=OFF;\nBEGIN TRANSACTION;\n";
+    out.write(header.data(), header.size());
+    progress.bytesWritten += header.size();
+    bool ok = out.good();
+
+    for ( Segment& segment : segments ) {
+        if ( !ok )
+            break;
+
+        std::unique_lock<std::mutex> lock(segmentMutex);
+        while ( !segment.done ) {
+            if ( stop.stop_requested() )
+                abort = true;
+
+            if ( !segmentDone.wait_for(lock, DUMP_REPORT_INTERVAL, [&]() { return segment.done; }) ) {
+                lock.unlock();
+                report();
+                lock.lock();
+            }
+        }
+        lock.unlock();
+
+        ok = !segment.failed && !stop.stop_requested() && WriteSegment(segment, out, progress.bytesWritten);
+        progress.tablesDone++;
+        report();
+    }
+
+    // Let the workers finish early, then drop whatever they left behind
+    abort = !ok;
+    threads.clear(); // joins
+    for ( Segment& segment : segments ) {
+        if ( segment.spill )
+            std::fclose(segment.spill);
+    }
+
+    if ( !ok )
+        return false;
+
+    schemaTail += "COMMIT;\n";
+    out.write(schemaTail.data(), schemaTail.size());
+    out.flush();
+    progress.bytesWritten += schemaTail.size();
+    report();
+    return out.good();
+}
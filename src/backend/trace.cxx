@@ -0,0 +1,88 @@
+// Backend
+#include "backend/trace.hxx"
+
+// STD
+#include <fstream>
+#include <functional>
+#include <mutex>
+#include <thread>
+#include <vector>
+
+namespace {
+    struct Event {
+        const char* name;
+        char phase; // 'X' complete event, 'i' instant
+        long long startUs;
+        long long durationUs;
+        size_t threadId;
+    };
+
+    // Taken during static initialization, the closest
+    // portable approximation of the process start time.
+    const Trace::Clock::time_point g_origin = Trace::Clock::now();
+
+    std::mutex g_eventsMutex;
+    std::vector<Event> g_events;
+
+    long long SinceOrigin(Trace::Clock::time_point time) {
+        return std::chrono::duration_cast<std::chrono::microseconds>(time - g_origin).count();
+    }
+
+    void Record(const char* name, char phase, Trace::Clock::time_point start, Trace::Clock::time_point end) {
+        size_t threadId = std::hash<std::thread::id>{}(std::this_thread::get_id());
+
+        std::lock_guard<std::mutex> lock(g_eventsMutex);
+        g_events.push_back({ name, phase, SinceOrigin(start), SinceOrigin(end) - SinceOrigin(start), threadId });
+    }
+}
+
+Trace::Scope::~Scope() {
+    Record(m_name, 'X', m_start, Clock::now());
+}
+
+void Trace::Instant(const char* name) {
+    auto now = Clock::now();
+    Record(name, 'i', now, now);
+}
+
+double Trace::ElapsedMs() {
+    return std::chrono::duration<double, std::milli>(Clock::now() - g_origin).count();
+}
+
+bool Trace::WriteChromeTrace(const std::string& path) {
+    std::ofstream out(path, std::ios::trunc);
+    if ( !out )
+        return false;
+
+    std::lock_guard<std::mutex> lock(g_eventsMutex);
+
+    // Chrome expects small thread ids, so number them in order of appearance
+    std::vector<size_t> threads;
+    auto threadIndex = [&threads](size_t id) {
+        for ( size_t i = 0; i < threads.size(); i++ ) {
+            if ( threads[i] == id )
+                return i + 1;
+        }
+
+        threads.push_back(id);
+        return threads.size();
+    };
+
+    out << "{\"traceEvents\":[";
+    for ( size_t i = 0; i < g_events.size(); i++ ) {
+        const Event& event = g_events[i];
+        out << ( i ? ",\n" : "\n" )
+            << "{\"name\":\"" << event.name << "\",\"cat\":\"sqlight\",\"ph\":\"" << event.phase << "\""
+            << ",\"ts\":" << event.startUs << ",\"pid\":1,\"tid\":" << threadIndex(event.threadId);
+
+        if ( event.phase == 'X' )
+            out << ",\"dur\":" << event.durationUs;
+        else
+            out << ",\"s\":\"g\"";
+
+        out << "}";
+    }
+    out << "\n],\"displayTimeUnit\":\"ms\"}\n";
+
+    return out.good();
+}
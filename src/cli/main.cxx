@@ -0,0 +1,413 @@
+// Headless command line front end over the DataStore backend.
+// Shares the exact export/import paths used by the GUI, so it can be
+// used in pipelines and for scripted performance regression runs.
+
+// Backend
+#include "backend/data_store.hxx"
+#include "backend/db_diff.hxx"
+#include "backend/gzip_stream.hxx"
+#include "backend/io_stats.hxx"
+
+// STD
+#include <algorithm>
+#include <chrono>
+#include <cstdio>
+#include <cstdlib>
+#include <filesystem>
+#include <fstream>
+#include <iostream>
+#include <string>
+#include <vector>
+
+namespace {
+    constexpr std::string_view CLI_NAME = "sqlight-cli";
+    constexpr size_t STREAM_BUFFER_SIZE = 1 << 20;
+
+    void PrintUsage() {
+        std::cerr
+            << "Usage:\n"
+            << "  " << CLI_NAME << " export  <db> <table> [--format csv|json|arrow|parquet] [-o <file>] [--gzip]\n"
+            << "  " << CLI_NAME << " import  <db> <table> [<file.csv>]\n"
+            << "  " << CLI_NAME << " query   <db> <sql> [--format csv|json|arrow|parquet] [-o <file>] [--gzip]\n"
+            << "  " << CLI_NAME << " profile <db> <sql> [--runs <n>]\n"
+            << "  " << CLI_NAME << " exec    <db> <script.sql>\n"
+            << "  " << CLI_NAME << " restore <db> <dump.sql>\n"
+            << "  " << CLI_NAME << " dump    <db> [-o <dump.sql>] [--gzip]\n"
+            << "  " << CLI_NAME << " diff    <old.db> <new.db>\n"
+            << "  " << CLI_NAME << " archive <db> <archive.sqlz>\n"
+            << "\n"
+            << "Output goes to stdout and input is read from stdin when no file, or '-', is given.\n"
+            << "--gzip compresses the output on all cores, output files named *.gz are always compressed.\n"
+            << "--csv <name>=<file.csv> makes a CSV file queryable as table <name> without importing it.\n"
+            << "Compressed archives written by 'archive' can be given as <db> to any command that only reads.\n"
+            << "--no-read-ahead stops prefetching ahead of sequential reads, to measure what it gains.\n"
+            << "--in-memory loads the whole database into RAM first. Changes made to it are not saved.\n"
+            << "--read-only opens the database read-only, without locking when nothing is writing to it.\n";
+    }
+
+    /**
+     * @brief Command line arguments split into positionals and --options.
+     */
+    struct Arguments {
+        std::vector<std::string> positional;
+        std::string format = "csv";
+        std::string output = "-";
+        int runs = 5;
+        bool gzip = false;
+        bool readAhead = true;
+        bool inMemory = false;
+        bool readOnly = false;
+        std::vector<std::pair<std::string, std::string>> csvTables; // (table name, CSV path) from --csv
+    };
+
+    bool ParseArguments(int argc, char** argv, Arguments& args) {
+        for ( int i = 2; i < argc; i++ ) {
+            std::string arg = argv[i];
+            bool hasValue = i + 1 < argc;
+
+            if ( arg == "--format" && hasValue )
+                args.format = argv[++i];
+            else if ( ( arg == "-o" || arg == "--output" ) && hasValue )
+                args.output = argv[++i];
+            else if ( arg == "--gzip" )
+                args.gzip = true;
+            else if ( arg == "--no-read-ahead" )
+                args.readAhead = false;
+            else if ( arg == "--in-memory" )
+                args.inMemory = true;
+            else if ( arg == "--read-only" )
+                args.readOnly = true;
+            else if ( arg == "--runs" && hasValue )
+                args.runs = std::max(1, std::atoi(argv[++i]));
+            else if ( arg == "--csv" && hasValue ) {
+                std::string spec = argv[++i];
+                size_t equals = spec.find('=');
+                if ( equals == 0 || equals == std::string::npos )
+                    return false;
+                args.csvTables.emplace_back(spec.substr(0, equals), spec.substr(equals + 1));
+            }
+            else if ( arg.size() > 1 && arg[0] == '-' )
+                return false;
+            else
+                args.positional.push_back(arg);
+        }
+
+        return args.format == "csv" || args.format == "json" || args.format == "arrow" || args.format == "parquet";
+    }
+
+    /**
+     * @brief Runs 'write' with either stdout or a buffered output file, gzip compressed if asked to.
+     */
+    template <typename Writer>
+    bool WithOutput(const std::string& path, bool gzip, Writer writeOutput) {
+        auto write = [&](std::ostream& out) {
+            if ( !gzip && !IsGzipPath(path) )
+                return writeOutput(out);
+
+            GzipOStream compressed(out);
+            bool ok = writeOutput(compressed);
+            return compressed.Close() && ok;
+        };
+
+        if ( path == "-" ) {
+            // std::cout may flush into its buffer at exit, so it must outlive main
+            static std::vector<char> stdoutBuffer(STREAM_BUFFER_SIZE);
+            std::cout.rdbuf()->pubsetbuf(stdoutBuffer.data(), stdoutBuffer.size());
+            bool ok = write(std::cout);
+            std::cout.flush();
+            return ok;
+        }
+
+        std::vector<char> buffer(STREAM_BUFFER_SIZE);
+        std::ofstream out;
+        out.rdbuf()->pubsetbuf(buffer.data(), buffer.size());
+        out.open(path, std::ios::binary | std::ios::trunc);
+        return out && write(out);
+    }
+
+    // One line per file kind SQLite touched since the counters were reset
+    void PrintIoStats() {
+        IoStats stats = ReadIoStats();
+        for ( int i = 0; i < static_cast<int>(IoFileKind::Count); i++ ) {
+            const FileIoStats& file = stats.files[i];
+            if ( file.opens == 0 && file.reads == 0 && file.writes == 0 )
+                continue;
+
+            std::printf(
+                "io kind=%s opens=%llu reads=%llu bytes_read=%llu writes=%llu bytes_written=%llu syncs=%llu locks=%llu"
+                " read_p50_us=%.0f read_p99_us=%.0f write_p99_us=%.0f sync_p99_us=%.0f\n",
+                IoFileKindName(static_cast<IoFileKind>(i)),
+                static_cast<unsigned long long>(file.opens), static_cast<unsigned long long>(file.reads),
+                static_cast<unsigned long long>(file.bytesRead), static_cast<unsigned long long>(file.writes),
+                static_cast<unsigned long long>(file.bytesWritten), static_cast<unsigned long long>(file.syncs),
+                static_cast<unsigned long long>(file.locks),
+                file.readLatency.PercentileMicros(0.5), file.readLatency.PercentileMicros(0.99),
+                file.writeLatency.PercentileMicros(0.99), file.syncLatency.PercentileMicros(0.99)
+            );
+        }
+    }
+
+    int RunArchive(DataStore& store, const std::string& archivePath) {
+        ArchiveProgress result;
+        bool ok = store.ExportCompressedArchive(archivePath, [&result](const ArchiveProgress& progress) { result = progress; });
+        if ( !ok ) {
+            std::cerr << CLI_NAME << ": could not write archive '" << archivePath << "'\n";
+            return 1;
+        }
+
+        std::fprintf(
+            stderr, "Archived %llu bytes into %llu (%.1fx) in %.2f s\n",
+            static_cast<unsigned long long>(result.totalBytes), static_cast<unsigned long long>(result.bytesWritten),
+            result.bytesWritten ? double(result.totalBytes) / result.bytesWritten : 0.0, result.elapsedSeconds
+        );
+        return 0;
+    }
+
+    int RunProfile(DataStore& store, const std::string& sql, int runs) {
+        std::vector<double> totals;
+        QueryProfile profile;
+        ResetIoStats(); // Leave out opening and reading the schema
+
+        // Machine readable, one line per run, so regressions can be diffed
+        for ( int run = 1; run <= runs; run++ ) {
+            if ( !store.ProfileQuery(sql, profile) ) {
+                std::cerr << CLI_NAME << ": query failed\n";
+                return 1;
+            }
+
+            double total = profile.prepareMs + profile.executeMs;
+            totals.push_back(total);
+
+            std::printf(
+                "run=%d prepare_ms=%.3f execute_ms=%.3f total_ms=%.3f rows=%llu vm_steps=%d fullscan_steps=%d sorts=%d autoindex=%d\n",
+                run, profile.prepareMs, profile.executeMs, total,
+                static_cast<unsigned long long>(profile.rows),
+                profile.vmSteps, profile.fullScanSteps, profile.sorts, profile.autoIndexes
+            );
+        }
+
+        std::sort(totals.begin(), totals.end());
+        double median = totals[totals.size() / 2];
+        double rowsPerSecond = median > 0 ? profile.rows / ( median / 1000.0 ) : 0.0;
+
+        std::printf(
+            "summary runs=%d min_ms=%.3f median_ms=%.3f max_ms=%.3f rows_per_sec=%.0f\n",
+            runs, totals.front(), median, totals.back(), rowsPerSecond
+        );
+        PrintIoStats();
+
+        return 0;
+    }
+
+    void PrintScriptProgress(const ScriptProgress& result) {
+        // Statement counts and throughput, one line, the same whether it failed or not
+        std::printf(
+            "statements=%llu rows_changed=%llu bytes=%llu seconds=%.3f statements_per_sec=%.0f\n",
+            static_cast<unsigned long long>(result.statements),
+            static_cast<unsigned long long>(result.rowsChanged),
+            static_cast<unsigned long long>(result.bytesDone),
+            result.elapsedSeconds,
+            result.elapsedSeconds > 0 ? result.statements / result.elapsedSeconds : 0.0
+        );
+    }
+
+    int RunScript(DataStore& store, const std::string& scriptPath) {
+        std::string error;
+        ScriptProgress result;
+        bool ok = store.ExecuteScript(scriptPath, error, [&result](const ScriptProgress& progress) { result = progress; });
+
+        PrintScriptProgress(result);
+        if ( !ok )
+            std::cerr << CLI_NAME << ": " << error << "\n";
+        return ok ? 0 : 1;
+    }
+
+    int RunRestore(DataStore& store, const std::string& dumpPath) {
+        std::string error;
+        ScriptProgress result;
+        uint64_t violations = 0;
+        bool ok = store.ImportDump(dumpPath, violations, error, [&result](const ScriptProgress& progress) { result = progress; });
+
+        PrintScriptProgress(result);
+        if ( violations )
+            std::cerr << CLI_NAME << ": warning: " << violations << " foreign key violation(s), see PRAGMA foreign_key_check\n";
+        if ( !ok )
+            std::cerr << CLI_NAME << ": " << error << "\n";
+        return ok ? 0 : 1;
+    }
+
+    int RunDump(DataStore& store, const std::string& output, bool gzip) {
+        DumpProgress result;
+        bool ok = WithOutput(output, gzip, [&](std::ostream& out) {
+            return store.ExportDump(out, [&result](const DumpProgress& progress) { result = progress; });
+        });
+
+        // On stderr, stdout may be the dump itself
+        std::fprintf(
+            stderr,
+            "tables=%zu rows=%llu bytes=%llu seconds=%.3f rows_per_sec=%.0f\n",
+            result.tablesDone,
+            static_cast<unsigned long long>(result.rows),
+            static_cast<unsigned long long>(result.bytesWritten),
+            result.elapsedSeconds,
+            result.elapsedSeconds > 0 ? result.rows / result.elapsedSeconds : 0.0
+        );
+
+        if ( !ok )
+            std::cerr << CLI_NAME << ": could not dump the database\n";
+        return ok ? 0 : 1;
+    }
+
+    const char* StatusName(TableDiff::Status status) {
+        switch ( status ) {
+        case TableDiff::Status::Identical: return "identical";
+        case TableDiff::Status::Changed: return "changed";
+        case TableDiff::Status::Added: return "added";
+        case TableDiff::Status::Removed: return "removed";
+        case TableDiff::Status::SchemaChanged: return "schema_changed";
+        case TableDiff::Status::Failed: return "failed";
+        }
+        return "";
+    }
+
+    int RunDiff(const std::string& oldPath, const std::string& newPath) {
+        std::vector<TableDiff> diffs;
+        if ( !DiffDatabases(oldPath, newPath, [&diffs](const TableDiff& diff) { diffs.push_back(diff); }) ) {
+            std::cerr << CLI_NAME << ": could not compare '" << oldPath << "' with '" << newPath << "'\n";
+            return 1;
+        }
+
+        // Tables finish in any order, print them by name
+        std::sort(diffs.begin(), diffs.end(), [](const TableDiff& a, const TableDiff& b) { return a.table < b.table; });
+
+        bool identical = true;
+        for ( const TableDiff& diff : diffs ) {
+            identical = identical && diff.status == TableDiff::Status::Identical;
+            std::printf(
+                "table=%s status=%s inserted=%llu deleted=%llu updated=%llu rows_read=%llu\n",
+                diff.table.c_str(), StatusName(diff.status),
+                static_cast<unsigned long long>(diff.inserted),
+                static_cast<unsigned long long>(diff.deleted),
+                static_cast<unsigned long long>(diff.updated),
+                static_cast<unsigned long long>(diff.rowsRead)
+            );
+        }
+
+        return identical ? 0 : 3; // distinct from errors (1) and usage (2), so scripts can tell them apart
+    }
+}
+
+int main(int argc, char** argv) {
+    if ( argc < 2 ) {
+        PrintUsage();
+        return 2;
+    }
+
+    std::ios::sync_with_stdio(false);
+
+    std::string command = argv[1];
+    Arguments args;
+    if ( !ParseArguments(argc, argv, args) || args.positional.empty() ) {
+        PrintUsage();
+        return 2;
+    }
+
+    // Compares two files, doesn't need a connection of its own
+    if ( command == "diff" && args.positional.size() == 2 )
+        return RunDiff(args.positional[0], args.positional[1]);
+
+    const std::string& dbPath = args.positional[0];
+    ExportFormat format = ExportFormat::CSV;
+    if ( args.format == "json" )
+        format = ExportFormat::JSON;
+    else if ( args.format == "arrow" )
+        format = ExportFormat::Arrow;
+    else if ( args.format == "parquet" )
+        format = ExportFormat::Parquet;
+
+    // Importing into a data base that doesn't exist yet creates it.
+    // An empty file is a valid, empty SQLite data base.
+    if ( ( command == "import" || command == "restore" ) && !std::filesystem::exists(dbPath) )
+        std::ofstream(dbPath, std::ios::binary);
+
+    ConnectProfile profile;
+    profile.compressedArchive = IsCompressedArchive(dbPath);
+    profile.readAhead = args.readAhead;
+    profile.inMemory = args.inMemory;
+    profile.readOnly = args.readOnly;
+
+    DataStore store;
+    auto connectStart = std::chrono::steady_clock::now();
+    if ( !store.Connect(dbPath, profile) ) {
+        std::cerr << CLI_NAME << ": could not open database '" << dbPath << "'\n";
+        return 1;
+    }
+
+    // Opening a file only reads its header, loading it into memory reads all of it
+    if ( profile.inMemory ) {
+        double seconds = std::chrono::duration<double>(std::chrono::steady_clock::now() - connectStart).count();
+        std::fprintf(stderr, "Loaded '%s' into memory in %.2f s\n", dbPath.c_str(), seconds);
+    }
+
+    for ( const auto& [table, csvPath] : args.csvTables ) {
+        if ( !store.AttachCSV(csvPath, table) ) {
+            std::cerr << CLI_NAME << ": could not open CSV file '" << csvPath << "'\n";
+            return 1;
+        }
+    }
+
+    if ( command == "export" && args.positional.size() == 2 ) {
+        const std::string& table = args.positional[1];
+        bool ok = WithOutput(args.output, args.gzip, [&](std::ostream& out) { return store.ExportTable(table, out, format); });
+        if ( !ok )
+            std::cerr << CLI_NAME << ": could not export table '" << table << "'\n";
+        return ok ? 0 : 1;
+    }
+
+    if ( command == "import" && ( args.positional.size() == 2 || args.positional.size() == 3 ) ) {
+        const std::string& table = args.positional[1];
+        std::string input = args.positional.size() == 3 ? args.positional[2] : "-";
+        uint64_t rows = 0;
+        bool ok;
+
+        if ( input == "-" ) {
+            ok = store.ImportCSV(table, std::cin, rows);
+        } else {
+            std::ifstream in(input, std::ios::binary);
+            ok = in && store.ImportCSV(table, in, rows);
+        }
+
+        if ( !ok ) {
+            std::cerr << CLI_NAME << ": could not import into table '" << table << "'\n";
+            return 1;
+        }
+
+        std::cerr << "Imported " << rows << " rows into '" << table << "'\n";
+        return 0;
+    }
+
+    if ( command == "query" && args.positional.size() == 2 ) {
+        bool ok = WithOutput(args.output, args.gzip, [&](std::ostream& out) { return store.ExportQuery(args.positional[1], out, format); });
+        if ( !ok )
+            std::cerr << CLI_NAME << ": query failed\n";
+        return ok ? 0 : 1;
+    }
+
+    if ( command == "exec" && args.positional.size() == 2 )
+        return RunScript(store, args.positional[1]);
+
+    if ( command == "restore" && args.positional.size() == 2 )
+        return RunRestore(store, args.positional[1]);
+
+    if ( command == "dump" && args.positional.size() == 1 )
+        return RunDump(store, args.output, args.gzip);
+
+    if ( command == "profile" && args.positional.size() == 2 )
+        return RunProfile(store, args.positional[1], args.runs);
+
+    if ( command == "archive" && args.positional.size() == 2 )
+        return RunArchive(store, args.positional[1]);
+
+    PrintUsage();
+    return 2;
+}
@@ -7,16 +7,22 @@
  * This function is called when the application starts. It creates the
  * main application window, sets the icon, adjusts the window size
  * to fit the display, and enforces a minimum size constraint.
+ * A data base path given as the first argument is opened right away.
  *
  * @return true Always returns true to indicate successful initialization.
  */
 bool App::OnInit() {
+    TRACE_SCOPE("App::OnInit");
+
     // Create the main application window
     MainFrame* mainFrame = new MainFrame(APP_NAME);
     mainFrame->Show(true);
 
     mainFrame->SetClientSize(800, 500);
 
+    if ( argc > 1 )
+        mainFrame->OpenDatabase(argv[1].utf8_string());
+
     // Get display information for positioning and sizing
     //wxDisplay display(wxDisplay::GetFromWindow(mainFrame));
     //wxRect dimensions = display.GetClientArea();
@@ -24,4 +30,19 @@ bool App::OnInit() {
     //mainFrame->SetMinClientSize(wxSize(800, 600));
 
     return true;
-}
\ No newline at end of file
+}
+
+/**
+ * @brief Cleans up before the application exits.
+ *
+ * @return The exit code from wxApp::OnExit.
+ */
+int App::OnExit() {
+#ifdef SQLIGHT_ENABLE_TRACING
+    wxString traceFile;
+    if ( wxGetEnv("SQLIGHT_TRACE_FILE", &traceFile) && !Trace::WriteChromeTrace(traceFile.utf8_string()) )
+        wxLogError("Could not write startup trace to '%s'", traceFile);
+#endif
+
+    return wxApp::OnExit();
+}
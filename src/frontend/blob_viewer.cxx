@@ -0,0 +1,244 @@
+// Frontend
+#include "frontend/blob_viewer.hxx"
+
+// WX
+#include <wx/stream.h>
+
+// STD
+#include <algorithm>
+#include <cctype>
+#include <cstdio>
+
+namespace {
+    /**
+     * @brief Seekable wxInputStream reading straight from a BlobReader.
+     *
+     * Lets wxImage decode an image BLOB without first copying the
+     * whole BLOB into a memory buffer.
+     */
+    class BlobInputStream : public wxInputStream {
+    public:
+        explicit BlobInputStream(BlobReader& reader) : m_reader(reader)
+        {
+        }
+
+        wxFileOffset GetLength() const override { return m_reader.Size(); }
+        bool IsSeekable() const override { return true; }
+    protected:
+        size_t OnSysRead(void* buffer, size_t size) override {
+            int wanted = static_cast<int>(std::min<size_t>(size, m_reader.Size() - m_position));
+            if ( wanted <= 0 ) {
+                m_lasterror = wxSTREAM_EOF;
+                return 0;
+            }
+
+            int read = m_reader.Read(m_position, buffer, wanted);
+            if ( read < 0 ) {
+                m_lasterror = wxSTREAM_READ_ERROR;
+                return 0;
+            }
+
+            m_position += read;
+            return static_cast<size_t>(read);
+        }
+
+        wxFileOffset OnSysSeek(wxFileOffset pos, wxSeekMode mode) override {
+            wxFileOffset target = pos;
+            if ( mode == wxFromCurrent )
+                target += m_position;
+            else if ( mode == wxFromEnd )
+                target += m_reader.Size();
+
+            if ( target < 0 || target > m_reader.Size() )
+                return wxInvalidOffset;
+
+            m_position = static_cast<int>(target);
+            return target;
+        }
+
+        wxFileOffset OnSysTell() const override { return m_position; }
+    private:
+        BlobReader& m_reader;
+        int m_position = 0;
+    };
+
+    /**
+     * @brief Formats bytes as a classic hex dump, BYTES_PER_LINE bytes per line.
+     *
+     * @param data   The bytes to format.
+     * @param length Number of bytes in 'data'.
+     * @param offset Offset of data[0] within the BLOB, printed at the start of each line.
+     */
+    std::string FormatHexDump(const unsigned char* data, int length, int offset) {
+        std::string dump;
+        char hex[4];
+        char address[16];
+
+        for ( int line = 0; line < length; line += BlobViewer::BYTES_PER_LINE ) {
+            std::snprintf(address, sizeof(address), "%08X  ", offset + line);
+            dump += address;
+
+            std::string ascii;
+            for ( int i = 0; i < BlobViewer::BYTES_PER_LINE; i++ ) {
+                if ( line + i >= length ) {
+                    dump += "   ";
+                    continue;
+                }
+
+                unsigned char byte = data[line + i];
+                std::snprintf(hex, sizeof(hex), "%02X ", byte);
+                dump += hex;
+                ascii += std::isprint(byte) ? static_cast<char>(byte) : '.';
+            }
+
+            dump += " |" + ascii + "|\n";
+        }
+
+        return dump;
+    }
+}
+
+/**
+ * @brief Creates the viewer with an empty hex view and hidden image preview.
+ *
+ * @param parent The window hosting the viewer, the Cell Info pane.
+ */
+BlobViewer::BlobViewer(wxWindow* parent)
+    : wxPanel(parent, wxID_ANY)
+{
+    SetBackgroundColour(*wxWHITE);
+
+    m_sizeLabel = new wxStaticText(this, wxID_ANY, wxEmptyString);
+    m_previousPage = new wxButton(this, wxID_ANY, "<", wxDefaultPosition, wxSize(25, -1));
+    m_nextPage = new wxButton(this, wxID_ANY, ">", wxDefaultPosition, wxSize(25, -1));
+    m_previewButton = new wxButton(this, wxID_ANY, "Preview image");
+    m_hexView = new wxTextCtrl(this, wxID_ANY, wxEmptyString, wxDefaultPosition, wxDefaultSize, wxBORDER_STATIC | wxTE_READONLY | wxTE_MULTILINE | wxTE_DONTWRAP);
+    m_preview = new wxStaticBitmap(this, wxID_ANY, wxNullBitmap);
+
+    m_hexView->SetFont(wxFont(9, wxFONTFAMILY_MODERN, wxFONTSTYLE_NORMAL, wxFONTWEIGHT_NORMAL));
+    m_preview->Hide();
+
+    // Navigation bar. Page buttons, size label and preview button
+    wxBoxSizer* navSizer = new wxBoxSizer(wxHORIZONTAL);
+    navSizer->Add(m_previousPage, 0, wxRIGHT, 3);
+    navSizer->Add(m_nextPage, 0, wxRIGHT, 9);
+    navSizer->Add(m_sizeLabel, 0, wxALIGN_CENTER_VERTICAL | wxRIGHT, 9);
+    navSizer->Add(m_previewButton, 0);
+
+    // Hex dump on the left, image preview on the right
+    wxBoxSizer* contentSizer = new wxBoxSizer(wxHORIZONTAL);
+    contentSizer->Add(m_hexView, 1, wxEXPAND);
+    contentSizer->Add(m_preview, 0, wxLEFT, 5);
+
+    wxBoxSizer* sizer = new wxBoxSizer(wxVERTICAL);
+    sizer->Add(navSizer, 0, wxTOP | wxLEFT, 5);
+    sizer->Add(contentSizer, 1, wxEXPAND | wxTOP, 5);
+    SetSizer(sizer);
+
+    // Bind events
+    m_previousPage->Bind(wxEVT_BUTTON, [this](wxCommandEvent&) { ShowPage(m_page - 1); });
+    m_nextPage->Bind(wxEVT_BUTTON, [this](wxCommandEvent&) { ShowPage(m_page + 1); });
+    m_previewButton->Bind(wxEVT_BUTTON, [this](wxCommandEvent&) { ShowImagePreview(); });
+}
+
+/**
+ * @brief Opens a BLOB cell and shows its first page.
+ *
+ * Opening only reads the BLOB's size, so this returns immediately no
+ * matter how large the BLOB is.
+ *
+ * @return true if the cell holds a BLOB and it was opened, false otherwise.
+ */
+bool BlobViewer::Load(DataStore& store, const std::string& tableName, const std::string& columnName, sqlite3_int64 rowId) {
+    Clear();
+    if ( !store.OpenBlob(tableName, columnName, rowId, m_reader) )
+        return false;
+
+    m_previewButton->Enable(m_reader.Size() <= MAX_PREVIEW_SIZE);
+    ShowPage(0);
+    return true;
+}
+
+/**
+ * @brief Closes the BLOB being viewed and empties the hex view and preview.
+ */
+void BlobViewer::Clear() {
+    m_reader.Close();
+    m_page = 0;
+
+    m_hexView->Clear();
+    m_sizeLabel->SetLabel(wxEmptyString);
+    m_preview->SetBitmap(wxNullBitmap);
+    m_preview->Hide();
+}
+
+/**
+ * @brief Reads and displays a single PAGE_SIZE chunk of the BLOB.
+ *
+ * The blob handle is released afterwards so no read transaction is
+ * held open while the user is looking at the page.
+ *
+ * @param page Zero based page index. Out of range pages are ignored.
+ */
+void BlobViewer::ShowPage(int page) {
+    if ( !m_reader.IsOpen() )
+        return;
+
+    int pageCount = std::max(1, ( m_reader.Size() + PAGE_SIZE - 1 ) / PAGE_SIZE);
+    if ( page < 0 || page >= pageCount )
+        return;
+
+    unsigned char buffer[PAGE_SIZE];
+    int offset = page * PAGE_SIZE;
+    int read = m_reader.Read(offset, buffer, PAGE_SIZE);
+    m_reader.Release();
+
+    if ( read < 0 ) {
+        m_hexView->SetValue("Could not read BLOB. The row may have been changed or deleted.");
+        return;
+    }
+
+    m_page = page;
+    m_hexView->SetValue(FormatHexDump(buffer, read, offset));
+    m_sizeLabel->SetLabel(wxString::Format("Bytes %d-%d of %d", offset, offset + std::max(read - 1, 0), m_reader.Size()));
+
+    m_previousPage->Enable(page > 0);
+    m_nextPage->Enable(page + 1 < pageCount);
+    Layout();
+}
+
+/**
+ * @brief Decodes the BLOB as an image and shows a thumbnail beside the hex view.
+ *
+ * The image is decoded through BlobInputStream, so the encoded data is streamed
+ * from the data base rather than copied into memory first.
+ */
+void BlobViewer::ShowImagePreview() {
+    if ( !m_reader.IsOpen() )
+        return;
+
+    // Only the PNG handler is registered at startup
+    [[maybe_unused]] static bool handlersLoaded = ( wxInitAllImageHandlers(), true );
+
+    wxImage image;
+    {
+        wxLogNull noLog; // unknown formats are expected, don't pop up errors
+        BlobInputStream stream(m_reader);
+        image.LoadFile(stream, wxBITMAP_TYPE_ANY);
+    }
+    m_reader.Release();
+
+    if ( !image.IsOk() ) {
+        m_sizeLabel->SetLabel(m_sizeLabel->GetLabel() + " (not a recognized image)");
+        return;
+    }
+
+    // Scale down to fit the preview, keeping the aspect ratio
+    double scale = std::min(1.0, double(PREVIEW_SIZE) / std::max(image.GetWidth(), image.GetHeight()));
+    if ( scale < 1.0 )
+        image.Rescale(std::max(1, int(image.GetWidth() * scale)), std::max(1, int(image.GetHeight() * scale)), wxIMAGE_QUALITY_NORMAL);
+
+    m_preview->SetBitmap(wxBitmap(image));
+    m_preview->Show();
+    Layout();
+}
@@ -0,0 +1,104 @@
+// Frontend
+#include "frontend/diagnostics_view.hxx"
+
+// WX
+#include <wx/filename.h>
+
+namespace {
+    constexpr int REFRESH_INTERVAL_MS = 1000;
+
+    wxString Count(uint64_t value) {
+        return wxString::Format("%llu", static_cast<unsigned long long>(value));
+    }
+
+    wxString Micros(const LatencyHistogram& histogram, double percentile) {
+        if ( histogram.Total() == 0 )
+            return "-";
+        return wxString::Format("%.0f", histogram.PercentileMicros(percentile));
+    }
+}
+
+/**
+ * @brief Creates the view and starts refreshing it.
+ *
+ * @param parent The notebook hosting the view.
+ */
+DiagnosticsView::DiagnosticsView(wxWindow* parent)
+    : wxPanel(parent, wxID_ANY), m_refreshTimer(this)
+{
+    SetBackgroundColour(*wxWHITE);
+
+    m_summary = new wxStaticText(this, wxID_ANY, wxEmptyString);
+    wxButton* resetButton = new wxButton(this, wxID_ANY, "Reset");
+    m_files = new wxListCtrl(this, wxID_ANY, wxDefaultPosition, wxDefaultSize, wxLC_REPORT | wxBORDER_STATIC);
+
+    m_files->AppendColumn("File", wxLIST_FORMAT_LEFT, 80);
+    m_files->AppendColumn("Opens", wxLIST_FORMAT_RIGHT, 60);
+    m_files->AppendColumn("Reads", wxLIST_FORMAT_RIGHT, 80);
+    m_files->AppendColumn("Bytes read", wxLIST_FORMAT_RIGHT, 100);
+    m_files->AppendColumn("Writes", wxLIST_FORMAT_RIGHT, 80);
+    m_files->AppendColumn("Bytes written", wxLIST_FORMAT_RIGHT, 100);
+    m_files->AppendColumn("Syncs", wxLIST_FORMAT_RIGHT, 60);
+    m_files->AppendColumn("Locks", wxLIST_FORMAT_RIGHT, 70);
+    m_files->AppendColumn("Read p50 (us)", wxLIST_FORMAT_RIGHT, 90);
+    m_files->AppendColumn("Read p99 (us)", wxLIST_FORMAT_RIGHT, 90);
+    m_files->AppendColumn("Write p99 (us)", wxLIST_FORMAT_RIGHT, 90);
+    m_files->AppendColumn("Sync p99 (us)", wxLIST_FORMAT_RIGHT, 90);
+
+    for ( int i = 0; i < static_cast<int>(IoFileKind::Count); i++ )
+        m_files->InsertItem(i, IoFileKindName(static_cast<IoFileKind>(i)));
+
+    wxBoxSizer* header = new wxBoxSizer(wxHORIZONTAL);
+    header->Add(m_summary, 1, wxALIGN_CENTER_VERTICAL);
+    header->Add(resetButton, 0);
+
+    wxBoxSizer* sizer = new wxBoxSizer(wxVERTICAL);
+    sizer->Add(header, 0, wxEXPAND | wxALL, 5);
+    sizer->Add(m_files, 1, wxEXPAND | wxLEFT | wxRIGHT | wxBOTTOM, 5);
+    SetSizer(sizer);
+
+    resetButton->Bind(wxEVT_BUTTON, [this](wxCommandEvent&) {
+        ResetIoStats();
+        ShowCounters();
+    });
+    // Skip refreshing while another tab is in front, nobody would see it
+    Bind(wxEVT_TIMER, [this](wxTimerEvent&) {
+        if ( IsShownOnScreen() )
+            ShowCounters();
+    }, m_refreshTimer.GetId());
+
+    ShowCounters();
+    m_refreshTimer.Start(REFRESH_INTERVAL_MS);
+}
+
+/**
+ * @brief Fills the list from a fresh snapshot of the I/O counters.
+ */
+void DiagnosticsView::ShowCounters() {
+    IoStats stats = ReadIoStats();
+    uint64_t totalRead = 0, totalWritten = 0;
+
+    for ( int i = 0; i < static_cast<int>(IoFileKind::Count); i++ ) {
+        const FileIoStats& file = stats.files[i];
+        m_files->SetItem(i, 1, Count(file.opens));
+        m_files->SetItem(i, 2, Count(file.reads));
+        m_files->SetItem(i, 3, Count(file.bytesRead));
+        m_files->SetItem(i, 4, Count(file.writes));
+        m_files->SetItem(i, 5, Count(file.bytesWritten));
+        m_files->SetItem(i, 6, Count(file.syncs));
+        m_files->SetItem(i, 7, Count(file.locks));
+        m_files->SetItem(i, 8, Micros(file.readLatency, 0.5));
+        m_files->SetItem(i, 9, Micros(file.readLatency, 0.99));
+        m_files->SetItem(i, 10, Micros(file.writeLatency, 0.99));
+        m_files->SetItem(i, 11, Micros(file.syncLatency, 0.99));
+
+        totalRead += file.bytesRead;
+        totalWritten += file.bytesWritten;
+    }
+
+    m_summary->SetLabel(wxString::Format(
+        "%s read, %s written. Latencies are bucketed to powers of two.",
+        wxFileName::GetHumanReadableSize(wxULongLong(totalRead)),
+        wxFileName::GetHumanReadableSize(wxULongLong(totalWritten))
+    ));
+}
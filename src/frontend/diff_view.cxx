@@ -0,0 +1,142 @@
+// Frontend
+#include "frontend/diff_view.hxx"
+
+// STD
+#include <algorithm>
+
+namespace {
+    wxString StatusText(TableDiff::Status status) {
+        switch ( status ) {
+        case TableDiff::Status::Identical: return "Identical";
+        case TableDiff::Status::Changed: return "Changed";
+        case TableDiff::Status::Added: return "Added";
+        case TableDiff::Status::Removed: return "Removed";
+        case TableDiff::Status::SchemaChanged: return "Schema changed";
+        case TableDiff::Status::Failed: return "Could not compare";
+        }
+        return wxEmptyString;
+    }
+
+    wxString ChangeText(RowChange::Kind kind) {
+        switch ( kind ) {
+        case RowChange::Kind::Inserted: return "Inserted";
+        case RowChange::Kind::Deleted: return "Deleted";
+        case RowChange::Kind::Updated: return "Updated";
+        }
+        return wxEmptyString;
+    }
+}
+
+/**
+ * @brief Creates the view with empty table and change lists.
+ *
+ * @param parent The notebook hosting the view.
+ */
+DiffView::DiffView(wxWindow* parent)
+    : wxPanel(parent, wxID_ANY)
+{
+    SetBackgroundColour(*wxWHITE);
+
+    m_summary = new wxStaticText(this, wxID_ANY, wxEmptyString);
+    m_tables = new wxListCtrl(this, wxID_ANY, wxDefaultPosition, wxDefaultSize, wxLC_REPORT | wxLC_SINGLE_SEL | wxBORDER_STATIC);
+    m_changes = new wxListCtrl(this, wxID_ANY, wxDefaultPosition, wxDefaultSize, wxLC_REPORT | wxBORDER_STATIC);
+
+    m_tables->AppendColumn("Table", wxLIST_FORMAT_LEFT, 180);
+    m_tables->AppendColumn("Status", wxLIST_FORMAT_LEFT, 110);
+    m_tables->AppendColumn("Inserted", wxLIST_FORMAT_RIGHT, 80);
+    m_tables->AppendColumn("Deleted", wxLIST_FORMAT_RIGHT, 80);
+    m_tables->AppendColumn("Updated", wxLIST_FORMAT_RIGHT, 80);
+
+    m_changes->AppendColumn("Change", wxLIST_FORMAT_LEFT, 90);
+    m_changes->AppendColumn("Primary key", wxLIST_FORMAT_LEFT, 400);
+
+    wxBoxSizer* sizer = new wxBoxSizer(wxVERTICAL);
+    sizer->Add(m_summary, 0, wxALL, 5);
+    sizer->Add(m_tables, 3, wxEXPAND | wxLEFT | wxRIGHT, 5);
+    sizer->Add(m_changes, 2, wxEXPAND | wxALL, 5);
+    SetSizer(sizer);
+
+    m_tables->Bind(wxEVT_LIST_ITEM_SELECTED, &DiffView::OnTableSelected, this);
+}
+
+/**
+ * @brief Clears both lists and shows which files are being compared.
+ */
+void DiffView::Start(const wxString& oldName, const wxString& newName) {
+    m_diffs.clear();
+    m_tables->DeleteAllItems();
+    m_changes->DeleteAllItems();
+
+    m_title = oldName + " -> " + newName;
+    m_summary->SetLabel("Comparing " + m_title + "...");
+    Layout();
+}
+
+/**
+ * @brief Adds the result for one table, in name order.
+ *
+ * Tables arrive in whatever order the diff workers finish them.
+ */
+void DiffView::AddTable(const TableDiff& diff) {
+    auto position = std::lower_bound(m_diffs.begin(), m_diffs.end(), diff.table, [](const TableDiff& item, const std::string& name) {
+        return item.table < name;
+    });
+
+    long index = static_cast<long>(position - m_diffs.begin());
+    m_diffs.insert(position, diff);
+
+    m_tables->InsertItem(index, wxString::FromUTF8(diff.table));
+    m_tables->SetItem(index, 1, StatusText(diff.status));
+    m_tables->SetItem(index, 2, wxString::Format("%llu", static_cast<unsigned long long>(diff.inserted)));
+    m_tables->SetItem(index, 3, wxString::Format("%llu", static_cast<unsigned long long>(diff.deleted)));
+    m_tables->SetItem(index, 4, wxString::Format("%llu", static_cast<unsigned long long>(diff.updated)));
+
+    if ( diff.status != TableDiff::Status::Identical )
+        m_tables->SetItemTextColour(index, diff.status == TableDiff::Status::Failed ? *wxRED : wxColour(0, 90, 170));
+}
+
+/**
+ * @brief Shows the number of changed tables and how long the comparison took.
+ *
+ * @param completed False if the comparison was cancelled or a file couldn't be opened.
+ * @param seconds   Wall clock time of the comparison.
+ */
+void DiffView::Finish(bool completed, double seconds) {
+    if ( !completed ) {
+        m_summary->SetLabel("Could not compare " + m_title);
+        return;
+    }
+
+    size_t changed = std::count_if(m_diffs.begin(), m_diffs.end(), [](const TableDiff& diff) {
+        return diff.status != TableDiff::Status::Identical;
+    });
+
+    m_summary->SetLabel(wxString::Format("%s: %zu of %zu tables differ (%.2f s)", m_title, changed, m_diffs.size(), seconds));
+    Layout();
+}
+
+/**
+ * @brief Lists the changed rows of the selected table.
+ */
+void DiffView::OnTableSelected(wxListEvent& event) {
+    m_changes->DeleteAllItems();
+
+    long index = event.GetIndex();
+    if ( index < 0 || index >= static_cast<long>(m_diffs.size()) )
+        return;
+
+    const TableDiff& diff = m_diffs[index];
+    m_changes->Freeze();
+    for ( size_t i = 0; i < diff.changes.size(); i++ ) {
+        long row = m_changes->InsertItem(static_cast<long>(i), ChangeText(diff.changes[i].kind));
+        m_changes->SetItem(row, 1, wxString::FromUTF8(diff.changes[i].key));
+    }
+
+    // Counts are exact but only the first changes are listed
+    uint64_t total = diff.inserted + diff.deleted + diff.updated;
+    if ( diff.status == TableDiff::Status::Changed && total > diff.changes.size() ) {
+        long row = m_changes->InsertItem(static_cast<long>(diff.changes.size()), "...");
+        m_changes->SetItem(row, 1, wxString::Format("%llu more", static_cast<unsigned long long>(total - diff.changes.size())));
+    }
+    m_changes->Thaw();
+}
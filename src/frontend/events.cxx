@@ -1,5 +1,22 @@
+// Backend
+#include "backend/gzip_stream.hxx"
+#include "backend/io_stats.hxx"
+
 // Frontend
 #include "frontend/main_frame.hxx"
+#include "frontend/colours.hxx"
+
+// WX
+#include <wx/filename.h>
+
+// STD
+#include <algorithm>
+#include <chrono>
+#include <cstdio>
+#include <fstream>
+#include <iomanip>
+#include <memory>
+#include <sstream>
 
 /**
  * @brief Handles character addition events to provide SQL keyword auto-completion.
@@ -49,4 +66,1100 @@ void MainFrame::OnCharAdded(wxStyledTextEvent& event) {
     m_textEditor->AutoCompShow(wordLen, filteredWordList);
 
     event.Skip();
-}
\ No newline at end of file
+}
+namespace {
+    constexpr size_t UNDO_LIMIT = 32; // Saved batches of grid edits that can be undone
+
+    // Tree item data of a search hit, so activating the item can jump to it
+    class SearchHitData : public wxClientData {
+    public:
+        explicit SearchHitData(const SearchHit& hit) : hit(hit)
+        {
+        }
+
+        SearchHit hit;
+    };
+
+    // Path of a data base to open, empty if the dialog was cancelled
+    std::string AskDatabasePath(wxWindow* parent, const wxString& title) {
+        wxFileDialog dialog(
+            parent,
+            title,
+            wxEmptyString, wxEmptyString,
+            "SQLite databases (*.db;*.sqlite;*.sqlite3)|*.db;*.sqlite;*.sqlite3|Compressed archives (*.sqlz)|*.sqlz|All files (*.*)|*.*",
+            wxFD_OPEN | wxFD_FILE_MUST_EXIST
+        );
+
+        if ( dialog.ShowModal() != wxID_OK )
+            return {};
+        return dialog.GetPath().utf8_string();
+    }
+
+    /**
+     * @brief Formats column statistics as plain text for the Cell Info pane.
+     *
+     * Built as a std::string so it can be produced on the worker thread
+     * and handed to the UI thread without sharing any wx objects.
+     */
+    std::string FormatColumnStats(const ColumnStats& stats) {
+        std::ostringstream out;
+        out << std::fixed << std::setprecision(2);
+
+        out << "Column \"" << stats.column << "\" of \"" << stats.table << "\"";
+        if ( stats.sampled )
+            out << " (sampled " << stats.rowsScanned << " of ~" << stats.estimatedRows << " rows)";
+        out << "\n";
+
+        out << "Rows scanned: " << stats.rowsScanned
+            << "    Nulls: " << stats.nullCount << " (" << stats.NullRatio() * 100.0 << "%)\n";
+        out << "Types: integer " << stats.integerCount << ", real " << stats.realCount
+            << ", text " << stats.textCount << ", blob " << stats.blobCount << "\n";
+
+        if ( stats.numericMin )
+            out << "Numeric min: " << *stats.numericMin << "    max: " << *stats.numericMax << "\n";
+        if ( stats.textMin )
+            out << "Text min: '" << *stats.textMin << "'    max: '" << *stats.textMax << "'\n";
+
+        out << "Distinct values (approx.): " << std::llround(stats.distinctEstimate) << "\n";
+
+        if ( !stats.topValues.empty() ) {
+            out << "Most frequent:";
+            for ( const auto& entry : stats.topValues )
+                out << "  '" << entry.value << "' (" << entry.count << ")";
+            out << "\n";
+        }
+
+        if ( !stats.histogram.empty() ) {
+            uint64_t largest = 0;
+            for ( const auto& bucket : stats.histogram )
+                largest = std::max(largest, bucket.count);
+
+            out << "Histogram:\n";
+            for ( const auto& bucket : stats.histogram ) {
+                size_t bar = largest ? static_cast<size_t>(bucket.count * 30 / largest) : 0;
+                out << "  [" << bucket.low << ", " << bucket.high << ")  "
+                    << std::string(bar, '#') << " " << bucket.count << "\n";
+            }
+        }
+
+        return out.str();
+    }
+}
+
+/**
+ * @brief Prompts for a SQLite data base file and opens it.
+ *
+ * @param event The menu event. Unused.
+ * @see MainFrame::OpenDatabase(const std::string&, ConnectProfile)
+ */
+void MainFrame::OnOpenDatabase(wxCommandEvent& event) {
+    std::string path = AskDatabasePath(this, "Open Database");
+    if ( !path.empty() )
+        OpenDatabase(path);
+}
+
+/**
+ * @brief Prompts for a SQLite data base file and opens it read-only.
+ *
+ * Nothing is locked when no other connection is writing to the file, see
+ * ConnectProfile::readOnly, which makes browsing a snapshot on a network
+ * share much faster. Everything that would write is disabled.
+ *
+ * @param event The menu event. Unused.
+ */
+void MainFrame::OnOpenReadOnly(wxCommandEvent& event) {
+    std::string path = AskDatabasePath(this, "Open Database Read-only");
+    if ( path.empty() )
+        return;
+
+    ConnectProfile profile;
+    profile.readOnly = true;
+    OpenDatabase(path, profile);
+}
+
+/**
+ * @brief Prompts for a SQLite data base file and loads all of it into memory.
+ *
+ * Queries then never wait on the disk. Edits stay in memory until saved,
+ * when the whole data base is written back to the file.
+ *
+ * @param event The menu event. Unused.
+ * @see ConnectProfile::inMemory
+ */
+void MainFrame::OnOpenInMemory(wxCommandEvent& event) {
+    std::string path = AskDatabasePath(this, "Open Database in Memory");
+    if ( path.empty() )
+        return;
+
+    ConnectProfile profile;
+    profile.inMemory = true;
+    OpenDatabase(path, profile);
+}
+
+/**
+ * @brief Prompts for a SQL script and loads it into the editor.
+ *
+ * @param event The menu event. Unused.
+ * @see MainFrame::OpenScript(const std::string&)
+ */
+void MainFrame::OnOpenScript(wxCommandEvent& event) {
+    wxFileDialog dialog(
+        this,
+        "Open SQL Script",
+        wxEmptyString, wxEmptyString,
+        "SQL scripts (*.sql)|*.sql|All files (*.*)|*.*",
+        wxFD_OPEN | wxFD_FILE_MUST_EXIST
+    );
+
+    if ( dialog.ShowModal() != wxID_OK )
+        return;
+
+    OpenScript(dialog.GetPath().utf8_string());
+}
+
+/**
+ * @brief Prompts for a SQL script and executes it on the open data base.
+ *
+ * @param event The menu event. Unused.
+ * @see MainFrame::ExecuteScriptFile(const std::string&)
+ */
+void MainFrame::OnExecuteScriptFile(wxCommandEvent& event) {
+    if ( !m_backend.IsConnected() || m_scriptWorker.joinable() )
+        return;
+
+    wxFileDialog dialog(
+        this,
+        "Execute Script File",
+        wxEmptyString, wxEmptyString,
+        "SQL scripts (*.sql)|*.sql|All files (*.*)|*.*",
+        wxFD_OPEN | wxFD_FILE_MUST_EXIST
+    );
+
+    if ( dialog.ShowModal() != wxID_OK )
+        return;
+
+    ExecuteScriptFile(dialog.GetPath().utf8_string());
+}
+
+/**
+ * @brief Prompts for a SQL dump and restores it into the open data base.
+ *
+ * @param event The menu event. Unused.
+ * @see DataStore::ImportDump
+ */
+void MainFrame::OnImportDump(wxCommandEvent& event) {
+    if ( !m_backend.IsConnected() || m_scriptWorker.joinable() )
+        return;
+
+    wxFileDialog dialog(
+        this,
+        "Import SQL Dump",
+        wxEmptyString, wxEmptyString,
+        "SQL dumps (*.sql)|*.sql|All files (*.*)|*.*",
+        wxFD_OPEN | wxFD_FILE_MUST_EXIST
+    );
+
+    if ( dialog.ShowModal() != wxID_OK )
+        return;
+
+    ExecuteScriptFile(dialog.GetPath().utf8_string(), true);
+}
+
+/**
+ * @brief Executes a SQL script file on the open data base, without loading it into the editor.
+ *
+ * DataStore::ExecuteScript, or DataStore::ImportDump for a dump, runs on a
+ * worker thread, streaming statements from the memory mapped file, with
+ * progress in a progress dialog that can cancel it. The outcome is written
+ * to the Output tab. Afterwards the table list is re-read, since the script
+ * may have changed the schema.
+ *
+ * @param path       Path to the script file.
+ * @param importDump Restore the file as a dump, in batched transactions.
+ */
+void MainFrame::ExecuteScriptFile(const std::string& path, bool importDump) {
+    if ( !m_backend.IsConnected() ) {
+        wxLogError("Open a database to execute the script on first.");
+        return;
+    }
+
+    if ( m_scriptWorker.joinable() )
+        return;
+
+    PauseRowCounts();
+    RevalidateMetadata();
+
+    constexpr int PROGRESS_RANGE = 1000;
+    wxString fileName = wxFileName(wxString::FromUTF8(path)).GetFullName();
+    m_scriptProgress = new wxProgressDialog(
+        importDump ? "Importing SQL Dump" : "Executing Script",
+        ( importDump ? "Importing " : "Executing " ) + fileName + "...",
+        PROGRESS_RANGE,
+        this,
+        wxPD_CAN_ABORT | wxPD_AUTO_HIDE | wxPD_ELAPSED_TIME | wxPD_REMAINING_TIME
+    );
+
+    m_scriptWorker = std::jthread([this, path, fileName, importDump](std::stop_token stop) {
+        ScriptProgress result;
+        auto onProgress = [this, &result](const ScriptProgress& progress) {
+            result = progress;
+            CallAfter([this, progress]() {
+                if ( !m_scriptProgress )
+                    return;
+
+                constexpr double MB = 1024.0 * 1024.0;
+                wxString message = wxString::Format(
+                    "%llu statements, %.1f of %.1f MB (%.0f statements/s)",
+                    static_cast<unsigned long long>(progress.statements),
+                    progress.bytesDone / MB, progress.totalBytes / MB,
+                    progress.elapsedSeconds > 0 ? progress.statements / progress.elapsedSeconds : 0.0
+                );
+
+                // Update returns false once the user pressed cancel
+                if ( !m_scriptProgress->Update(static_cast<int>(progress.Fraction() * PROGRESS_RANGE), message) )
+                    m_scriptWorker.request_stop();
+            });
+        };
+
+        std::string error;
+        uint64_t violations = 0;
+        bool ok = importDump
+            ? m_backend.ImportDump(path, violations, error, onProgress, stop)
+            : m_backend.ExecuteScript(path, error, onProgress, stop);
+        bool cancelled = stop.stop_requested();
+
+        CallAfter([this, ok, cancelled, error, result, violations, fileName, importDump]() {
+            m_scriptProgress->Destroy();
+            m_scriptProgress = nullptr;
+            m_scriptWorker.join();
+
+            wxString summary = wxString::Format(
+                "%llu statements from '%s' in %.1f s, %llu rows changed",
+                static_cast<unsigned long long>(result.statements), fileName,
+                result.elapsedSeconds, static_cast<unsigned long long>(result.rowsChanged)
+            );
+
+            if ( ok )
+                wxLogMessage(importDump ? "Imported %s" : "Executed %s", summary);
+            else if ( cancelled )
+                wxLogWarning("Cancelled after %s. %s", summary, wxString::FromUTF8(error));
+            else
+                wxLogError("Script stopped after %s. %s", summary, wxString::FromUTF8(error));
+
+            if ( violations )
+                wxLogWarning("%llu rows violate foreign key constraints, see PRAGMA foreign_key_check", static_cast<unsigned long long>(violations));
+
+            // Any table may have been changed, created or dropped
+            m_metadata.ForgetData();
+            RekeyMetadata();
+            std::vector<std::string> tableNames = m_backend.GetTableNames();
+            for ( const std::string& table : tableNames )
+                m_searchIndex.MarkDirty(table);
+
+            if ( m_editJournal.Empty() )
+                RefreshTableList(tableNames, m_shownTable);
+        });
+    });
+}
+
+/**
+ * @brief Loads the table chosen in the dropdown into the records grid.
+ *
+ * @param event The choice event carrying the selected table name.
+ */
+void MainFrame::OnTableSelected(wxCommandEvent& event) {
+    if ( !m_editJournal.Empty() ) {
+        int answer = wxMessageBox("Discard unsaved changes to the current table?", "Unsaved Changes", wxYES_NO | wxICON_WARNING, this);
+        if ( answer != wxYES ) {
+            m_tableSelector->SetStringSelection(wxString::FromUTF8(m_shownTable)); // keep showing the edited table
+            return;
+        }
+    }
+
+    PauseRowCounts();
+    LoadTableRecords(event.GetString().utf8_string());
+}
+
+/**
+ * @brief Schedules a Cell Info update for the newly selected grid cell.
+ *
+ * Holding an arrow key selects cells faster than the pane is worth
+ * refreshing, so only the latest cell is remembered here and the pane
+ * is updated by m_uiUpdates at most every CELL_INFO_INTERVAL_MS.
+ *
+ * @param event The grid event containing the selected row and column.
+ */
+void MainFrame::OnGridCellSelected(wxGridEvent& event) {
+    m_selectedCell = wxGridCellCoords(event.GetRow(), event.GetCol());
+    m_uiUpdates.Request(m_cellInfoUpdate);
+    PauseRowCounts(); // Cell Info may scan the column
+
+    event.Skip();
+}
+
+/**
+ * @brief Updates the Cell Info pane for m_selectedCell.
+ *
+ * The label shows the selected row and column, and statistics for the
+ * column are computed on a background thread the first time a cell
+ * in that column is selected.
+ */
+void MainFrame::UpdateCellInfo() {
+    int row = m_selectedCell.GetRow();
+    int col = m_selectedCell.GetCol();
+
+    m_cellInfoLabel->SetLabel(wxString::Format("&Cell Info: Row %d, Column %d", row, col));
+    ShowCellBlob(row, col);
+    ShowColumnStats(col);
+}
+
+/**
+ * @brief Starts a background scan summarizing a column of the displayed table.
+ *
+ * Replacing m_statsWorker requests the previous scan to stop and waits for it,
+ * so at most one scan runs at a time. Results are handed back to the UI thread
+ * with CallAfter and dropped if a newer scan has been started in the meantime.
+ * Stats kept in m_metadata, from this session or the sidecar, are shown
+ * without scanning again.
+ *
+ * @param col Index of the grid column to summarize.
+ */
+void MainFrame::ShowColumnStats(int col) {
+    if ( !m_backend.IsConnected() || col < 0 || col == m_statsColumn )
+        return;
+
+    if ( m_shownTable.empty() )
+        return;
+
+    std::string table = m_shownTable;
+    std::string column = m_tableDataView->GetColLabelValue(col).utf8_string();
+
+    m_statsColumn = col;
+
+    // Stats from an earlier session, or computed before, are current
+    // as long as nothing has written to the table since
+    if ( const ColumnStats* cached = m_metadata.FindColumnStats(table, column) ) {
+        m_statsWorker = std::jthread(); // a scan of another column would overwrite the pane
+        m_cellInfo->SetValue(wxString::FromUTF8(FormatColumnStats(*cached)));
+        return;
+    }
+
+    m_cellInfo->SetValue("Computing statistics for \"" + wxString::FromUTF8(column) + "\"...");
+
+    m_statsWorker = std::jthread([this, table, column](std::stop_token stop) {
+        ColumnStats stats;
+        bool computed = m_backend.ComputeColumnStats(table, column, stats, stop);
+        std::string text = computed
+            ? FormatColumnStats(stats)
+            : "Could not compute statistics for \"" + column + "\".";
+
+        CallAfter([this, stop, computed, stats, text]() {
+            if ( stop.stop_requested() )
+                return;
+
+            if ( computed )
+                m_metadata.StoreColumnStats(stats);
+            m_cellInfo->SetValue(wxString::FromUTF8(text));
+        });
+    });
+}
+
+/**
+ * @brief Shows the BLOB viewer when the selected cell holds a BLOB.
+ *
+ * The grid only holds a placeholder for BLOB cells, so the content is
+ * read through the viewer on demand. For any other cell the viewer is hidden.
+ *
+ * @param row Grid row of the selected cell.
+ * @param col Grid column of the selected cell.
+ */
+void MainFrame::ShowCellBlob(int row, int col) {
+    bool isBlob = false;
+    if ( m_backend.IsConnected() && row >= 0 && col >= 0 && row < static_cast<int>(m_rowIds.size()) ) {
+        isBlob = m_blobViewer->Load(
+            m_backend,
+            m_shownTable,
+            m_tableDataView->GetColLabelValue(col).utf8_string(),
+            m_rowIds[row]
+        );
+    }
+
+    if ( !isBlob )
+        m_blobViewer->Clear();
+
+    if ( m_blobViewer->IsShown() != isBlob ) {
+        m_blobViewer->Show(isBlob);
+        m_blobViewer->GetParent()->Layout();
+    }
+}
+
+/**
+ * @brief Saves a snapshot of the open data base to a new file.
+ *
+ * The copy is made with DataStore::BackupTo on a background thread, so the
+ * data base stays usable by SQLight and other processes while it runs.
+ * Progress and throughput are shown in a progress dialog which can cancel
+ * the backup, in which case the destination is left untouched.
+ *
+ * @param event The menu event. Unused.
+ */
+void MainFrame::OnSaveAs(wxCommandEvent& event) {
+    if ( !m_backend.IsConnected() || m_backupWorker.joinable() )
+        return;
+
+    wxFileDialog dialog(
+        this,
+        "Save Database As",
+        wxEmptyString, wxEmptyString,
+        "SQLite databases (*.db;*.sqlite;*.sqlite3)|*.db;*.sqlite;*.sqlite3|All files (*.*)|*.*",
+        wxFD_SAVE | wxFD_OVERWRITE_PROMPT
+    );
+
+    if ( dialog.ShowModal() != wxID_OK )
+        return;
+
+    SaveCopy(dialog.GetPath().utf8_string());
+}
+
+/**
+ * @brief Copies the open data base to 'destPath' with DataStore::BackupTo on the backup worker.
+ *
+ * Used by Save As, and by Save to write a data base opened in memory back
+ * to its file. Nothing else may be running on the backup worker.
+ *
+ * @param destPath File to write, replaced if it exists.
+ */
+void MainFrame::SaveCopy(const std::string& destPath) {
+    constexpr int PROGRESS_RANGE = 1000;
+    m_backupProgress = new wxProgressDialog(
+        "Saving Database",
+        "Starting backup...",
+        PROGRESS_RANGE,
+        this,
+        wxPD_CAN_ABORT | wxPD_AUTO_HIDE | wxPD_ELAPSED_TIME | wxPD_REMAINING_TIME
+    );
+
+    m_backupWorker = std::jthread([this, destPath](std::stop_token stop) {
+        auto onProgress = [this](const BackupProgress& progress) {
+            CallAfter([this, progress]() {
+                if ( !m_backupProgress )
+                    return;
+
+                constexpr double MB = 1024.0 * 1024.0;
+                wxString message = wxString::Format(
+                    "Copied %.1f of %.1f MB (%.1f MB/s)",
+                    progress.bytesCopied / MB, progress.totalBytes / MB, progress.BytesPerSecond() / MB
+                );
+
+                // Update returns false once the user pressed cancel
+                if ( !m_backupProgress->Update(static_cast<int>(progress.Fraction() * PROGRESS_RANGE), message) )
+                    m_backupWorker.request_stop();
+            });
+        };
+
+        bool ok = m_backend.BackupTo(destPath, onProgress, stop);
+
+        CallAfter([this, ok, destPath]() {
+            m_backupProgress->Destroy();
+            m_backupProgress = nullptr;
+            m_backupWorker.join();
+
+            if ( ok )
+                wxLogMessage("Saved database to '%s'", wxString::FromUTF8(destPath));
+            else
+                wxLogError("Could not save database to '%s'", wxString::FromUTF8(destPath));
+        });
+    });
+}
+
+/**
+ * @brief Saves a compressed archive of the open data base, see compressed_vfs.hxx.
+ *
+ * DataStore::ExportCompressedArchive runs on the backup worker, so it can't
+ * overlap a Save As. The progress dialog pulses while the data base is
+ * copied and fills up as chunks are compressed. Cancelling leaves no archive.
+ *
+ * @param event The menu event. Unused.
+ */
+void MainFrame::OnSaveArchive(wxCommandEvent& event) {
+    if ( !m_backend.IsConnected() || m_backupWorker.joinable() )
+        return;
+
+    if ( m_backend.GetProfile().compressedArchive ) {
+        wxLogError("The open database is already a compressed archive. Use Save As to save an uncompressed copy.");
+        return;
+    }
+
+    wxFileDialog dialog(
+        this,
+        "Save Compressed Archive",
+        wxEmptyString, wxFileName(wxString::FromUTF8(m_backend.GetPath())).GetName() + ".sqlz",
+        "Compressed archives (*.sqlz)|*.sqlz|All files (*.*)|*.*",
+        wxFD_SAVE | wxFD_OVERWRITE_PROMPT
+    );
+
+    if ( dialog.ShowModal() != wxID_OK )
+        return;
+
+    constexpr int PROGRESS_RANGE = 1000;
+    m_backupProgress = new wxProgressDialog(
+        "Saving Compressed Archive",
+        "Copying database...",
+        PROGRESS_RANGE,
+        this,
+        wxPD_CAN_ABORT | wxPD_AUTO_HIDE | wxPD_ELAPSED_TIME
+    );
+    m_backupProgress->Pulse();
+
+    std::string destPath = dialog.GetPath().utf8_string();
+    m_backupWorker = std::jthread([this, destPath](std::stop_token stop) {
+        ArchiveProgress result;
+        bool ok = m_backend.ExportCompressedArchive(destPath, [this, &result](const ArchiveProgress& progress) {
+            result = progress;
+            CallAfter([this, progress]() {
+                if ( !m_backupProgress )
+                    return;
+
+                constexpr double MB = 1024.0 * 1024.0;
+                wxString message = wxString::Format(
+                    "Compressed %.1f of %.1f MB into %.1f MB",
+                    progress.bytesRead / MB, progress.totalBytes / MB, progress.bytesWritten / MB
+                );
+
+                // Update returns false once the user pressed cancel
+                if ( !m_backupProgress->Update(static_cast<int>(progress.Fraction() * PROGRESS_RANGE), message) )
+                    m_backupWorker.request_stop();
+            });
+        }, stop);
+
+        CallAfter([this, ok, destPath, result]() {
+            m_backupProgress->Destroy();
+            m_backupProgress = nullptr;
+            m_backupWorker.join();
+
+            if ( ok )
+                wxLogMessage(
+                    "Saved compressed archive '%s', %.1fx smaller than the database",
+                    wxString::FromUTF8(destPath),
+                    result.bytesWritten ? double(result.totalBytes) / result.bytesWritten : 0.0
+                );
+            else
+                wxLogError("Could not save a compressed archive to '%s'", wxString::FromUTF8(destPath));
+        });
+    });
+}
+
+/**
+ * @brief Writes the open data base to a SQL script, like the sqlite3 shell's .dump.
+ *
+ * DataStore::ExportDump runs on a background thread, generating tables in
+ * parallel on read connections of their own, so the data base stays usable
+ * while it runs. The progress dialog can cancel it, in which case the
+ * partial file is removed.
+ *
+ * @param event The menu event. Unused.
+ */
+void MainFrame::OnExportDump(wxCommandEvent& event) {
+    if ( !m_backend.IsConnected() || m_dumpWorker.joinable() )
+        return;
+
+    wxFileDialog dialog(
+        this,
+        "Export SQL Dump",
+        wxEmptyString, wxFileName(wxString::FromUTF8(m_backend.GetPath())).GetName() + ".sql",
+        "SQL dumps (*.sql)|*.sql|Compressed SQL dumps (*.sql.gz)|*.sql.gz|All files (*.*)|*.*",
+        wxFD_SAVE | wxFD_OVERWRITE_PROMPT
+    );
+
+    if ( dialog.ShowModal() != wxID_OK )
+        return;
+
+    m_dumpProgress = new wxProgressDialog(
+        "Exporting SQL Dump",
+        "Reading schema...",
+        1,
+        this,
+        wxPD_CAN_ABORT | wxPD_AUTO_HIDE | wxPD_ELAPSED_TIME | wxPD_REMAINING_TIME
+    );
+
+    std::string destPath = dialog.GetPath().utf8_string();
+    m_dumpWorker = std::jthread([this, destPath](std::stop_token stop) {
+        auto onProgress = [this](const DumpProgress& progress) {
+            CallAfter([this, progress]() {
+                if ( !m_dumpProgress )
+                    return;
+
+                wxString message = wxString::Format(
+                    "Wrote %zu of %zu tables, %llu rows (%.1f MB)",
+                    progress.tablesDone, progress.tableCount,
+                    static_cast<unsigned long long>(progress.rows),
+                    progress.bytesWritten / ( 1024.0 * 1024.0 )
+                );
+
+                // Update returns false once the user pressed cancel
+                m_dumpProgress->SetRange(static_cast<int>(std::max<size_t>(1, progress.tableCount)));
+                if ( !m_dumpProgress->Update(static_cast<int>(std::min(progress.tablesDone, progress.tableCount)), message) )
+                    m_dumpWorker.request_stop();
+            });
+        };
+
+        std::vector<char> buffer(1 << 20);
+        std::ofstream out;
+        out.rdbuf()->pubsetbuf(buffer.data(), buffer.size());
+        out.open(destPath, std::ios::binary | std::ios::trunc);
+
+        // Compressed on all cores while the tables are being generated
+        std::unique_ptr<GzipOStream> compressed;
+        if ( IsGzipPath(destPath) )
+            compressed = std::make_unique<GzipOStream>(out);
+
+        DumpProgress result;
+        bool ok = out && m_backend.ExportDump(compressed ? *compressed : out, [&result, &onProgress](const DumpProgress& progress) {
+            result = progress;
+            onProgress(progress);
+        }, stop);
+        if ( compressed )
+            ok = compressed->Close() && ok;
+        out.close();
+
+        if ( !ok )
+            std::remove(destPath.c_str());
+
+        CallAfter([this, ok, destPath, result, cancelled = stop.stop_requested()]() {
+            m_dumpProgress->Destroy();
+            m_dumpProgress = nullptr;
+            m_dumpWorker.join();
+
+            if ( ok )
+                wxLogMessage(
+                    "Exported %zu tables, %llu rows to '%s' in %.2f s",
+                    result.tableCount, static_cast<unsigned long long>(result.rows),
+                    wxString::FromUTF8(destPath), result.elapsedSeconds
+                );
+            else if ( cancelled )
+                wxLogMessage("SQL dump to '%s' cancelled", wxString::FromUTF8(destPath));
+            else
+                wxLogError("Could not export a SQL dump to '%s'", wxString::FromUTF8(destPath));
+        });
+    });
+}
+
+/**
+ * @brief Compares the open data base with an older copy of it, in a "Diff" tab.
+ *
+ * The comparison runs with DiffDatabases on a worker thread, on connections of
+ * its own, so the open data base stays usable. Tables are added to the tab as
+ * they finish. Starting a new comparison cancels the one in progress.
+ *
+ * @param event The menu event. Unused.
+ */
+void MainFrame::OnCompareDatabase(wxCommandEvent& event) {
+    if ( !m_backend.IsConnected() )
+        return;
+
+    wxFileDialog dialog(
+        this,
+        "Compare With",
+        wxEmptyString, wxEmptyString,
+        "SQLite databases (*.db;*.sqlite;*.sqlite3)|*.db;*.sqlite;*.sqlite3|All files (*.*)|*.*",
+        wxFD_OPEN | wxFD_FILE_MUST_EXIST
+    );
+
+    if ( dialog.ShowModal() != wxID_OK )
+        return;
+
+    m_diffWorker = std::jthread(); // stops and joins any comparison in progress
+
+    // The tab may have been closed since the last comparison
+    if ( !m_diffView || m_notebook->GetPageIndex(m_diffView) == wxNOT_FOUND ) {
+        m_diffView = new DiffView(m_notebook);
+        m_notebook->AddPage(m_diffView, "Diff", true);
+    } else {
+        m_notebook->SetSelection(m_notebook->GetPageIndex(m_diffView));
+    }
+
+    std::string oldPath = dialog.GetPath().utf8_string();
+    std::string newPath = m_backend.GetPath();
+    m_diffView->Start(dialog.GetFilename(), wxFileName(wxString::FromUTF8(newPath)).GetFullName());
+
+    m_diffWorker = std::jthread([this, oldPath, newPath](std::stop_token stop) {
+        auto start = std::chrono::steady_clock::now();
+
+        // Results are dropped if the comparison was cancelled or its tab closed
+        auto stillShown = [this, stop]() {
+            return !stop.stop_requested() && m_notebook->GetPageIndex(m_diffView) != wxNOT_FOUND;
+        };
+
+        bool completed = DiffDatabases(oldPath, newPath, [this, stillShown](const TableDiff& diff) {
+            CallAfter([this, stillShown, diff]() {
+                if ( stillShown() )
+                    m_diffView->AddTable(diff);
+            });
+        }, stop);
+
+        double seconds = std::chrono::duration<double>(std::chrono::steady_clock::now() - start).count();
+        CallAfter([this, stillShown, completed, seconds]() {
+            if ( stillShown() )
+                m_diffView->Finish(completed, seconds);
+        });
+    });
+}
+
+/**
+ * @brief Shows the I/O statistics tab, creating it if it isn't open.
+ *
+ * @param event The menu event. Unused.
+ */
+void MainFrame::OnShowIoStats(wxCommandEvent& event) {
+    // The tab may have been closed since it was last shown
+    if ( !m_diagnosticsView || m_notebook->GetPageIndex(m_diagnosticsView) == wxNOT_FOUND ) {
+        m_diagnosticsView = new DiagnosticsView(m_notebook);
+        m_notebook->AddPage(m_diagnosticsView, "I/O", true);
+    } else {
+        m_notebook->SetSelection(m_notebook->GetPageIndex(m_diagnosticsView));
+        m_diagnosticsView->ShowCounters();
+    }
+}
+
+/**
+ * @brief Records an edited cell in the edit journal.
+ *
+ * Edits are only kept in memory and highlighted until they are saved,
+ * at which point the whole journal is written in one transaction.
+ *
+ * @param event The grid event containing the edited row and column.
+ */
+void MainFrame::OnGridCellChanged(wxGridEvent& event) {
+    int row = event.GetRow();
+    int col = event.GetCol();
+    std::string column = m_tableDataView->GetColLabelValue(col).utf8_string();
+    std::string value = m_tableDataView->GetCellValue(row, col).utf8_string();
+
+    // Rows past the loaded rowids are new rows added with OnNewRecord
+    if ( row < static_cast<int>(m_rowIds.size()) )
+        m_editJournal.SetCell(m_rowIds[row], column, value);
+    else
+        m_editJournal.SetNewRowCell(row - m_rowIds.size(), column, value);
+
+    m_tableDataView->SetCellBackgroundColour(row, col, AppColours::Records::EDITED);
+    event.Skip();
+}
+
+/**
+ * @brief Writes all pending grid edits to the data base.
+ *
+ * Bound to both the save button above the grid and File > Save. The journal
+ * is committed as a single transaction, so saving any number of rows costs one
+ * sync to disk. The resulting changeset is kept so the save can be undone.
+ * A data base opened in memory is then written back to its file in full.
+ *
+ * @param event The button or menu event. Unused.
+ */
+void MainFrame::OnSaveRecords(wxCommandEvent& event) {
+    if ( !m_backend.IsConnected() )
+        return;
+
+    // Commit the cell being edited, if any, so it is part of the save
+    m_tableDataView->SaveEditControlValue();
+
+    // Edits to a data base opened in memory are written to the file
+    // on every save, along with anything changed from the SQL editor
+    const ConnectProfile& profile = m_backend.GetProfile();
+    bool writeBack = profile.inMemory && !profile.compressedArchive;
+    if ( m_editJournal.Empty() ) {
+        if ( writeBack && !m_backupWorker.joinable() )
+            SaveCopy(m_backend.GetPath());
+        return;
+    }
+
+    PauseRowCounts(); // its read lock would keep the commit out
+    RevalidateMetadata();
+    Changeset undo;
+    if ( !m_backend.CommitEdits(m_shownTable, m_editJournal, undo) ) {
+        wxLogError("Could not save changes to '%s'. No changes were written.", wxString::FromUTF8(m_shownTable));
+        StartRowCounts(); // nothing changed, carry on counting
+        return;
+    }
+
+    m_searchIndex.MarkDirty(m_shownTable);
+    m_metadata.ForgetTable(m_shownTable);
+    RekeyMetadata();
+    ShowRowCount(m_shownTable);
+    if ( !undo.empty() ) {
+        m_undoStack.emplace_back(m_shownTable, std::move(undo));
+        if ( m_undoStack.size() > UNDO_LIMIT )
+            m_undoStack.erase(m_undoStack.begin());
+    }
+
+    LoadTableRecords(m_shownTable);
+
+    if ( writeBack ) {
+        if ( m_backupWorker.joinable() )
+            wxLogWarning("Changes are saved in memory only, a backup is still running. Save again once it finishes.");
+        else
+            SaveCopy(m_backend.GetPath());
+    }
+}
+
+/**
+ * @brief Appends a blank row to the grid, inserted into the table on save.
+ *
+ * @param event The button event. Unused.
+ */
+void MainFrame::OnNewRecord(wxCommandEvent& event) {
+    if ( !m_backend.IsConnected() || m_shownTable.empty() )
+        return;
+
+    m_editJournal.AddRow();
+    m_tableDataView->AppendRows(1);
+
+    int row = m_tableDataView->GetNumberRows() - 1;
+    m_tableDataView->SetRowLabelValue(row, "*");
+    m_tableDataView->MakeCellVisible(row, 0);
+    m_tableDataView->SetGridCursor(row, 0);
+}
+
+/**
+ * @brief Removes the selected rows from the grid, deleted from the table on save.
+ *
+ * Uses the fully selected rows if there are any, otherwise the row
+ * with the grid cursor.
+ *
+ * @param event The button event. Unused.
+ */
+void MainFrame::OnDeleteRecord(wxCommandEvent& event) {
+    if ( !m_backend.IsConnected() )
+        return;
+
+    wxArrayInt selected = m_tableDataView->GetSelectedRows();
+    std::vector<int> rows(selected.begin(), selected.end());
+    if ( rows.empty() && m_tableDataView->GetGridCursorRow() >= 0 )
+        rows.push_back(m_tableDataView->GetGridCursorRow());
+
+    // Delete from the bottom up so earlier indices stay valid
+    std::sort(rows.rbegin(), rows.rend());
+    for ( int row : rows ) {
+        if ( row < static_cast<int>(m_rowIds.size()) ) {
+            m_editJournal.DeleteRow(m_rowIds[row]);
+            m_rowIds.erase(m_rowIds.begin() + row);
+        } else {
+            m_editJournal.RemoveNewRow(row - m_rowIds.size());
+        }
+
+        m_tableDataView->DeleteRows(row);
+    }
+}
+
+/**
+ * @brief Undoes the last change to the records grid, or editor text.
+ *
+ * When the grid has focus, pending edits are discarded first. Without pending
+ * edits the most recently saved batch is reverted by applying the inverse of
+ * its changeset, and the table it was saved to is shown, which need not be
+ * the one shown now. Anywhere else this falls back to undo in the SQL editor.
+ *
+ * @param event The menu event. Unused.
+ */
+void MainFrame::OnUndo(wxCommandEvent& event) {
+    wxWindow* focus = FindFocus();
+    bool gridFocused = focus && ( focus == m_tableDataView || m_tableDataView->IsDescendant(focus) );
+    if ( !gridFocused ) {
+        m_textEditor->Undo();
+        return;
+    }
+
+    if ( !m_editJournal.Empty() ) {
+        LoadTableRecords(m_shownTable);
+        return;
+    }
+
+    if ( m_undoStack.empty() )
+        return;
+
+    PauseRowCounts();
+    RevalidateMetadata();
+    std::string table = m_undoStack.back().first;
+    if ( !m_backend.UndoChangeset(m_undoStack.back().second) ) {
+        wxLogError("Could not undo the last save, the rows have been changed since.");
+        StartRowCounts(); // nothing changed, carry on counting
+        return;
+    }
+
+    m_undoStack.pop_back();
+    m_searchIndex.MarkDirty(table);
+    m_metadata.ForgetTable(table);
+    RekeyMetadata();
+    ShowRowCount(table);
+
+    // There are no pending edits here, switching tables loses nothing
+    if ( table != m_shownTable )
+        m_tableSelector->SetStringSelection(wxString::FromUTF8(table));
+    LoadTableRecords(table);
+}
+
+/**
+ * @brief Searches the text of every table for the words in the search box.
+ *
+ * The search index is brought up to date and queried on a worker thread.
+ * The first search of a data base builds the whole index, later ones only
+ * re-index tables that changed, so they return in milliseconds. Starting a
+ * new search cancels the previous one.
+ *
+ * @param event The search or enter event. Unused.
+ */
+void MainFrame::OnSearch(wxCommandEvent& event) {
+    std::string query = m_searchBox->GetValue().utf8_string();
+    if ( !m_backend.IsConnected() || query.empty() )
+        return;
+
+    m_searchWorker = std::jthread(); // stops and joins any search in progress
+    PauseRowCounts();
+    SetStatusText(m_searchIndex.TableCount() ? "Searching..." : "Indexing tables for search...");
+
+    m_searchWorker = std::jthread([this, path = m_backend.GetReadPath(), vfs = m_backend.VfsName(), query](std::stop_token stop) {
+        if ( !m_searchIndex.Refresh(path, vfs, stop) ) {
+            CallAfter([this, stop]() {
+                if ( !stop.stop_requested() )
+                    SetStatusText("Could not index the database for search");
+            });
+            return;
+        }
+
+        auto start = std::chrono::steady_clock::now();
+        std::vector<SearchHit> hits = m_searchIndex.Search(query);
+        double milliseconds = std::chrono::duration<double, std::milli>(std::chrono::steady_clock::now() - start).count();
+
+        CallAfter([this, stop, hits, milliseconds]() {
+            if ( !stop.stop_requested() )
+                ShowSearchHits(hits, milliseconds);
+        });
+    });
+}
+
+/**
+ * @brief Lists search hits in a "Search results" node at the bottom of the tree.
+ *
+ * @param hits         The hits, at most SearchIndex::MAX_HITS.
+ * @param milliseconds How long the search took, shown in the status bar.
+ */
+void MainFrame::ShowSearchHits(const std::vector<SearchHit>& hits, double milliseconds) {
+    m_treeView->Freeze();
+    ClearSearchHits();
+
+    m_searchResults = m_treeView->AppendContainer(wxDataViewItem(nullptr), wxString::Format("Search results (%zu)", hits.size()));
+    for ( const SearchHit& hit : hits ) {
+        wxString text = wxString::FromUTF8(hit.table + "." + hit.column) + wxString::Format(" #%lld: ", static_cast<long long>(hit.rowId)) + wxString::FromUTF8(hit.snippet);
+        text.Replace("\n", " ");
+        m_treeView->AppendItem(m_searchResults, text, -1, new SearchHitData(hit));
+    }
+
+    m_treeView->Expand(m_searchResults);
+    m_treeView->Thaw();
+
+    wxString status = wxString::Format("%zu matches in %.1f ms", hits.size(), milliseconds);
+    if ( hits.size() >= SearchIndex::MAX_HITS )
+        status += ", showing the first " + std::to_string(SearchIndex::MAX_HITS);
+    SetStatusText(status);
+}
+
+/**
+ * @brief Removes the "Search results" node, if any, from the tree.
+ */
+void MainFrame::ClearSearchHits() {
+    if ( !m_searchResults.IsOk() )
+        return;
+
+    m_treeView->DeleteItem(m_searchResults);
+    m_searchResults = wxDataViewItem();
+}
+
+/**
+ * @brief Jumps to the row of a search hit when it is activated in the tree.
+ *
+ * @param event The tree event. Skipped for items that aren't search hits.
+ */
+void MainFrame::OnSearchHitActivated(wxDataViewEvent& event) {
+    wxDataViewItem item = event.GetItem();
+    SearchHitData* data = item.IsOk() ? dynamic_cast<SearchHitData*>(m_treeView->GetItemData(item)) : nullptr;
+    if ( !data ) {
+        event.Skip();
+        return;
+    }
+
+    JumpToSearchHit(data->hit);
+}
+
+/**
+ * @brief Shows the table of a search hit in the Records tab and selects its cell.
+ *
+ * Only rows loaded in the grid can be selected. For hits further into a
+ * large table the status bar says so instead.
+ *
+ * @param hit The search hit to show.
+ */
+void MainFrame::JumpToSearchHit(const SearchHit& hit) {
+    if ( hit.table != m_shownTable ) {
+        if ( !m_editJournal.Empty() ) {
+            int answer = wxMessageBox("Discard unsaved changes to the current table?", "Unsaved Changes", wxYES_NO | wxICON_WARNING, this);
+            if ( answer != wxYES )
+                return;
+        }
+
+        m_tableSelector->SetStringSelection(wxString::FromUTF8(hit.table));
+        LoadTableRecords(hit.table);
+    }
+
+    // The grid sits on a panel of the splitter that is the Records page
+    int page = m_notebook->GetPageIndex(m_tableDataView->GetGrandParent());
+    if ( page != wxNOT_FOUND )
+        m_notebook->SetSelection(page);
+
+    auto row = std::find(m_rowIds.begin(), m_rowIds.end(), hit.rowId);
+    if ( row == m_rowIds.end() ) {
+        SetStatusText(wxString::Format("Row %lld of '%s' is not among the rows loaded in the grid", static_cast<long long>(hit.rowId), wxString::FromUTF8(hit.table)));
+        return;
+    }
+
+    int col = 0;
+    for ( int i = 0; i < m_tableDataView->GetNumberCols(); i++ ) {
+        if ( m_tableDataView->GetColLabelValue(i).utf8_string() == hit.column )
+            col = i;
+    }
+
+    m_tableDataView->GoToCell(static_cast<int>(row - m_rowIds.begin()), col);
+    m_tableDataView->SetFocus();
+}
+
+#ifdef SQLIGHT_ENABLE_TRACING
+/**
+ * @brief Marks the first paint of the main window in the startup trace.
+ *
+ * Only bound in tracing builds. When SQLIGHT_BENCHMARK_STARTUP is set the
+ * time to first paint and the SQLite I/O done until then are printed to
+ * stdout and the application closes, which is what benchmarks/cold_start.sh
+ * measures.
+ *
+ * @param event The paint event. Always skipped so painting proceeds normally.
+ */
+void MainFrame::OnFirstPaint(wxPaintEvent& event) {
+    event.Skip();
+    m_windowSplitterPanel->Unbind(wxEVT_PAINT, &MainFrame::OnFirstPaint, this);
+    TRACE_INSTANT("first paint");
+
+    if ( !wxGetEnv("SQLIGHT_BENCHMARK_STARTUP", nullptr) )
+        return;
+
+    // Everything SQLite read and wrote, from every file, to get this far
+    IoStats stats = ReadIoStats();
+    unsigned long long reads = 0, bytesRead = 0;
+    for ( const FileIoStats& file : stats.files ) {
+        reads += file.reads;
+        bytesRead += file.bytesRead;
+    }
+
+    std::printf("first_paint_ms=%.3f\n", Trace::ElapsedMs());
+    std::printf("io_reads=%llu io_bytes_read=%llu\n", reads, bytesRead);
+    std::fflush(stdout);
+    CallAfter([this]() { Close(true); });
+}
+#endif
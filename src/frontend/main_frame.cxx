@@ -4,6 +4,19 @@
 // WX
 #include <wx/splitter.h>
 #include <wx/listctrl.h>
+#include <wx/filename.h>
+#include <wx/numformatter.h>
+
+// STD
+#include <algorithm>
+#include <optional>
+
+namespace {
+    constexpr int RECORDS_PAGE_SIZE = 1000; // Rows loaded into the grid at once
+    constexpr uint64_t LARGE_SCRIPT_SIZE = 16 << 20; // Larger scripts open in large script mode
+    constexpr uint64_t SCRIPT_LOAD_CHUNK_SIZE = 4 << 20; // Bytes appended to the editor per pass of the event loop
+    constexpr int ROW_COUNT_IDLE_MS = 2000; // Quiet time after a user action before row counting resumes
+}
 
 /**
  * @brief Constructs the main application window and initializes all UI components.
@@ -17,8 +30,9 @@
  *   * Command output console
  *
  * The window is initialized with default size (800x600) and sets up:
- * - Image handlers for wxWidgets
+ * - The PNG image handler for wxWidgets
  * - Default window title ("SQLight - No file open")
+ * - A status bar for progress of background work
  * - Minimum pane size constraints
  * - Menu bar functionality
  *
@@ -26,10 +40,18 @@
  *              This is initially overridden by "SQLight - No file open".
  */
 MainFrame::MainFrame(std::string_view title)
-    : wxFrame(nullptr, wxID_ANY, title.data(), wxDefaultPosition, wxSize(800, 600))
+    : wxFrame(nullptr, wxID_ANY, title.data(), wxDefaultPosition, wxSize(800, 600)), m_rowCountTimer(this)
 {
-    wxInitAllImageHandlers();
+    TRACE_SCOPE("MainFrame::MainFrame");
+
+    // Icons are embedded as raw pixels, so only PNG is needed up front.
+    // The other handlers are registered when a BLOB is first previewed.
+    {
+        TRACE_SCOPE("Register image handlers");
+        wxImage::AddHandler(new wxPNGHandler);
+    }
     SetTitle("SQLight - No file open");
+    CreateStatusBar();
 
     // Splitter between left and right
     m_windowSplitterPanel = new wxSplitterWindow(this, wxID_ANY);
@@ -43,6 +65,34 @@ MainFrame::MainFrame(std::string_view title)
     m_windowSplitterPanel->SplitVertically(m_windowLeftPanel, m_windowRightPanel);
     m_windowSplitterPanel->SetSashGravity(0);
     m_windowSplitterPanel->SetSashPosition(m_windowSplitterPanel->GetMinimumPaneSize());
+
+    Bind(wxEVT_TIMER, [this](wxTimerEvent&) {
+        StartRowCounts();
+    }, m_rowCountTimer.GetId());
+
+#ifdef SQLIGHT_ENABLE_TRACING
+    m_windowSplitterPanel->Bind(wxEVT_PAINT, &MainFrame::OnFirstPaint, this);
+#endif
+}
+
+/**
+ * @brief Closes the data base and restores the log target that was active before the Output tab took over.
+ *
+ * The Output tab is destroyed with the frame, so nothing may log into it afterwards.
+ */
+MainFrame::~MainFrame() {
+    // Workers read through m_backend, stop them before it is disconnected
+    m_openWorker = std::jthread();
+    m_statsWorker = std::jthread();
+    m_rowCountWorker = std::jthread();
+    m_searchWorker = std::jthread();
+    m_backupWorker = std::jthread();
+    m_dumpWorker = std::jthread();
+    m_scriptWorker = std::jthread();
+    m_blobViewer->Clear(); // an open BLOB handle would keep the connection open
+
+    CloseDatabase();
+    delete wxLog::SetActiveTarget(m_previousLog);
 }
 
 /**
@@ -93,8 +143,590 @@ wxString MainFrame::GetSQLWordList() {
     return kwds;
 }
 
-// TODO
+/**
+ * @brief Appends a column with the label 'name' to the records grid.
+ *
+ * @param name The column label, usually the name of the SQL column.
+ */
 void MainFrame::AppendTableColumn(const std::string& name) {
     if ( !m_tableDataView )
         return;
+
+    m_tableDataView->AppendCols(1);
+    m_tableDataView->SetColLabelValue(m_tableDataView->GetNumberCols() - 1, wxString::FromUTF8(name));
+}
+
+/**
+ * @brief Closes the current data base, if any, and starts opening the one at 'path'.
+ *
+ * Only the connection handle is opened here, which doesn't read the file, so
+ * the window stays responsive on huge or network mounted files. The schema is
+ * then read on a worker thread and the table dropdown filled once it arrives,
+ * unless the list saved in the data base's sidecar is still current, in which
+ * case it is shown straight away and the worker only checks its schema version.
+ * When File > Check Integrity on Open is ticked, the same worker goes on to run
+ * PRAGMA quick_check, reporting progress in the status bar. A data base
+ * opened in memory is the exception, the whole file is read before the
+ * connection is ready.
+ *
+ * Background work on the previous data base is stopped first, since it reads
+ * from the connection being replaced.
+ *
+ * @param path    Path to the SQLite data base file.
+ * @param profile How to open it, see ConnectProfile.
+ * @return true if the connection was opened. Errors reading the schema are reported later.
+ */
+bool MainFrame::OpenDatabase(const std::string& path, ConnectProfile profile) {
+    TRACE_SCOPE("MainFrame::OpenDatabase");
+
+    if ( m_backupWorker.joinable() ) {
+        wxLogError("Wait for the backup in progress to finish before opening another database.");
+        return false;
+    }
+
+    if ( m_dumpWorker.joinable() ) {
+        wxLogError("Wait for the SQL dump in progress to finish before opening another database.");
+        return false;
+    }
+
+    if ( m_scriptWorker.joinable() ) {
+        wxLogError("Wait for the script being executed to finish before opening another database.");
+        return false;
+    }
+
+    m_openWorker = std::jthread(); // stops and joins any schema load or integrity check
+    m_statsWorker = std::jthread(); // stops and joins any running scan
+    m_rowCountWorker = std::jthread();
+    m_rowCountTimer.Stop();
+    m_searchWorker = std::jthread(); // the index belongs to the data base being closed
+    m_searchIndex.Clear();
+    ClearSearchHits();
+    m_blobViewer->Clear(); // holds a pointer to the connection being closed
+    m_undoStack.clear();
+    ClearTableRecords();
+    RefreshTableList({});
+    SetStatusText(wxEmptyString);
+    CloseDatabase();
+
+    // Compressed archives are recognised by their header, whatever their name
+    profile.compressedArchive = IsCompressedArchive(path);
+
+    // Loading into memory reads the whole file before Connect returns
+    std::optional<wxBusyCursor> busy;
+    if ( profile.inMemory ) {
+        busy.emplace();
+        SetStatusText("Loading database into memory...");
+    }
+
+    if ( !m_backend.Connect(path, profile) ) {
+        SetStatusText(wxEmptyString);
+        wxLogError("Could not open database '%s'", wxString::FromUTF8(path));
+        SetTitle("SQLight - No file open");
+        return false;
+    }
+
+    wxString fileName = wxFileName(wxString::FromUTF8(path)).GetFullName();
+    if ( profile.compressedArchive && profile.inMemory )
+        fileName += " [compressed archive, in memory, changes not saved]";
+    else if ( profile.compressedArchive )
+        fileName += " [compressed archive, read-only]";
+    else if ( profile.inMemory )
+        fileName += " [in memory]";
+    else if ( profile.readOnly )
+        fileName += " [read-only]";
+    SetStatusText(wxEmptyString);
+    EnableWriting(!m_backend.IsReadOnly());
+    bool quickCheck = m_checkOnOpenItem->IsChecked();
+    SetTitle("SQLight - " + fileName + " (loading...)");
+
+    // The table list saved by the last session is shown right away and
+    // only read again if the schema changed since. A copy in memory may
+    // be edited without the file changing, so it doesn't use the sidecar
+    bool cached = !profile.inMemory && m_metadata.Load(path) && m_metadata.schemaVersion >= 0;
+    if ( cached )
+        RefreshTableList(m_metadata.tableNames);
+
+    m_openWorker = std::jthread([this, fileName, quickCheck, cached, cachedVersion = m_metadata.schemaVersion](std::stop_token stop) {
+        int64_t schemaVersion = -1;
+        std::vector<std::string> tableNames;
+        bool loaded = m_backend.ReadSchemaVersion(schemaVersion);
+        bool changed = !cached || schemaVersion != cachedVersion;
+        if ( loaded && changed )
+            loaded = m_backend.ReadTableNames(tableNames);
+
+        CallAfter([this, stop, fileName, loaded, changed, schemaVersion, tableNames]() {
+            if ( stop.stop_requested() )
+                return;
+
+            if ( !loaded ) {
+                m_openWorker = std::jthread(); // exits right after this, don't let it outlive the connection
+                m_metadata.Clear();
+                ClearTableRecords();
+                RefreshTableList({});
+                m_backend.Disconnect();
+                SetTitle("SQLight - No file open");
+                wxLogError("'%s' is not a readable SQLite database", fileName);
+                return;
+            }
+
+            SetTitle("SQLight - " + fileName);
+            if ( !changed )
+                return;
+
+            m_metadata.schemaVersion = schemaVersion;
+            m_metadata.tableNames = tableNames;
+            if ( m_editJournal.Empty() )
+                RefreshTableList(tableNames, m_shownTable);
+        });
+
+        if ( !loaded || !quickCheck || stop.stop_requested() )
+            return;
+
+        std::vector<std::string> problems;
+        bool checked = m_backend.QuickCheck(problems, [this, stop](double elapsed) {
+            CallAfter([this, stop, elapsed]() {
+                if ( !stop.stop_requested() )
+                    SetStatusText(wxString::Format("Checking integrity... %.1f s", elapsed));
+            });
+        }, stop);
+
+        CallAfter([this, stop, fileName, checked, problems]() {
+            if ( stop.stop_requested() )
+                return;
+
+            if ( !checked ) {
+                SetStatusText("Integrity check could not be completed");
+                return;
+            }
+
+            if ( problems.empty() ) {
+                SetStatusText("Integrity check passed");
+                return;
+            }
+
+            wxString details;
+            for ( const std::string& problem : problems )
+                details += wxString::FromUTF8(problem) + "\n";
+
+            SetStatusText(wxString::Format("Integrity check found %zu problem(s)", problems.size()));
+            wxLogWarning("Integrity check of '%s' found problems:\n%s", fileName, details);
+        });
+    });
+
+    return true;
+}
+
+/**
+ * @brief Fills the table dropdown and the tree's Tables node with 'tableNames'.
+ *
+ * The table named 'select' or, if there is no such table, the first table
+ * is selected and loaded into the records grid. Row counts known from the
+ * sidecar are shown right away, the rest are estimated and counted in the
+ * background.
+ *
+ * @param tableNames Tables of the open data base, as read by DataStore::ReadTableNames.
+ *                   Empty to clear the list while no data base is open.
+ * @param select     Table to show, usually the one shown before the list changed.
+ */
+void MainFrame::RefreshTableList(const std::vector<std::string>& tableNames, const std::string& select) {
+    m_tableSelector->Clear();
+
+    m_treeView->Freeze();
+    m_treeStore->ClearDetails();
+    m_treeView->DeleteChildren(m_tablesNode);
+    m_tableItems.clear();
+    m_treeView->SetItemText(m_tablesNode, wxString::Format("Tables (%zu)", tableNames.size()));
+
+    for ( const std::string& name : tableNames ) {
+        m_tableSelector->Append(wxString::FromUTF8(name));
+        m_tableItems[name] = m_treeView->AppendItem(m_tablesNode, wxString::FromUTF8(name));
+        ShowRowCount(name);
+    }
+    m_treeView->Thaw();
+
+    if ( !tableNames.empty() ) {
+        int index = select.empty() ? wxNOT_FOUND : m_tableSelector->FindString(wxString::FromUTF8(select), true);
+        if ( index == wxNOT_FOUND )
+            index = 0;
+
+        m_tableSelector->SetSelection(index);
+        LoadTableRecords(m_tableSelector->GetString(index).utf8_string());
+    }
+
+    // Started last, moving the grid cursor while loading pauses it
+    StartRowCounts();
+}
+
+/**
+ * @brief Estimates the row count of every table in the tree, then counts them exactly.
+ *
+ * COUNT(*) reads the whole table, so the tree first shows estimates, which
+ * cost a few page reads per table. The exact counts follow on
+ * m_rowCountWorker, smallest tables first, so most of the tree is exact
+ * soon and the few huge tables finish last. Tables already counted, this
+ * session or by an earlier one on an unchanged file, are skipped.
+ */
+void MainFrame::StartRowCounts() {
+    m_rowCountTimer.Stop();
+    m_rowCountWorker = std::jthread();
+
+    // A script writes for as long as it runs, wait for it to finish
+    if ( m_scriptWorker.joinable() ) {
+        m_rowCountTimer.StartOnce(ROW_COUNT_IDLE_MS);
+        return;
+    }
+
+    bool estimate = false;
+    std::vector<std::pair<uint64_t, std::string>> pending; // (estimate, table), to sort by size
+    for ( const auto& [name, item] : m_tableItems ) {
+        auto count = m_metadata.rowCounts.find(name);
+        if ( count == m_metadata.rowCounts.end() ) {
+            estimate = true;
+            pending.emplace_back(UINT64_MAX, name);
+        } else if ( !count->second.exact ) {
+            pending.emplace_back(count->second.rows, name);
+        }
+    }
+
+    if ( pending.empty() )
+        return;
+
+    m_rowCountWorker = std::jthread([this, estimate, pending](std::stop_token stop) mutable {
+        std::map<std::string, RowCount> estimates;
+        if ( estimate && m_backend.EstimateRowCounts(estimates, stop) ) {
+            CallAfter([this, stop, estimates]() {
+                if ( stop.stop_requested() )
+                    return;
+
+                // sqlite_stat1 may still list tables dropped since ANALYZE
+                for ( const auto& [table, estimated] : estimates ) {
+                    if ( !m_tableItems.contains(table) )
+                        continue;
+
+                    RowCount& count = m_metadata.rowCounts[table];
+                    if ( !count.exact ) {
+                        count = estimated;
+                        ShowRowCount(table);
+                    }
+                }
+            });
+        }
+
+        // Empty tables, and those on a single page, are counted already
+        std::erase_if(pending, [&estimates](const auto& entry) {
+            auto estimated = estimates.find(entry.second);
+            return estimated != estimates.end() && estimated->second.exact;
+        });
+
+        // Smallest first. Tables without an estimate go last
+        for ( auto& [rows, table] : pending ) {
+            auto estimated = estimates.find(table);
+            if ( estimated != estimates.end() )
+                rows = estimated->second.rows;
+        }
+        std::sort(pending.begin(), pending.end());
+
+        std::vector<std::string> tableNames;
+        for ( const auto& [rows, table] : pending )
+            tableNames.push_back(table);
+
+        m_backend.CountRows(tableNames, [this, stop](const std::string& table, uint64_t rows) {
+            CallAfter([this, stop, table, rows]() {
+                if ( stop.stop_requested() )
+                    return;
+
+                m_metadata.rowCounts[table] = { rows, true };
+                ShowRowCount(table);
+            });
+        }, stop);
+    });
+}
+
+/**
+ * @brief Stops counting rows while the user works, and resumes once they are idle.
+ *
+ * Counting competes with the user's own queries for the disk, and outside
+ * WAL mode its read lock keeps writes out. Actions that read or write a
+ * lot call this first, counting starts again on the tables still left
+ * once ROW_COUNT_IDLE_MS pass without another.
+ */
+void MainFrame::PauseRowCounts() {
+    m_rowCountWorker = std::jthread(); // interrupts the table being counted
+    if ( m_backend.IsConnected() )
+        m_rowCountTimer.StartOnce(ROW_COUNT_IDLE_MS);
+}
+
+/**
+ * @brief Shows the row count m_metadata has for a table in the tree's Type column.
+ *
+ * Estimates are marked with a '~'. Tables without a count yet show nothing.
+ *
+ * @param tableName Table whose item to update, ignored if it isn't in the tree.
+ */
+void MainFrame::ShowRowCount(const std::string& tableName) {
+    auto item = m_tableItems.find(tableName);
+    if ( item == m_tableItems.end() )
+        return;
+
+    wxString detail;
+    auto count = m_metadata.rowCounts.find(tableName);
+    if ( count != m_metadata.rowCounts.end() ) {
+        detail = count->second.exact ? "" : "~";
+        detail += wxNumberFormatter::ToString(static_cast<wxLongLong_t>(count->second.rows));
+        detail += count->second.rows == 1 ? " row" : " rows";
+    }
+
+    m_treeStore->SetDetail(item->second, detail);
+}
+
+/**
+ * @brief Replaces the contents of the records grid with rows from a table.
+ *
+ * At most RECORDS_PAGE_SIZE rows are read. Grid updates are batched so the
+ * grid is only repainted once all cells have been set.
+ *
+ * @param tableName Name of the table to display.
+ */
+void MainFrame::LoadTableRecords(const std::string& tableName) {
+    TableRecords records;
+    if ( !m_backend.FetchRecords(tableName, RECORDS_PAGE_SIZE, records) )
+        return;
+
+    m_tableDataView->BeginBatch();
+
+    if ( m_tableDataView->GetNumberRows() > 0 )
+        m_tableDataView->DeleteRows(0, m_tableDataView->GetNumberRows());
+    if ( m_tableDataView->GetNumberCols() > 0 )
+        m_tableDataView->DeleteCols(0, m_tableDataView->GetNumberCols());
+
+    for ( const std::string& column : records.columns )
+        AppendTableColumn(column);
+
+    m_tableDataView->AppendRows(static_cast<int>(records.cells.size()));
+    for ( size_t row = 0; row < records.cells.size(); row++ ) {
+        for ( size_t col = 0; col < records.cells[row].size(); col++ )
+            m_tableDataView->SetCellValue(static_cast<int>(row), static_cast<int>(col), wxString::FromUTF8(records.cells[row][col]));
+    }
+
+    // The grid only holds placeholders for BLOBs, they can't be edited as text
+    for ( const auto& [row, col] : records.blobCells )
+        m_tableDataView->SetReadOnly(static_cast<int>(row), static_cast<int>(col));
+
+    m_tableDataView->EndBatch();
+    m_shownTable = tableName;
+    m_rowIds = std::move(records.rowIds);
+    m_editJournal.Clear();
+
+    // Stats belong to the previous table
+    m_statsWorker = std::jthread();
+    m_statsColumn = -1;
+    m_selectedCell = wxGridCellCoords();
+    m_uiUpdates.Cancel(m_cellInfoUpdate); // would read the rows just deleted
+    m_cellInfo->SetValue("Cell information will appear here...");
+    m_blobViewer->Clear();
+    m_blobViewer->Hide();
+    m_blobViewer->GetParent()->Layout();
+}
+
+/**
+ * @brief Disconnects from the open data base and saves what was learned about it to its sidecar, see MetadataCache.
+ *
+ * Row counts and column stats are only kept if the file is still as it was
+ * when they were loaded, or last written by this session. The identity is
+ * then read again once the connection is closed, since closing checkpoints
+ * and removes the WAL, so the next open finds the file as it was saved.
+ * Nothing is written next to a data base opened read-only or as an archive,
+ * which may sit on read-only media or shared storage; a sidecar left by an
+ * earlier read-write session is still used when it is opened. Failing to
+ * save otherwise only costs the next open its head start.
+ */
+void MainFrame::CloseDatabase() {
+    std::string path = m_backend.GetPath();
+    bool save = m_backend.IsConnected() && !m_backend.GetProfile().inMemory && !m_backend.IsReadOnly();
+    save = save && !( m_metadata.schemaVersion < 0 && m_metadata.rowCounts.empty() && m_metadata.columnStats.empty() ); // Nothing learned, don't leave an empty sidecar behind
+
+    if ( save )
+        m_metadata.Revalidate(path);
+
+    m_backend.Disconnect();
+
+    if ( save ) {
+        m_metadata.Rekey(path);
+        m_metadata.Save(path);
+    }
+    m_metadata.Clear();
+}
+
+/**
+ * @brief Drops the cached row counts and column stats if another process wrote to the data base.
+ *
+ * Called before each write of this session, so RekeyMetadata afterwards
+ * only vouches for changes this session made.
+ */
+void MainFrame::RevalidateMetadata() {
+    if ( !m_backend.GetProfile().inMemory ) // the file isn't what a copy in memory is read from
+        m_metadata.Revalidate(m_backend.GetPath());
+}
+
+/**
+ * @brief Keys m_metadata to the data base file after this session wrote to it.
+ *
+ * The caller drops the entries of the tables written first.
+ */
+void MainFrame::RekeyMetadata() {
+    if ( !m_backend.GetProfile().inMemory )
+        m_metadata.Rekey(m_backend.GetPath());
+}
+
+/**
+ * @brief Enables or disables everything in the window that writes to the data base.
+ *
+ * Read-only data bases would refuse the writes anyway, this saves making
+ * edits in the grid only to have the save fail. The SQL editor stays
+ * usable, statements that write fail with SQLite's own error.
+ *
+ * @param enable false for a data base opened read-only or an archive.
+ */
+void MainFrame::EnableWriting(bool enable) {
+    m_tableDataView->EnableEditing(enable);
+    m_saveRecordsButton->Enable(enable);
+    m_newRecordButton->Enable(enable);
+    m_deleteRecordButton->Enable(enable);
+    m_importDumpItem->Enable(enable);
+    m_executeFileItem->Enable(enable);
+    GetMenuBar()->Enable(wxID_SAVE, enable); // Edit > Undo stays, it also undoes in the SQL editor and nothing can be saved to undo
+}
+
+/**
+ * @brief Empties the records grid and forgets the table it was showing.
+ *
+ * Used while a newly opened data base is still loading, so the grid
+ * never shows rows of a data base that is no longer open.
+ */
+void MainFrame::ClearTableRecords() {
+    m_tableDataView->BeginBatch();
+    if ( m_tableDataView->GetNumberRows() > 0 )
+        m_tableDataView->DeleteRows(0, m_tableDataView->GetNumberRows());
+    if ( m_tableDataView->GetNumberCols() > 0 )
+        m_tableDataView->DeleteCols(0, m_tableDataView->GetNumberCols());
+    m_tableDataView->EndBatch();
+
+    m_shownTable.clear();
+    m_rowIds.clear();
+    m_editJournal.Clear();
+    m_statsColumn = -1;
+    m_selectedCell = wxGridCellCoords();
+    m_uiUpdates.Cancel(m_cellInfoUpdate);
+    m_cellInfo->SetValue("Cell information will appear here...");
+}
+
+/**
+ * @brief Loads the SQL script at 'path' into the editor.
+ *
+ * The file is memory mapped and appended in SCRIPT_LOAD_CHUNK_SIZE pieces,
+ * one per pass of the event loop, so the window keeps painting and the status
+ * bar shows progress while a large dump loads. Scripts over LARGE_SCRIPT_SIZE
+ * can be executed straight from the file instead, which is offered first when
+ * a data base is open. Opened anyway, they put the editor in large script mode.
+ *
+ * @param path Path to the script file.
+ */
+void MainFrame::OpenScript(const std::string& path) {
+    m_scriptLoadGeneration++; // abandons a load still in progress
+    if ( !m_scriptFile.Open(path) ) {
+        wxLogError("Could not open script '%s'", wxString::FromUTF8(path));
+        return;
+    }
+
+    wxString fileName = wxFileName(wxString::FromUTF8(path)).GetFullName();
+    bool large = m_scriptFile.Size() > LARGE_SCRIPT_SIZE;
+
+    if ( large && m_backend.IsConnected() ) {
+        int answer = wxMessageBox(
+            wxString::Format("'%s' is %.0f MB. Execute it directly from the file instead of opening it in the editor?", fileName, m_scriptFile.Size() / ( 1024.0 * 1024.0 )),
+            "Large Script",
+            wxYES_NO | wxCANCEL | wxICON_QUESTION,
+            this
+        );
+
+        if ( answer != wxNO ) {
+            m_scriptFile.Close();
+            if ( answer == wxYES )
+                ExecuteScriptFile(path);
+            return;
+        }
+    }
+
+    SetLargeScriptMode(large);
+    m_textEditor->SetReadOnly(false);
+    m_textEditor->SetUndoCollection(false);
+    m_textEditor->ClearAll();
+    m_notebook->SetPageText(m_notebook->GetPageIndex(m_textEditor), fileName);
+
+    m_scriptLoaded = 0;
+    LoadScriptChunk(m_scriptLoadGeneration);
+}
+
+/**
+ * @brief Appends the next SCRIPT_LOAD_CHUNK_SIZE bytes of m_scriptFile to the editor.
+ *
+ * Queues itself for the next pass of the event loop until the whole file is in.
+ * The bytes go to Scintilla as they are, it stores UTF-8 as well, so nothing is
+ * converted. The editor is read-only until loading finishes.
+ *
+ * @param generation Value of m_scriptLoadGeneration when the load started.
+ *                   A newer load makes the remaining chunks of this one no-ops.
+ */
+void MainFrame::LoadScriptChunk(int generation) {
+    if ( generation != m_scriptLoadGeneration || !m_scriptFile.IsOpen() )
+        return;
+
+    const char* data = m_scriptFile.Data();
+    uint64_t size = m_scriptFile.Size();
+    uint64_t end = std::min(size, m_scriptLoaded + SCRIPT_LOAD_CHUNK_SIZE);
+
+    // Don't split a multi-byte character between two chunks
+    while ( end < size && end > m_scriptLoaded && ( static_cast<unsigned char>(data[end]) & 0xC0 ) == 0x80 )
+        end--;
+
+    m_textEditor->SetReadOnly(false);
+    if ( end > m_scriptLoaded )
+        m_textEditor->AppendTextRaw(data + m_scriptLoaded, static_cast<int>(end - m_scriptLoaded));
+    m_scriptLoaded = end;
+
+    if ( end < size ) {
+        m_textEditor->SetReadOnly(true);
+        SetStatusText(wxString::Format("Loading script... %d%%", static_cast<int>(100 * end / size)));
+        CallAfter([this, generation]() { LoadScriptChunk(generation); });
+        return;
+    }
+
+    m_scriptFile.Close();
+    m_textEditor->SetUndoCollection(!m_largeScriptMode);
+    m_textEditor->EmptyUndoBuffer();
+    m_textEditor->SetSavePoint();
+    SetStatusText(wxString::Format(
+        "Loaded script, %d lines%s",
+        m_textEditor->GetLineCount(),
+        m_largeScriptMode ? " (large script mode: no highlighting or undo)" : ""
+    ));
+}
+
+/**
+ * @brief Switches editor features that cost time or memory proportional to the script.
+ *
+ * The SQL lexer has to style everything before the lines shown, so jumping
+ * to the end of a large dump would lex all of it first. In large mode the
+ * script is shown as plain text, only the visible lines' layout is cached and
+ * no undo history is kept, which would otherwise hold a second copy of any
+ * text replaced.
+ *
+ * @param large True for scripts over LARGE_SCRIPT_SIZE.
+ */
+void MainFrame::SetLargeScriptMode(bool large) {
+    m_largeScriptMode = large;
+
+    m_textEditor->SetLexer(large ? wxSTC_LEX_NULL : wxSTC_LEX_SQL);
+    m_textEditor->SetLayoutCache(large ? wxSTC_CACHE_PAGE : wxSTC_CACHE_CARET);
+    m_textEditor->SetIndentationGuides(large ? wxSTC_IV_NONE : wxSTC_IV_LOOKBOTH);
 }
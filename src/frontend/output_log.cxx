@@ -0,0 +1,226 @@
+// Frontend
+#include "frontend/output_log.hxx"
+#include "frontend/colours.hxx"
+
+// WX
+#include <wx/clipbrd.h>
+
+namespace {
+    wxString LevelText(wxLogLevel level) {
+        switch ( level ) {
+        case wxLOG_FatalError:
+        case wxLOG_Error: return "Error";
+        case wxLOG_Warning: return "Warning";
+        case wxLOG_Status: return "Status";
+        case wxLOG_Debug:
+        case wxLOG_Trace: return "Debug";
+        default: return "Info";
+        }
+    }
+}
+
+/**
+ * @brief Virtual list showing the records of its OutputLog.
+ *
+ * Text and colours are produced on demand for the rows being painted,
+ * the control itself stores nothing per row.
+ */
+class OutputLog::List : public wxListCtrl {
+public:
+    explicit List(OutputLog* log)
+        : wxListCtrl(log, wxID_ANY, wxDefaultPosition, wxDefaultSize, wxLC_REPORT | wxLC_VIRTUAL | wxNO_BORDER),
+          m_log(log)
+    {
+        m_errorAttr.SetTextColour(AppColours::Output::ERROR_TEXT);
+        m_warningAttr.SetTextColour(AppColours::Output::WARNING_TEXT);
+    }
+protected:
+    wxString OnGetItemText(long item, long column) const override {
+        const Record& record = m_log->At(static_cast<size_t>(item));
+        switch ( column ) {
+        case 0: return record.time.Format("%H:%M:%S.%l");
+        case 1: return LevelText(record.level);
+        default: return record.text;
+        }
+    }
+
+    wxListItemAttr* OnGetItemAttr(long item) const override {
+        wxLogLevel level = m_log->At(static_cast<size_t>(item)).level;
+        if ( level <= wxLOG_Error )
+            return &m_errorAttr;
+        if ( level == wxLOG_Warning )
+            return &m_warningAttr;
+        return nullptr;
+    }
+private:
+    OutputLog* m_log;
+    mutable wxListItemAttr m_errorAttr;
+    mutable wxListItemAttr m_warningAttr;
+};
+
+/**
+ * @brief Creates the panel with an empty log.
+ *
+ * @param parent The notebook hosting the Output tab.
+ */
+OutputLog::OutputLog(wxWindow* parent)
+    : wxPanel(parent, wxID_ANY), m_flushTimer(this)
+{
+    SetBackgroundColour(*wxWHITE);
+
+    m_list = new List(this);
+    m_list->AppendColumn("Time", wxLIST_FORMAT_LEFT, 90);
+    m_list->AppendColumn("Level", wxLIST_FORMAT_LEFT, 70);
+    m_list->AppendColumn("Message", wxLIST_FORMAT_LEFT, 1000);
+
+    wxBoxSizer* sizer = new wxBoxSizer(wxVERTICAL);
+    sizer->Add(m_list, 1, wxEXPAND | wxTOP, 5);
+    SetSizer(sizer);
+
+    Bind(wxEVT_TIMER, [this](wxTimerEvent&) { Flush(); }, m_flushTimer.GetId());
+
+    // Right click menu to copy the selected lines or empty the log
+    m_list->Bind(wxEVT_CONTEXT_MENU, [this](wxContextMenuEvent&) {
+        wxMenu menu;
+        menu.Append(wxID_COPY, "&Copy");
+        menu.Append(wxID_CLEAR, "C&lear");
+        menu.Enable(wxID_COPY, m_list->GetSelectedItemCount() > 0);
+
+        int choice = GetPopupMenuSelectionFromUser(menu);
+        if ( choice == wxID_CLEAR ) {
+            Clear();
+            return;
+        }
+
+        if ( choice != wxID_COPY || !wxTheClipboard->Open() )
+            return;
+
+        wxString text;
+        for ( long item = m_list->GetNextItem(-1, wxLIST_NEXT_ALL, wxLIST_STATE_SELECTED); item != -1;
+              item = m_list->GetNextItem(item, wxLIST_NEXT_ALL, wxLIST_STATE_SELECTED) ) {
+            const Record& record = At(static_cast<size_t>(item));
+            text += record.time.Format("%H:%M:%S.%l") + "\t" + LevelText(record.level) + "\t" + record.text + "\n";
+        }
+
+        wxTheClipboard->SetData(new wxTextDataObject(text));
+        wxTheClipboard->Close();
+    });
+}
+
+/**
+ * @brief Queues 'text' to be shown, one record per line.
+ *
+ * Safe to call from worker threads. Nothing is drawn here, the first
+ * line queued after a flush arms the flush timer on the UI thread.
+ * If more than CAPACITY lines are queued between two flushes, the
+ * oldest are dropped here rather than in the ring buffer.
+ *
+ * @param level Severity, shown in its own column and colour.
+ * @param text  Message text. Multi-line messages become several records.
+ */
+void OutputLog::Append(wxLogLevel level, const wxString& text) {
+    wxDateTime now = wxDateTime::UNow();
+    wxArrayString lines = wxSplit(wxString(text).Trim(), '\n', '\0');
+
+    {
+        std::lock_guard<std::mutex> lock(m_pendingMutex);
+        for ( wxString& line : lines ) {
+            if ( m_pending.size() == CAPACITY )
+                m_pending.pop_front();
+
+            if ( line.EndsWith("\r") )
+                line.RemoveLast();
+            m_pending.push_back({ now, level, line.Left(MAX_LINE_LENGTH) });
+        }
+    }
+
+    if ( !m_flushQueued.exchange(true) )
+        CallAfter([this]() { m_flushTimer.StartOnce(FLUSH_INTERVAL_MS); });
+}
+
+/**
+ * @brief Removes every line, shown or queued.
+ */
+void OutputLog::Clear() {
+    {
+        std::lock_guard<std::mutex> lock(m_pendingMutex);
+        m_pending.clear();
+    }
+
+    m_records.clear();
+    m_first = 0;
+    m_list->SetItemCount(0);
+    m_list->Refresh();
+}
+
+/**
+ * @brief Moves the queued lines into the ring buffer and updates the list once.
+ *
+ * The list keeps following new lines while it is scrolled to the bottom.
+ * If the user has scrolled up to read something it is left where it is.
+ */
+void OutputLog::Flush() {
+    std::deque<Record> pending;
+    {
+        std::lock_guard<std::mutex> lock(m_pendingMutex);
+        pending.swap(m_pending);
+        m_flushQueued = false;
+    }
+
+    if ( pending.empty() )
+        return;
+
+    long shown = m_list->GetItemCount();
+    bool atBottom = shown == 0 || m_list->GetTopItem() + m_list->GetCountPerPage() >= shown;
+
+    for ( Record& record : pending ) {
+        if ( m_records.size() < CAPACITY ) {
+            m_records.push_back(std::move(record));
+            continue;
+        }
+
+        // Full, overwrite the oldest record
+        m_records[m_first] = std::move(record);
+        m_first = ( m_first + 1 ) % CAPACITY;
+    }
+
+    m_list->SetItemCount(static_cast<long>(m_records.size()));
+    if ( atBottom )
+        m_list->EnsureVisible(static_cast<long>(m_records.size()) - 1);
+    m_list->Refresh(); // rows shift up once the buffer is full
+}
+
+const OutputLog::Record& OutputLog::At(size_t index) const {
+    return m_records[( m_first + index ) % m_records.size()];
+}
+
+/**
+ * @brief Creates a log target writing to 'output'.
+ *
+ * @param output   The Output tab. Must outlive the target.
+ * @param previous Target errors and warnings are passed on to. May be null.
+ */
+OutputLogTarget::OutputLogTarget(OutputLog* output, wxLog* previous)
+    : m_output(output), m_previous(previous)
+{
+}
+
+/**
+ * @brief Flushes messages logged from other threads, then the previous target.
+ *
+ * wxLog buffers messages from worker threads until the main thread flushes
+ * the active target, so the base class must run first.
+ */
+void OutputLogTarget::Flush() {
+    wxLog::Flush();
+
+    if ( m_previous )
+        m_previous->Flush();
+}
+
+void OutputLogTarget::DoLogRecord(wxLogLevel level, const wxString& msg, const wxLogRecordInfo& info) {
+    m_output->Append(level, msg);
+
+    if ( m_previous && ( level <= wxLOG_Warning || level == wxLOG_Status ) )
+        m_previous->LogRecord(level, msg, info);
+}
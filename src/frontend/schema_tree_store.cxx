@@ -0,0 +1,35 @@
+// Frontend
+#include "frontend/schema_tree_store.hxx"
+
+void SchemaTreeStore::SetDetail(const wxDataViewItem& item, const wxString& detail) {
+    m_details[item.GetID()] = detail;
+    ItemChanged(item);
+}
+
+void SchemaTreeStore::ClearDetails() {
+    m_details.clear();
+}
+
+unsigned int SchemaTreeStore::GetColumnCount() const {
+    return 2;
+}
+
+wxString SchemaTreeStore::GetColumnType(unsigned int col) const {
+    return col == 0 ? wxDataViewTreeStore::GetColumnType(col) : wxString("string");
+}
+
+/**
+ * @brief Gives the icon and label for column 0, the item's detail for column 1.
+ *
+ * The text renderer of the Type column expects a string, the icon and
+ * label wxDataViewTreeStore would give for it don't convert to one.
+ */
+void SchemaTreeStore::GetValue(wxVariant& variant, const wxDataViewItem& item, unsigned int col) const {
+    if ( col == 0 ) {
+        wxDataViewTreeStore::GetValue(variant, item, col);
+        return;
+    }
+
+    auto detail = m_details.find(item.GetID());
+    variant = detail != m_details.end() ? detail->second : wxString();
+}
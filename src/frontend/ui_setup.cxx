@@ -1,11 +1,35 @@
 // Frontend
 #include "frontend/main_frame.hxx"
 #include "frontend/colours.hxx"
-#include "frontend/file_paths.hxx"
+#include "frontend/embedded_icons.hxx" // Generated at build time by embed_icons
 
 // WX Components
 #include <wx/listctrl.h>
 
+namespace {
+    constexpr int CELL_INFO_INTERVAL_MS = 50; // Cell Info opens BLOBs and starts scans, don't do it per key repeat
+
+    /**
+     * @brief Builds a bitmap from an icon embedded at build time.
+     *
+     * The pixels are already scaled to their display size, so this is a
+     * plain copy with no file access or image decoding.
+     */
+    wxBitmap LoadEmbeddedIcon(const EmbeddedIcons::Icon& icon) {
+        TRACE_SCOPE("LoadEmbeddedIcon");
+
+        // static_data: the image only reads the embedded arrays, never frees them
+        wxImage image(
+            icon.width, icon.height,
+            const_cast<unsigned char*>(icon.rgb),
+            const_cast<unsigned char*>(icon.alpha),
+            true
+        );
+
+        return wxBitmap(image);
+    }
+}
+
 /**
  * @brief Sets up the left panel of the main window.
  *
@@ -16,14 +40,23 @@
  * @see MainFrame::SetupTableTreeView(wxPanel*)
  */
 void MainFrame::SetupWindowLeftPanel() {
+    TRACE_SCOPE("MainFrame::SetupWindowLeftPanel");
+
     // Create left panel belonging to the splitter window
     m_windowLeftPanel = new wxPanel(m_windowSplitterPanel, wxID_ANY);
     wxBoxSizer* leftSizer = new wxBoxSizer(wxVERTICAL);
 
+    // Search box for finding a value in any table
+    m_searchBox = new wxSearchCtrl(m_windowLeftPanel, wxID_ANY, wxEmptyString, wxDefaultPosition, wxDefaultSize, wxTE_PROCESS_ENTER);
+    m_searchBox->SetDescriptiveText("Search all tables");
+    m_searchBox->Bind(wxEVT_SEARCH, &MainFrame::OnSearch, this);
+    m_searchBox->Bind(wxEVT_TEXT_ENTER, &MainFrame::OnSearch, this);
+
     // Create the table tree view
-    wxDataViewTreeCtrl* treeCtrl = SetupTableTreeView(m_windowLeftPanel);
+    wxDataViewTreeCtrl* treeCtrl = m_treeView = SetupTableTreeView(m_windowLeftPanel);
     
     // Create a sizer for the left window and add it to the left panel
+    leftSizer->Add(m_searchBox, 0, wxEXPAND | wxLEFT | wxTOP, 8);
     leftSizer->Add(treeCtrl, 1, wxEXPAND | wxLEFT | wxTOP | wxBOTTOM, 8);
     m_windowLeftPanel->SetSizer(leftSizer);
 }
@@ -40,12 +73,14 @@ void MainFrame::SetupWindowLeftPanel() {
  * @see MainFrame::SetupCommandOutput(wxAuiNotebook*)
  */
 void MainFrame::SetupWindowRightPanel() {
+    TRACE_SCOPE("MainFrame::SetupWindowRightPanel");
+
     // Create right panel and add it to the main splitter
     m_windowRightPanel= new wxPanel(m_windowSplitterPanel, wxID_ANY);
     wxBoxSizer* rightSizer = new wxBoxSizer(wxVERTICAL);
 
     // CReate aui notebook
-    wxAuiNotebook* aui = new wxAuiNotebook(
+    wxAuiNotebook* aui = m_notebook = new wxAuiNotebook(
         m_windowRightPanel, 
         wxID_ANY, 
         wxDefaultPosition, wxDefaultSize, 
@@ -134,13 +169,26 @@ void MainFrame::SetupTextEditor(wxAuiNotebook* parent) {
     // Whenever a character is added, show auto complete suggestions
     m_textEditor->Bind(wxEVT_STC_CHARADDED, &MainFrame::OnCharAdded, this);
 
-    // Resize the margin containing line numbers when a digit is over 100
-    m_textEditor->Bind(wxEVT_STC_UPDATEUI, [this](wxStyledTextEvent& event) {
-        int maxLines = m_textEditor->GetLineCount();
-        int digitCount = std::to_string(maxLines).length();
-        int marginWidth = digitCount * 12;
+    // Resize the margin containing line numbers when the line count gains or loses a digit.
+    // UPDATEUI fires on every caret move and scroll, so only content changes request
+    // the resize, and those are coalesced to once per frame.
+    m_marginUpdate = m_uiUpdates.Register([this]() {
+        int digitCount = 1;
+        for ( int lines = m_textEditor->GetLineCount(); lines >= 10; lines /= 10 )
+            digitCount++;
 
-        m_textEditor->SetMarginWidth(0, marginWidth);
+        if ( digitCount == m_marginDigits )
+            return;
+
+        m_marginDigits = digitCount;
+        m_textEditor->SetMarginWidth(0, digitCount * 12);
+    });
+    m_uiUpdates.Request(m_marginUpdate);
+
+    m_textEditor->Bind(wxEVT_STC_UPDATEUI, [this](wxStyledTextEvent& event) {
+        if ( event.GetUpdated() & wxSTC_UPDATE_CONTENT )
+            m_uiUpdates.Request(m_marginUpdate);
+        event.Skip();
     });
 
     parent->AddPage(m_textEditor, "*SQL1");
@@ -153,7 +201,8 @@ void MainFrame::SetupTextEditor(wxAuiNotebook* parent) {
  * It also:
  * - Prevents in-place editing of items.
  * - Applies alternating row colors.
- * - Configures columns for displaying the name and type of each item.
+ * - Configures columns for displaying the name and type of each item, through a
+ *   SchemaTreeStore so the Type column can show the row count of each table.
  *
  * @param parent The parent panel hosting the tree view.
  * @return A pointer to the configured `wxDataViewTreeCtrl`.
@@ -166,19 +215,15 @@ wxDataViewTreeCtrl* MainFrame::SetupTableTreeView(wxPanel* parent) {
         wxDV_ROW_LINES | wxDV_VERT_RULES | wxDV_MULTIPLE | wxDV_HORIZ_RULES | wxBORDER_STATIC
     );
 
+    // The store created by the control only has a Name column
+    m_treeStore = new SchemaTreeStore;
+    treeCtrl->AssociateModel(m_treeStore);
+    m_treeStore->DecRef(); // owned by the control from now on
+
     // Tree Ctrl settings
     treeCtrl->SetRowHeight(19);
     treeCtrl->SetAlternateRowColour(wxColour(240, 240, 240));
 
-    // Row icons
-    wxImage tableIcon(ASSET_DIR + "table.png", wxBITMAP_TYPE_PNG);
-    wxImage viewsIcon(ASSET_DIR + "views.png", wxBITMAP_TYPE_PNG);
-    wxImage indicesIcon(ASSET_DIR + "indices.png", wxBITMAP_TYPE_PNG);
-    wxImage triggersIcon(ASSET_DIR + "triggers.png", wxBITMAP_TYPE_PNG);
-    tableIcon = tableIcon.Scale(15, 16, wxIMAGE_QUALITY_HIGH);
-    viewsIcon = viewsIcon.Scale(15, 16, wxIMAGE_QUALITY_HIGH);
-    indicesIcon = indicesIcon.Scale(15, 16, wxIMAGE_QUALITY_HIGH);
-    triggersIcon = triggersIcon.Scale(15, 16, wxIMAGE_QUALITY_HIGH);
 
     wxDataViewColumn* nameCol = treeCtrl->GetColumn(0);
     nameCol->SetResizeable(true);
@@ -191,22 +236,23 @@ wxDataViewTreeCtrl* MainFrame::SetupTableTreeView(wxPanel* parent) {
     typeCol->SetMinWidth(40);
 
     // Root nodes
-    wxDataViewItem tables = treeCtrl->AppendContainer(wxDataViewItem(nullptr), "Tables (0)");
+    wxDataViewItem tables = m_tablesNode = treeCtrl->AppendContainer(wxDataViewItem(nullptr), "Tables (0)");
     wxDataViewItem views = treeCtrl->AppendContainer(wxDataViewItem(nullptr), "Views (0)");
     wxDataViewItem indexes = treeCtrl->AppendContainer(wxDataViewItem(nullptr), "Indexes (0)");
     wxDataViewItem triggers = treeCtrl->AppendContainer(wxDataViewItem(nullptr), "Triggers (0)");
 
-    // Set row icons
-    treeCtrl->SetItemIcon(tables, wxBitmap(tableIcon));
-    treeCtrl->SetItemIcon(views, wxBitmap(viewsIcon));
-    treeCtrl->SetItemIcon(indexes, wxBitmap(indicesIcon));
-    treeCtrl->SetItemIcon(triggers, wxBitmap(triggersIcon));
+    // Set row icons. Embedded at build time, already scaled to 15x16
+    treeCtrl->SetItemIcon(tables, LoadEmbeddedIcon(EmbeddedIcons::TABLE));
+    treeCtrl->SetItemIcon(views, LoadEmbeddedIcon(EmbeddedIcons::VIEWS));
+    treeCtrl->SetItemIcon(indexes, LoadEmbeddedIcon(EmbeddedIcons::INDICES));
+    treeCtrl->SetItemIcon(triggers, LoadEmbeddedIcon(EmbeddedIcons::TRIGGERS));
 
     // Bind events
     // Disable editing of tree ctrl items
     treeCtrl->Bind(wxEVT_DATAVIEW_ITEM_START_EDITING, [](wxDataViewEvent& event) {
         event.Veto();
     });
+    treeCtrl->Bind(wxEVT_DATAVIEW_ITEM_ACTIVATED, &MainFrame::OnSearchHitActivated, this);
 
     return treeCtrl;
 }
@@ -256,13 +302,6 @@ void MainFrame::SetupStructureView(wxAuiNotebook* aui) {
     m_tableDataView->SetLabelBackgroundColour(*wxWHITE);
     m_tableDataView->SetDefaultCellAlignment(wxALIGN_RIGHT, wxALIGN_CENTER);
 
-    // add choices to select a table
-    // dummy options. this would be the table names you select to view
-    wxArrayString options;
-    options.Add("O1");
-    options.Add("O2");
-    options.Add("O3");
-
     /*
         Top panel components
     
@@ -272,12 +311,12 @@ void MainFrame::SetupStructureView(wxAuiNotebook* aui) {
         4. Sizer to align the label and dropdown horizontally
     */
     wxStaticText* selectLabel = new wxStaticText(topPanel, wxID_ANY, "&Table: ");
-    wxChoice* dropdown = new wxChoice(topPanel, wxID_ANY, wxDefaultPosition, wxSize(150, 20), options);
+    // Filled with the table names once a data base is opened
+    m_tableSelector = new wxChoice(topPanel, wxID_ANY, wxDefaultPosition, wxSize(150, 20));
 
     // Button to save the table as is to file
-    wxBitmap bmSave(ASSET_DIR + "save.png", wxBITMAP_TYPE_PNG);
-    bmSave.Rescale(bmSave, wxSize(25, 25));
-    wxBitmapButton* bSaveRecords = new wxBitmapButton(
+    wxBitmap bmSave = LoadEmbeddedIcon(EmbeddedIcons::SAVE);
+    m_saveRecordsButton = new wxBitmapButton(
         topPanel,
         wxID_ANY,
         bmSave,
@@ -285,12 +324,11 @@ void MainFrame::SetupStructureView(wxAuiNotebook* aui) {
         wxBORDER_NONE
     );
 
-    bSaveRecords->SetBackgroundColour(*wxWHITE);
-    bSaveRecords->SetToolTip("Save table as displayed");
+    m_saveRecordsButton->SetBackgroundColour(*wxWHITE);
+    m_saveRecordsButton->SetToolTip("Save table as displayed");
 
     // Button to refresh the displayed records
-    wxBitmap bmRefresh(ASSET_DIR + "refresh.png", wxBITMAP_TYPE_PNG);
-    bmRefresh.Rescale(bmRefresh, wxSize(20, 19));
+    wxBitmap bmRefresh = LoadEmbeddedIcon(EmbeddedIcons::REFRESH);
     wxBitmapButton* bRefreshRecords = new wxBitmapButton(
         topPanel,
         wxID_ANY,
@@ -304,9 +342,8 @@ void MainFrame::SetupStructureView(wxAuiNotebook* aui) {
     wxLogMessage("Created structure view");
 
     // Button to create a new record
-    wxBitmap bmNew(ASSET_DIR + "new-record.png", wxBITMAP_TYPE_PNG);
-    bmNew.Rescale(bmNew, wxSize(25, 25));
-    wxBitmapButton* bNewRecord = new wxBitmapButton(
+    wxBitmap bmNew = LoadEmbeddedIcon(EmbeddedIcons::NEW_RECORD);
+    m_newRecordButton = new wxBitmapButton(
         topPanel,
         wxID_ANY,
         bmNew,
@@ -314,13 +351,12 @@ void MainFrame::SetupStructureView(wxAuiNotebook* aui) {
         wxBORDER_NONE
     );
 
-    bNewRecord->SetBackgroundColour(*wxWHITE);
-    bNewRecord->SetToolTip("Create a new blank record");
+    m_newRecordButton->SetBackgroundColour(*wxWHITE);
+    m_newRecordButton->SetToolTip("Create a new blank record");
 
     // Button to delete a hovered record
-    wxBitmap bmDel(ASSET_DIR + "del-record.png", wxBITMAP_TYPE_PNG);
-    bmDel.Rescale(bmDel, wxSize(25, 25));
-    wxBitmapButton* bDeleteRecord = new wxBitmapButton(
+    wxBitmap bmDel = LoadEmbeddedIcon(EmbeddedIcons::DELETE_RECORD);
+    m_deleteRecordButton = new wxBitmapButton(
         topPanel,
         wxID_ANY,
         bmDel,
@@ -328,19 +364,19 @@ void MainFrame::SetupStructureView(wxAuiNotebook* aui) {
         wxBORDER_NONE
     );
 
-    bDeleteRecord->SetBackgroundColour(*wxWHITE);
-    bDeleteRecord->SetToolTip("Delete selected record");
+    m_deleteRecordButton->SetBackgroundColour(*wxWHITE);
+    m_deleteRecordButton->SetToolTip("Delete selected record");
     
     // Toolbar. Add select label, dropdown, and buttons
     wxBoxSizer* toolbarSizer = new wxBoxSizer(wxHORIZONTAL);
     toolbarSizer->Add(selectLabel, 0, wxALIGN_CENTER_VERTICAL | wxTOP | wxLEFT, 5);
-    toolbarSizer->Add(dropdown, 0, wxTOP, 5);
+    toolbarSizer->Add(m_tableSelector, 0, wxTOP, 5);
     toolbarSizer->AddSpacer(9);
     toolbarSizer->Add(bRefreshRecords, 0, wxTOP, 5);
     toolbarSizer->AddSpacer(3);
-    toolbarSizer->Add(bSaveRecords, 0, wxTOP, 5);
-    toolbarSizer->Add(bNewRecord, 0, wxTOP, 5);
-    toolbarSizer->Add(bDeleteRecord, 0, wxTOP, 5);
+    toolbarSizer->Add(m_saveRecordsButton, 0, wxTOP, 5);
+    toolbarSizer->Add(m_newRecordButton, 0, wxTOP, 5);
+    toolbarSizer->Add(m_deleteRecordButton, 0, wxTOP, 5);
 
     // Top panel sizing
     wxBoxSizer* topSizer = new wxBoxSizer(wxVERTICAL);
@@ -355,16 +391,22 @@ void MainFrame::SetupStructureView(wxAuiNotebook* aui) {
                              Tells which cell is selected in the grid
         2. Cell Info Text Ctrl - More detailed description about the type of
                                  data in the selected cell.
+        3. Blob Viewer - Hex dump and image preview, only shown for BLOB cells
     */
-    wxStaticText* infoLabel = new wxStaticText(bottomPanel, wxID_ANY, "&Cell Info: Row 0, Column 0");
-    wxTextCtrl* cellInfo = new wxTextCtrl(bottomPanel, wxID_ANY, wxEmptyString, wxDefaultPosition, wxDefaultSize, wxBORDER_STATIC | wxTE_READONLY);
-    cellInfo->SetForegroundColour(wxColour(120, 120, 120));
-    cellInfo->AppendText("Cell information will appear here...");
+    m_cellInfoLabel = new wxStaticText(bottomPanel, wxID_ANY, "&Cell Info: Row 0, Column 0");
+    m_cellInfo = new wxTextCtrl(bottomPanel, wxID_ANY, wxEmptyString, wxDefaultPosition, wxDefaultSize, wxBORDER_STATIC | wxTE_READONLY | wxTE_MULTILINE);
+    m_cellInfo->SetForegroundColour(wxColour(120, 120, 120));
+    m_cellInfo->AppendText("Cell information will appear here...");
+
+    // BLOB cells are shown in a hex viewer above the cell info, read on demand
+    m_blobViewer = new BlobViewer(bottomPanel);
+    m_blobViewer->Hide();
 
     // Bottom sizer
     wxBoxSizer* bottomSizer = new wxBoxSizer(wxVERTICAL);
-    bottomSizer->Add(infoLabel, 0, wxALIGN_CENTER_VERTICAL | wxTOP | wxLEFT, 5);
-    bottomSizer->Add(cellInfo, 1, wxEXPAND | wxTOP, 5);
+    bottomSizer->Add(m_cellInfoLabel, 0, wxALIGN_CENTER_VERTICAL | wxTOP | wxLEFT, 5);
+    bottomSizer->Add(m_blobViewer, 2, wxEXPAND);
+    bottomSizer->Add(m_cellInfo, 1, wxEXPAND | wxTOP, 5);
     bottomPanel->SetSizer(bottomSizer);
 
     // Splitter settings
@@ -372,33 +414,36 @@ void MainFrame::SetupStructureView(wxAuiNotebook* aui) {
     splitter->SplitHorizontally(topPanel, bottomPanel);
     splitter->SetSashPosition(splitter->GetMinimumPaneSize());
 
+    // Bind events
+    m_tableSelector->Bind(wxEVT_CHOICE, &MainFrame::OnTableSelected, this);
+    m_cellInfoUpdate = m_uiUpdates.Register([this]() { UpdateCellInfo(); }, CELL_INFO_INTERVAL_MS);
+    m_tableDataView->Bind(wxEVT_GRID_SELECT_CELL, &MainFrame::OnGridCellSelected, this);
+    m_tableDataView->Bind(wxEVT_GRID_CELL_CHANGED, &MainFrame::OnGridCellChanged, this);
+    m_saveRecordsButton->Bind(wxEVT_BUTTON, &MainFrame::OnSaveRecords, this);
+    m_newRecordButton->Bind(wxEVT_BUTTON, &MainFrame::OnNewRecord, this);
+    m_deleteRecordButton->Bind(wxEVT_BUTTON, &MainFrame::OnDeleteRecord, this);
+
     // Add page
     aui->AddPage(splitter, "Records"); 
     PreventEssentialTabClosure(aui); // ensure this page cannot be closed
 }
 
 /**
- * @brief Adds a tab for command output display to the given notebook.
+ * @brief Adds the "Output" tab and routes wxWidgets logging into it.
  *
- * The output panel includes a read-only `wxTextCtrl` to show logs or messages from SQL commands or application events.
- * Text control is styled for visual clarity.
+ * The tab is an OutputLog, a bounded virtual list, so long running scripts
+ * can log any number of lines without slowing the UI down. Errors and
+ * warnings still reach the default log target as well.
  *
  * @param aui The `wxAuiNotebook` to which the output panel will be added as a tab named "Output".
  */
 void MainFrame::SetupCommandOutput(wxAuiNotebook* aui) {
-    wxPanel* output = new wxPanel(aui);
-    wxBoxSizer* sizer = new wxBoxSizer(wxVERTICAL);
-    wxTextCtrl* textCtrl = new wxTextCtrl(output, wxID_ANY, wxEmptyString, wxDefaultPosition, wxDefaultSize, wxNO_BORDER | wxTE_READONLY);
-
-    textCtrl->SetForegroundColour(wxColour(120, 120, 120));
-    output->SetBackgroundColour(*wxWHITE);
-
-    textCtrl->AppendText("Command output will appear here...");
-
-    sizer->Add(textCtrl, 1, wxEXPAND | wxTOP, 5);
-    output->SetSizer(sizer);
-    aui->AddPage(output, "Output");
+    m_output = new OutputLog(aui);
+    aui->AddPage(m_output, "Output");
     PreventEssentialTabClosure(aui);
+
+    m_previousLog = wxLog::GetActiveTarget();
+    wxLog::SetActiveTarget(new OutputLogTarget(m_output, m_previousLog));
 }
 
 /**
@@ -413,6 +458,8 @@ void MainFrame::SetupCommandOutput(wxAuiNotebook* aui) {
  * Each menu item includes keyboard shortcuts and descriptive tooltips.
  */
 void MainFrame::SetupMenuBar() {
+    TRACE_SCOPE("MainFrame::SetupMenuBar");
+
     wxMenu* fileMenu = new wxMenu;
     wxMenu* editMenu = new wxMenu;
     wxMenu* selectionMenu = new wxMenu;
@@ -424,11 +471,19 @@ void MainFrame::SetupMenuBar() {
     fileMenu->Append(wxID_NEW, "&New Database\tCtrl+N", "Create a new database");
     fileMenu->AppendSeparator();
     fileMenu->Append(wxID_OPEN, "Open &Database\tCtrl+K Ctrl+D", "Open an existing database");
-    fileMenu->Append(wxID_OPEN, "Open &Database Read-only\tCtrl+K Ctrl+R", "Open an existing database in read-only mode");
+    wxMenuItem* openReadOnlyItem = fileMenu->Append(wxID_ANY, "Open &Database Read-only\tCtrl+K Ctrl+R", "Open an existing database in read-only mode");
+    wxMenuItem* openInMemoryItem = fileMenu->Append(wxID_ANY, "Open in &Memory...", "Load a whole database into memory for fast queries, saving writes it back");
+    wxMenuItem* openScriptItem = fileMenu->Append(wxID_ANY, "Open SQL &Script...", "Open a SQL script in the editor");
+    m_importDumpItem = fileMenu->Append(wxID_ANY, "&Import SQL Dump...", "Restore a SQL dump into the open database");
+    m_checkOnOpenItem = fileMenu->AppendCheckItem(wxID_ANY, "Check &Integrity on Open", "Run a quick integrity check in the background after opening a database");
+    m_checkOnOpenItem->Check(true);
     fileMenu->Append(wxID_CLOSE, "&Close Database\tCtrl+K Ctrl+L", "Close an open database");
     fileMenu->AppendSeparator();
     fileMenu->Append(wxID_SAVE, "&Save\tCtrl+S", "Save the current file");
     fileMenu->Append(wxID_SAVEAS, "Save &As\tCtrl+Shift+S", "Save the current file as");
+    wxMenuItem* exportDumpItem = fileMenu->Append(wxID_ANY, "Export SQL &Dump...", "Write the open database to a SQL script that recreates it");
+    wxMenuItem* archiveItem = fileMenu->Append(wxID_ANY, "Save Compressed &Archive...", "Save a compressed, read-only copy of the open database for archiving");
+    wxMenuItem* compareItem = fileMenu->Append(wxID_ANY, "Com&pare With...", "Compare the open database with another copy of it");
     fileMenu->AppendSeparator();
     fileMenu->Append(wxID_EXIT, "E&xit\tCtrl+Q", "Exit the application");
 
@@ -454,6 +509,12 @@ void MainFrame::SetupMenuBar() {
     selectionMenu->Append(wxID_DUPLICATE, "Duplicate\tCtrl+D", "Duplicate the selected text");
     selectionMenu->Append(wxID_DELETE, "&Delete\tDel", "Delete the selected text");
 
+    // View menu
+    wxMenuItem* ioStatsItem = viewMenu->Append(wxID_ANY, "&I/O Statistics", "Show the reads, writes and syncs SQLite has done on each kind of file");
+
+    // Run menu
+    m_executeFileItem = runMenu->Append(wxID_ANY, "Execute Script &File...", "Execute a SQL script file on the open database without opening it in the editor");
+
     // Append and set menu bar
     wxMenuBar* menuBar = new wxMenuBar;
     menuBar->Append(fileMenu, "&File");
@@ -463,4 +524,19 @@ void MainFrame::SetupMenuBar() {
     menuBar->Append(runMenu, "&Run");
     menuBar->Append(helpMenu, "&Help");
     SetMenuBar(menuBar);
+
+    // Bind menu events
+    Bind(wxEVT_MENU, &MainFrame::OnOpenDatabase, this, wxID_OPEN);
+    Bind(wxEVT_MENU, &MainFrame::OnOpenReadOnly, this, openReadOnlyItem->GetId());
+    Bind(wxEVT_MENU, &MainFrame::OnOpenInMemory, this, openInMemoryItem->GetId());
+    Bind(wxEVT_MENU, &MainFrame::OnSaveRecords, this, wxID_SAVE);
+    Bind(wxEVT_MENU, &MainFrame::OnSaveAs, this, wxID_SAVEAS);
+    Bind(wxEVT_MENU, &MainFrame::OnExportDump, this, exportDumpItem->GetId());
+    Bind(wxEVT_MENU, &MainFrame::OnSaveArchive, this, archiveItem->GetId());
+    Bind(wxEVT_MENU, &MainFrame::OnCompareDatabase, this, compareItem->GetId());
+    Bind(wxEVT_MENU, &MainFrame::OnShowIoStats, this, ioStatsItem->GetId());
+    Bind(wxEVT_MENU, &MainFrame::OnOpenScript, this, openScriptItem->GetId());
+    Bind(wxEVT_MENU, &MainFrame::OnExecuteScriptFile, this, m_executeFileItem->GetId());
+    Bind(wxEVT_MENU, &MainFrame::OnImportDump, this, m_importDumpItem->GetId());
+    Bind(wxEVT_MENU, &MainFrame::OnUndo, this, wxID_UNDO);
 }
@@ -0,0 +1,86 @@
+// Frontend
+#include "frontend/update_scheduler.hxx"
+
+// STD
+#include <algorithm>
+
+UpdateScheduler::UpdateScheduler()
+    : m_timer(this)
+{
+    Bind(wxEVT_TIMER, &UpdateScheduler::OnTimer, this);
+}
+
+/**
+ * @brief Adds an update that can then be requested by its id.
+ *
+ * @param update     Refreshes the UI from the current state. Reads whatever
+ *                   the event handlers stored, since it runs after them.
+ * @param intervalMs Minimum milliseconds between two runs.
+ * @return The id to pass to Request and Cancel.
+ */
+UpdateScheduler::TaskId UpdateScheduler::Register(std::function<void()> update, int intervalMs) {
+    Task task;
+    task.update = std::move(update);
+    task.interval = std::chrono::milliseconds(intervalMs);
+    m_tasks.push_back(std::move(task));
+    return m_tasks.size() - 1;
+}
+
+/**
+ * @brief Marks an update as needed.
+ *
+ * Repeated requests before it runs are merged into one.
+ */
+void UpdateScheduler::Request(TaskId id) {
+    Task& task = m_tasks[id];
+    if ( task.pending )
+        return;
+
+    task.pending = true;
+    task.due = std::max(Clock::now(), task.lastRun + task.interval);
+    Arm();
+}
+
+void UpdateScheduler::Cancel(TaskId id) {
+    m_tasks[id].pending = false;
+}
+
+void UpdateScheduler::OnTimer(wxTimerEvent&) {
+    Clock::time_point now = Clock::now();
+
+    for ( Task& task : m_tasks ) {
+        if ( !task.pending || task.due > now )
+            continue;
+
+        // Cleared first, the update may request itself again
+        task.pending = false;
+        task.lastRun = now;
+        task.update();
+    }
+
+    Arm();
+}
+
+void UpdateScheduler::Arm() {
+    bool anyPending = false;
+    Clock::time_point next = Clock::time_point::max();
+    for ( const Task& task : m_tasks ) {
+        if ( task.pending ) {
+            anyPending = true;
+            next = std::min(next, task.due);
+        }
+    }
+
+    if ( !anyPending ) {
+        m_timer.Stop();
+        return;
+    }
+
+    if ( m_timer.IsRunning() && m_armedFor <= next )
+        return;
+
+    // Rounded up, a timer firing early would find nothing due and re-arm
+    auto wait = std::chrono::ceil<std::chrono::milliseconds>(next - Clock::now()).count();
+    m_armedFor = next;
+    m_timer.StartOnce(static_cast<int>(std::max<long long>(wait, 1)));
+}
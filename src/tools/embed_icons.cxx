@@ -0,0 +1,103 @@
+// Build time tool that pre-scales the PNG icons in the assets folder
+// and writes them as raw RGB and alpha arrays into a C++ header.
+// The GUI then builds its bitmaps straight from memory at startup,
+// without touching the file system, decoding PNGs or rescaling.
+//
+// Usage: embed_icons <output.hxx> <asset dir> <NAME=file.png:WIDTHxHEIGHT>...
+
+// WX
+#include <wx/init.h>
+#include <wx/image.h>
+
+// STD
+#include <cstdio>
+#include <fstream>
+#include <iostream>
+#include <string>
+
+namespace {
+    struct IconSpec {
+        std::string name;
+        std::string file;
+        int width;
+        int height;
+    };
+
+    bool ParseSpec(const std::string& text, IconSpec& spec) {
+        size_t equals = text.find('=');
+        size_t colon = text.rfind(':');
+        size_t x = text.rfind('x');
+        if ( equals == std::string::npos || colon == std::string::npos || x == std::string::npos || !( equals < colon && colon < x ) )
+            return false;
+
+        spec.name = text.substr(0, equals);
+        spec.file = text.substr(equals + 1, colon - equals - 1);
+        spec.width = std::stoi(text.substr(colon + 1, x - colon - 1));
+        spec.height = std::stoi(text.substr(x + 1));
+        return spec.width > 0 && spec.height > 0;
+    }
+
+    void WriteArray(std::ofstream& out, const std::string& name, const unsigned char* data, size_t length) {
+        out << "    inline constexpr unsigned char " << name << "[] = {";
+        for ( size_t i = 0; i < length; i++ ) {
+            if ( i % 24 == 0 )
+                out << "\n        ";
+            out << static_cast<int>(data[i]) << ",";
+        }
+        out << "\n    };\n";
+    }
+}
+
+int main(int argc, char** argv) {
+    if ( argc < 3 ) {
+        std::cerr << "usage: embed_icons <output.hxx> <asset dir> <NAME=file.png:WIDTHxHEIGHT>...\n";
+        return 2;
+    }
+
+    wxInitializer initializer;
+    if ( !initializer.IsOk() ) {
+        std::cerr << "embed_icons: could not initialize wxWidgets\n";
+        return 1;
+    }
+
+    wxImage::AddHandler(new wxPNGHandler);
+
+    std::ofstream out(argv[1], std::ios::trunc);
+    out << "#pragma once\n\n"
+        << "// Generated by embed_icons at build time. Do not edit.\n\n"
+        << "namespace EmbeddedIcons {\n"
+        << "    struct Icon {\n"
+        << "        int width;\n"
+        << "        int height;\n"
+        << "        const unsigned char* rgb; // width * height * 3 bytes\n"
+        << "        const unsigned char* alpha; // width * height bytes\n"
+        << "    };\n\n";
+
+    std::string assetDir = argv[2];
+    for ( int i = 3; i < argc; i++ ) {
+        IconSpec spec;
+        if ( !ParseSpec(argv[i], spec) ) {
+            std::cerr << "embed_icons: invalid icon spec '" << argv[i] << "'\n";
+            return 1;
+        }
+
+        wxImage image(assetDir + "/" + spec.file, wxBITMAP_TYPE_PNG);
+        if ( !image.IsOk() ) {
+            std::cerr << "embed_icons: could not load '" << spec.file << "'\n";
+            return 1;
+        }
+
+        image.Rescale(spec.width, spec.height, wxIMAGE_QUALITY_HIGH);
+        if ( !image.HasAlpha() )
+            image.InitAlpha(); // converts a mask, if any, otherwise fully opaque
+
+        size_t pixels = static_cast<size_t>(spec.width) * spec.height;
+        WriteArray(out, spec.name + "_RGB", image.GetData(), pixels * 3);
+        WriteArray(out, spec.name + "_ALPHA", image.GetAlpha(), pixels);
+        out << "    inline constexpr Icon " << spec.name << "{ "
+            << spec.width << ", " << spec.height << ", " << spec.name << "_RGB, " << spec.name << "_ALPHA };\n\n";
+    }
+
+    out << "}\n";
+    return out.good() ? 0 : 1;
+}